@@ -25,12 +25,82 @@
 #define SHARE_H
 
 #include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /** Flag indicating the implementation is able to handle multiple primes. */
 #define SHARE_METHS_FLAG_GENERIC	0x01
+/** Flag indicating the x values of splits are public and may be operated on
+ * in variable time when joining. */
+#define SHARE_METHS_FLAG_PUBLIC_X	0x02
+/** Flag indicating the implementation works in a binary field, GF(2^128),
+ * instead of modulo a prime. */
+#define SHARE_METHS_FLAG_BINARY		0x04
+/** Flag indicating the implementation works modulo the prime 2^64-2^32+1 and
+ * calculates the splits by index at roots of unity: many at once with a
+ * number-theoretic transform. */
+#define SHARE_METHS_FLAG_NTT		0x08
+/** Flag indicating all parts are required: the splits are n-of-n shares that
+ * XOR to the secret. Secrets of any length and only parts splits. */
+#define SHARE_METHS_FLAG_XOR		0x10
+/** Flag indicating the implementation works modulo the prime 2^255-19 for
+ * secrets of up to 254 bits: 32-byte numbers instead of the 33 bytes of the
+ * default prime, 2^257-0x5d. Shares are not compatible with the default. */
+#define SHARE_METHS_FLAG_P254		0x20
 
 /** The maximum number of parts able to be required to reconstruct secret. */
-#define SHARE_PARTS_MAX			16
+#define SHARE_PARTS_MAX			1024
+/** The maximum number of parts of fields that are only joined directly, in
+ * O(parts^2): all but the number-theoretic transform prime, which has a
+ * product tree join, and XOR. */
+#define SHARE_PARTS_MAX_DIRECT		16
+/** The maximum number of parts able to be required with the flags. */
+#define SHARE_PARTS_MAX_FLAGS(flags)					\
+    (((flags) & (SHARE_METHS_FLAG_NTT | SHARE_METHS_FLAG_XOR)) ?	\
+     SHARE_PARTS_MAX : SHARE_PARTS_MAX_DIRECT)
+
+/** The primes that SHARE_new() chooses from, smallest first, as
+ * X(bits, bytes, arg): the maximum length of a secret in bits and the length
+ * of the prime in bytes. The table of primes is built from this list. */
+#define SHARE_PRIMES(X, arg)						\
+    X(60, 8, arg) X(126, 16, arg) X(128, 17, arg) X(192, 25, arg)	\
+    X(256, 33, arg) X(384, 49, arg) X(520, 66, arg)
+/** Part of SHARE_PRIME_LEN(): the length of the prime when it supports the
+ * secret length. */
+#define SHARE_PRIME_LEN_SEL(bits, bytes, len)	((len) <= (bits)) ? (bytes) :
+/** The length in bytes of the prime, or field polynomial, that SHARE_new()
+ * uses for a secret of len bits with the flags. 0 when not supported.
+ * XOR numbers are the length of the secret but at least two bytes. */
+#define SHARE_PRIME_LEN(len, flags)					\
+    ((size_t)(((flags) & SHARE_METHS_FLAG_XOR) ?			\
+        (((len) <= 16) ? 2 : ((len) + 7) / 8) :				\
+     ((flags) & SHARE_METHS_FLAG_BINARY) ? (((len) <= 128) ? 16 : 0) :	\
+     ((flags) & SHARE_METHS_FLAG_NTT) ? (((len) <= 63) ? 8 : 0) :	\
+     ((flags) & SHARE_METHS_FLAG_P254) ? (((len) <= 254) ? 32 : 0) :	\
+     (SHARE_PRIMES(SHARE_PRIME_LEN_SEL, len) 0)))
+/** The length in bytes of an encoded split, an x and a y, returned by
+ * SHARE_get_len() for a secret of len bits with the flags. 0 when not
+ * supported. */
+#define SHARE_SPLIT_LEN(len, flags)	(2 * SHARE_PRIME_LEN(len, flags))
+
+/** The alignment in bytes of the memory passed to SHARE_init(). */
+#define SHARE_MEM_ALIGN			16
+
+/** An upper bound of the size in bytes of a number object for a secret of len
+ * bits: the prime is at most 17 bytes longer than the secret. */
+#define SHARE_NUM_SIZE_MAX(len)		((((size_t)(len) + 7) / 8 + 40) / 16 * 16)
+/** An upper bound of the size returned by SHARE_size() for a secret of len
+ * bits and parts parts, without SHARE_METHS_FLAG_NTT or SHARE_METHS_FLAG_XOR.
+ * Sizes memory for SHARE_init() at compile time: at most 2.parts+17 numbers
+ * and pointers, scratch space of 2.parts numbers, the object and the encoding.
+ * With SHARE_METHS_FLAG_P254 the numbers are 32 bytes: use a len of 254.
+ */
+#define SHARE_SIZE_MAX(len, parts)					\
+    (1024 + ((size_t)(parts) * 4 + 17) * SHARE_NUM_SIZE_MAX(len) +	\
+     ((size_t)(parts) * 2 + 17) * 8)
 
 /** Error codes. */
 typedef enum share_err_en {
@@ -56,10 +126,45 @@ typedef enum share_err_en {
     MOD_INV             = 41
 } SHARE_ERR;
 
+/**
+ * The prototype of a function that allocates dynamic memory for the library.
+ * Memory must be aligned to SHARE_MEM_ALIGN bytes.
+ *
+ * @param [in] size  The number of bytes to allocate.
+ * @param [in] ctx   The context of the allocator.
+ * @return  The allocated memory or NULL on failure.
+ */
+typedef void *(SHARE_ALLOC_FUNC)(size_t size, void *ctx);
+/**
+ * The prototype of a function that frees dynamic memory of the library.
+ *
+ * @param [in] ptr  The memory to free. Never NULL.
+ * @param [in] ctx  The context of the allocator.
+ */
+typedef void (SHARE_DEALLOC_FUNC)(void *ptr, void *ctx);
+
+SHARE_ERR SHARE_set_allocator(SHARE_ALLOC_FUNC *alloc,
+    SHARE_DEALLOC_FUNC *dealloc, void *ctx);
+
+/** An arena of locked memory to allocate secret material from. */
+typedef struct share_arena_st SHARE_ARENA;
+
+SHARE_ERR SHARE_ARENA_new(size_t size, SHARE_ARENA **arena);
+void SHARE_ARENA_free(SHARE_ARENA *arena);
+void *SHARE_ARENA_alloc(size_t size, void *arena);
+void SHARE_ARENA_dealloc(void *ptr, void *arena);
+
 /** The structure for splitting and joining */
 typedef struct share_st SHARE;
 
-SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share);
+SHARE_ERR SHARE_new(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE **share);
+SHARE_ERR SHARE_new_with_prime(uint16_t len, const uint8_t *prime,
+    uint16_t prime_len, uint16_t parts, uint32_t flags, SHARE **share);
+SHARE_ERR SHARE_size(uint16_t len, uint16_t parts, uint32_t flags,
+    size_t *size);
+SHARE_ERR SHARE_init(void *buf, size_t size, uint16_t len, uint16_t parts,
+    uint32_t flags, SHARE **share);
 void SHARE_free(SHARE *share);
 
 SHARE_ERR SHARE_get_len(SHARE *share, uint16_t *len);
@@ -68,10 +173,39 @@ SHARE_ERR SHARE_get_impl_name(SHARE *share, char **name);
 
 SHARE_ERR SHARE_split_init(SHARE *share, uint8_t *secret);
 SHARE_ERR SHARE_split(SHARE *share, uint8_t *data);
+SHARE_ERR SHARE_split_n(SHARE *share, uint8_t *data, uint16_t num);
 
 SHARE_ERR SHARE_join_init(SHARE *share);
 SHARE_ERR SHARE_join_update(SHARE *share, uint8_t *data);
+SHARE_ERR SHARE_join_update_n(SHARE *share, uint8_t *data, uint16_t num);
 SHARE_ERR SHARE_join_final(SHARE *share, uint8_t *secret);
 
+SHARE_ERR SHARE_pool_get(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE **share);
+void SHARE_pool_put(SHARE *share);
+void SHARE_pool_clear(void);
+
+/** The structure for splitting and joining each byte of a secret of any
+ * length in GF(2^8). */
+typedef struct share_gf8_st SHARE_GF8;
+
+SHARE_ERR SHARE_GF8_new(uint32_t len, uint8_t parts, SHARE_GF8 **share);
+void SHARE_GF8_free(SHARE_GF8 *share);
+
+SHARE_ERR SHARE_GF8_get_len(SHARE_GF8 *share, uint32_t *len);
+SHARE_ERR SHARE_GF8_get_num(SHARE_GF8 *share, uint16_t *num);
+SHARE_ERR SHARE_GF8_get_impl_name(SHARE_GF8 *share, char **name);
+
+SHARE_ERR SHARE_GF8_split_init(SHARE_GF8 *share, uint8_t *secret);
+SHARE_ERR SHARE_GF8_split(SHARE_GF8 *share, uint8_t *data);
+
+SHARE_ERR SHARE_GF8_join_init(SHARE_GF8 *share);
+SHARE_ERR SHARE_GF8_join_update(SHARE_GF8 *share, uint8_t *data);
+SHARE_ERR SHARE_GF8_join_final(SHARE_GF8 *share, uint8_t *secret);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
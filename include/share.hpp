@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef SHARE_HPP
+#define SHARE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#include "share.h"
+
+namespace share
+{
+
+/**
+ * Splits and joins secrets of Bits bits that require Parts parts.
+ * A typed wrapper over the C API: the object is initialized with SHARE_init()
+ * and splitting and joining call the implementation chosen at run time
+ * through its method table. No kernel is bound or inlined at compile time.
+ * The length and number of parts are fixed at compile time: secrets and
+ * splits are fixed-size arrays and the object, its numbers and its scratch
+ * space are held in the object - no dynamic memory is used. The
+ * implementation is chosen once, when constructed.
+ * The object holds pointers into itself: it can't be copied or moved. With
+ * many parts the object is large - make it static or allocate it.
+ *
+ * @tparam Bits   The length of the secret in bits.
+ * @tparam Parts  The number of parts required to recreate secret. Up to
+ *                SHARE_PARTS_MAX_DIRECT.
+ * @tparam Flags  SHARE_METHS_FLAG_PUBLIC_X and one of SHARE_METHS_FLAG_BINARY
+ *                or SHARE_METHS_FLAG_P254.
+ */
+template <std::uint16_t Bits, std::uint16_t Parts, std::uint32_t Flags = 0>
+class Share
+{
+    static_assert((Bits >= 1) && (SHARE_SPLIT_LEN(Bits, Flags) != 0),
+        "Secret length not supported");
+    static_assert((Parts >= 2) && (Parts <= SHARE_PARTS_MAX_FLAGS(Flags)),
+        "Number of parts not supported");
+    static_assert((Flags & ~(SHARE_METHS_FLAG_PUBLIC_X |
+        SHARE_METHS_FLAG_BINARY | SHARE_METHS_FLAG_P254)) == 0,
+        "Flags not supported in a Share");
+
+public:
+    /** The length of the secret in bytes. */
+    static constexpr std::size_t secret_len = (Bits + 7) / 8;
+    /** The length of an encoded split in bytes: x and y. */
+    static constexpr std::size_t split_len = SHARE_SPLIT_LEN(Bits, Flags);
+    /** The number of parts required to recreate the secret. */
+    static constexpr std::size_t parts = Parts;
+
+    /** A secret. */
+    using Secret = std::array<std::uint8_t, secret_len>;
+    /** An encoded split. */
+    using Split = std::array<std::uint8_t, split_len>;
+    /** A number of encoded splits, one after the other. */
+    template <std::size_t N>
+    using Splits = std::array<Split, N>;
+
+    /**
+     * Initialize the object in its own memory. Check error() before use.
+     */
+    Share() noexcept
+    {
+        std::uint16_t len = 0;
+
+        err_ = SHARE_init(mem_.data(), mem_.size(), Bits, Parts, Flags,
+            &share_);
+        if (err_ == NONE)
+            err_ = SHARE_get_len(share_, &len);
+        if ((err_ == NONE) && (len != split_len))
+            err_ = PARAM_BAD_LEN;
+    }
+
+    /**
+     * Zeroize the object.
+     */
+    ~Share()
+    {
+        SHARE_free(share_);
+    }
+
+    Share(const Share &) = delete;
+    Share &operator=(const Share &) = delete;
+
+    /**
+     * Get the error of initializing the object.
+     *
+     * @return  NONE when the object is usable.<br>
+     *          Otherwise the error of SHARE_init().
+     */
+    SHARE_ERR error() const noexcept
+    {
+        return err_;
+    }
+
+    /**
+     * Get the name of the implementation.
+     *
+     * @return  The name of the implementation or an empty string.
+     */
+    const char *impl_name() const noexcept
+    {
+        char *name = nullptr;
+
+        if ((err_ != NONE) || (SHARE_get_impl_name(share_, &name) != NONE))
+            return "";
+        return name;
+    }
+
+    /**
+     * Split the secret into N splits. Any Parts of the splits recreate it.
+     *
+     * @param [in]  secret  The secret to split.
+     * @param [out] splits  The encoded splits.
+     * @return  The error of SHARE_split_init() or SHARE_split_n().
+     */
+    template <std::size_t N>
+    SHARE_ERR split(const Secret &secret, Splits<N> &splits) noexcept
+    {
+        static_assert(N <= UINT16_MAX, "Too many splits");
+        static_assert(sizeof(Splits<N>) == N * split_len,
+            "Splits must be contiguous");
+
+        return split(secret, splits.data(), N);
+    }
+
+    /**
+     * Join the first Parts splits to recreate the secret.
+     *
+     * @param [in]  splits  The encoded splits.
+     * @param [out] secret  The recreated secret.
+     * @return  The error of SHARE_join_update_n() or SHARE_join_final().
+     */
+    template <std::size_t N>
+    SHARE_ERR join(const Splits<N> &splits, Secret &secret) noexcept
+    {
+        static_assert(N >= Parts, "Not enough splits to join");
+
+        return join(splits.data(), secret);
+    }
+
+#if __cplusplus >= 202002L
+    /**
+     * Split the secret into as many splits as the span holds.
+     *
+     * @param [in]  secret  The secret to split.
+     * @param [out] splits  The encoded splits.
+     * @return  PARAM_BAD_LEN when the span holds too many splits.<br>
+     *          The error of SHARE_split_init() or SHARE_split_n().
+     */
+    SHARE_ERR split(const Secret &secret, std::span<Split> splits) noexcept
+    {
+        if (splits.size() > UINT16_MAX)
+            return PARAM_BAD_LEN;
+        return split(secret, splits.data(), splits.size());
+    }
+
+    /**
+     * Join the first Parts splits of the span to recreate the secret.
+     *
+     * @param [in]  splits  The encoded splits.
+     * @param [out] secret  The recreated secret.
+     * @return  PARAM_BAD_LEN when the span holds too few splits.<br>
+     *          The error of SHARE_join_update_n() or SHARE_join_final().
+     */
+    SHARE_ERR join(std::span<const Split> splits, Secret &secret) noexcept
+    {
+        if (splits.size() < Parts)
+            return PARAM_BAD_LEN;
+        return join(splits.data(), secret);
+    }
+#endif
+
+private:
+    /**
+     * Split the secret into n splits.
+     *
+     * @param [in]  secret  The secret to split.
+     * @param [out] splits  The encoded splits.
+     * @param [in]  n       The number of splits.
+     * @return  The error of SHARE_split_init() or SHARE_split_n().
+     */
+    SHARE_ERR split(const Secret &secret, Split *splits, std::size_t n)
+        noexcept
+    {
+        SHARE_ERR err = err_;
+
+        /* The secret is only read. */
+        if (err == NONE)
+            err = SHARE_split_init(share_,
+                const_cast<std::uint8_t *>(secret.data()));
+        if (err == NONE)
+            err = SHARE_split_n(share_, splits->data(),
+                static_cast<std::uint16_t>(n));
+
+        return err;
+    }
+
+    /**
+     * Join Parts splits to recreate the secret.
+     *
+     * @param [in]  splits  The encoded splits.
+     * @param [out] secret  The recreated secret.
+     * @return  The error of SHARE_join_update_n() or SHARE_join_final().
+     */
+    SHARE_ERR join(const Split *splits, Secret &secret) noexcept
+    {
+        SHARE_ERR err = err_;
+
+        if (err == NONE)
+            err = SHARE_join_init(share_);
+        /* The splits are only read. */
+        if (err == NONE)
+            err = SHARE_join_update_n(share_,
+                const_cast<std::uint8_t *>(splits->data()), Parts);
+        if (err == NONE)
+            err = SHARE_join_final(share_, secret.data());
+
+        return err;
+    }
+
+    /** The memory holding the object, its numbers and its scratch space.
+     * Numbers modulo 2^255-19 are 32 bytes for secrets of any length. */
+    alignas(SHARE_MEM_ALIGN) std::array<std::uint8_t,
+        SHARE_SIZE_MAX((Flags & SHARE_METHS_FLAG_P254) ? 254 : Bits,
+            Parts)> mem_;
+    /** The object in mem_. */
+    SHARE *share_ = nullptr;
+    /** The error of initializing the object. */
+    SHARE_ERR err_ = NONE;
+};
+
+}
+
+#endif
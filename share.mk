@@ -20,19 +20,66 @@
 #
 
 
-all: share_test
+all: share_test share_hpp_test
 
-SHARE_IMPL=share_openssl.o share_p126.o share_p128.o share_p192.o share_p256.o
+SHARE_IMPL=share_openssl.o share_p60.o share_p126.o share_p128.o share_p192.o share_p256.o
+SHARE_IMPL+=share_p192_ifma.o share_p256_ifma.o
+SHARE_IMPL+=share_p126_avx2.o share_p128_avx2.o share_p192_avx2.o
+SHARE_IMPL+=share_p256_avx2.o
+SHARE_IMPL+=share_p126_adx.o share_p128_adx.o share_p192_adx.o share_p256_adx.o
+SHARE_IMPL+=share_p384.o share_p520.o
+SHARE_IMPL+=share_p254_r51.o
+SHARE_IMPL+=share_gf8.o share_gf8_ssse3.o share_gf8_avx2.o
+SHARE_IMPL+=share_gf128.o share_gf128_clmul.o
+SHARE_IMPL+=share_mont.o
+SHARE_IMPL+=share_p64_ntt.o
+SHARE_IMPL+=share_xor.o
 
-src/prime/share_p126.c: src/prime/share_prime.rb
+IFMA_CFLAGS=-mavx512f -mavx512ifma
+AVX2_CFLAGS=-mavx2
+SSSE3_CFLAGS=-mssse3
+PCLMUL_CFLAGS=-msse2 -mpclmul
+
+src/prime/share_p60.c: src/prime/share_prime.rb src/share_tune.h
+	ruby ./src/prime/share_prime.rb 60 1 > src/prime/share_p60.c
+src/prime/share_p126.c: src/prime/share_prime.rb src/share_tune.h
 	ruby ./src/prime/share_prime.rb 126 1 > src/prime/share_p126.c
-src/prime/share_p128.c: src/prime/share_prime.rb
+src/prime/share_p128.c: src/prime/share_prime.rb src/share_tune.h
 	ruby ./src/prime/share_prime.rb 128 19 > src/prime/share_p128.c
-src/prime/share_p192.c: src/prime/share_prime.rb
+src/prime/share_p192.c: src/prime/share_prime.rb src/share_tune.h
 	ruby ./src/prime/share_prime.rb 192 1f > src/prime/share_p192.c
-src/prime/share_p256.c: src/prime/share_prime.rb
+src/prime/share_p256.c: src/prime/share_prime.rb src/share_tune.h
 	ruby ./src/prime/share_prime.rb 256 5d > src/prime/share_p256.c
+src/prime/share_p384.c: src/prime/share_prime.rb src/share_tune.h
+	ruby ./src/prime/share_prime.rb 384 109 > src/prime/share_p384.c
+src/prime/share_p520.c: src/prime/share_prime.rb src/share_tune.h
+	ruby ./src/prime/share_prime.rb 520 1 > src/prime/share_p520.c
+src/prime/share_p254_r51.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 254 13 r51 > src/prime/share_p254_r51.c
+src/prime/share_p192_ifma.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 192 1f ifma > src/prime/share_p192_ifma.c
+src/prime/share_p256_ifma.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 256 5d ifma > src/prime/share_p256_ifma.c
+src/prime/share_p126_avx2.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 126 1 avx2 > src/prime/share_p126_avx2.c
+src/prime/share_p128_avx2.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 128 19 avx2 > src/prime/share_p128_avx2.c
+src/prime/share_p192_avx2.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 192 1f avx2 > src/prime/share_p192_avx2.c
+src/prime/share_p256_avx2.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 256 5d avx2 > src/prime/share_p256_avx2.c
+src/prime/share_p126_adx.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 126 1 adx > src/prime/share_p126_adx.c
+src/prime/share_p128_adx.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 128 19 adx > src/prime/share_p128_adx.c
+src/prime/share_p192_adx.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 192 1f adx > src/prime/share_p192_adx.c
+src/prime/share_p256_adx.c: src/prime/share_prime.rb
+	ruby ./src/prime/share_prime.rb 256 5d adx > src/prime/share_p256_adx.c
+
 
+share_p60.o: src/prime/share_p60.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
 share_p126.o: src/prime/share_p126.c src/*.h include/*.h
 	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
 share_p129.o: src/prime/share_p129.c src/*.h include/*.h
@@ -43,18 +90,70 @@ share_p192.o: src/prime/share_p192.c src/*.h include/*.h
 	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
 share_p256.o: src/prime/share_p256.c src/*.h include/*.h
 	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p384.o: src/prime/share_p384.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p520.o: src/prime/share_p520.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p254_r51.o: src/prime/share_p254_r51.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p192_ifma.o: src/prime/share_p192_ifma.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(IFMA_CFLAGS) -Isrc -o $@ $<
+share_p256_ifma.o: src/prime/share_p256_ifma.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(IFMA_CFLAGS) -Isrc -o $@ $<
+share_p126_avx2.o: src/prime/share_p126_avx2.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(AVX2_CFLAGS) -Isrc -o $@ $<
+share_p128_avx2.o: src/prime/share_p128_avx2.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(AVX2_CFLAGS) -Isrc -o $@ $<
+share_p192_avx2.o: src/prime/share_p192_avx2.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(AVX2_CFLAGS) -Isrc -o $@ $<
+share_p256_avx2.o: src/prime/share_p256_avx2.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(AVX2_CFLAGS) -Isrc -o $@ $<
+share_p126_adx.o: src/prime/share_p126_adx.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p128_adx.o: src/prime/share_p128_adx.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p192_adx.o: src/prime/share_p192_adx.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_p256_adx.o: src/prime/share_p256_adx.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+share_gf8_ssse3.o: src/share_gf8_ssse3.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(SSSE3_CFLAGS) -o $@ $<
+share_gf8_avx2.o: src/share_gf8_avx2.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(AVX2_CFLAGS) -o $@ $<
+share_gf128_clmul.o: src/share_gf128_clmul.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(PCLMUL_CFLAGS) -o $@ $<
 
-SHARE_OBJ=share.o $(SHARE_IMPL) share_meth.o random.o share_sha3.o
+
+SHARE_OBJ=share.o $(SHARE_IMPL) share_meth.o share_alloc.o share_pool.o random.o
+SHARE_OBJ+=share_sha3.o
 
 %.o: src/%.c src/*.h include/*.h
 	$(CC) -c $(CFLAGS) -o $@ $<
 
-share_test.o: test/share_test.c
-	$(CC) -c $(CFLAGS) -Isrc -o $@ $<
+# The test counts the dynamic memory allocations of splitting and joining by
+# wrapping malloc. Clear these on toolchains whose linker can't wrap symbols.
+TEST_CFLAGS=-DSHARE_TEST_ALLOC_COUNT
+TEST_LDFLAGS=-Wl,--wrap=malloc
+
+share_test.o: test/share_test.c src/*.h include/*.h
+	$(CC) -c $(CFLAGS) $(TEST_CFLAGS) -Isrc -o $@ $<
 share_test: share_test.o $(SHARE_OBJ)
-	$(CC) -o $@ $^ $(LIBS)
+	$(CC) $(TEST_LDFLAGS) -o $@ $^ $(LIBS)
+
+# The header-only C++ API is built as C++17 and as C++20, which adds std::span.
+share_hpp_test: share_hpp_test_cpp17 share_hpp_test_cpp20
+share_hpp_test_cpp17: test/share_hpp_test.cpp include/*.h include/*.hpp $(SHARE_OBJ)
+	$(CXX) -std=c++17 $(CXXFLAGS) -o $@ $< $(SHARE_OBJ) $(LIBS)
+share_hpp_test_cpp20: test/share_hpp_test.cpp include/*.h include/*.hpp $(SHARE_OBJ)
+	$(CXX) -std=c++20 $(CXXFLAGS) -o $@ $< $(SHARE_OBJ) $(LIBS)
+
+# Benchmark the kernel variants of the C implementations on this host and
+# keep the fastest.
+autotune:
+	ruby ./tool/tune.rb src/share_tune.h $(CC) $(CFLAGS)
+	$(MAKE) all
 
 clean:
 	rm -f *.o
-	rm -f share_test
+	rm -f share_test share_hpp_test_cpp17 share_hpp_test_cpp20
 
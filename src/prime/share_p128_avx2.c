@@ -0,0 +1,2460 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+#define NUM_ELEMS	3
+#define NUM_BYTES	17
+#define MOD_WORD	0x19
+
+#define U128(w)		((__uint128_t)w)
+
+#include <immintrin.h>
+
+/** The number of numbers operated on at once. */
+#define LANES		4
+/** The number of limbs in a lane number. */
+#define LANE_ELEMS	5
+/** The number of bits in a limb of a lane number. */
+#define LANE_BITS	29
+/** The mask for a limb of a lane number. */
+#define LANE_MASK	0x1fffffff
+/** The number of bits of the modulus in the top limb of a lane number. */
+#define LANE_TOP_BITS	13
+/** The mask for the bits of the modulus in the top limb of a lane number. */
+#define LANE_TOP_MASK	0x1fff
+
+/** A vector holding the same limb of each lane. */
+typedef __m256i lane_t;
+
+/* Operations on all lanes. */
+#define LANE_ZERO()		_mm256_setzero_si256()
+#define LANE_SET(w)		_mm256_set1_epi64x(w)
+#define LANE_LOAD(p)		_mm256_loadu_si256((__m256i *)(p))
+#define LANE_STORE(p, a)	_mm256_storeu_si256((__m256i *)(p), a)
+#define LANE_ADD(a, b)		_mm256_add_epi64(a, b)
+#define LANE_SUB(a, b)		_mm256_sub_epi64(a, b)
+#define LANE_AND(a, b)		_mm256_and_si256(a, b)
+#define LANE_OR(a, b)		_mm256_or_si256(a, b)
+#define LANE_SHR(a, n)		_mm256_srli_epi64(a, n)
+#define LANE_SHL(a, n)		_mm256_slli_epi64(a, n)
+/* One in the lanes where a and b are equal and zero otherwise. */
+#define LANE_EQ_ONE(a, b)	    _mm256_and_si256(_mm256_cmpeq_epi64(a, b), _mm256_set1_epi64x(1))
+/* Add the 64-bit product of the low 32 bits of a and b to t. */
+#define LANE_MUL(t, a, b)	_mm256_add_epi64(t, _mm256_mul_epu32(a, b))
+
+/**
+ * Copy the data of the number object into the result number object.
+ *
+ * @param [in] r  The result number object.
+ * @param [in] a  The number object to copy.
+ */
+static void p128_copy(uint64_t *r, uint64_t *a)
+{
+    r[0] = a[0];
+    r[1] = a[1];
+    r[2] = a[2];
+}
+/**
+ * Multiply by prime's (mod's) last word.
+ *
+ * @param [in] a  The number to multiply.
+ * @return  The multiplicative result.
+ */
+#define MUL_MOD_WORD(a) \
+    (((a) << 4) + ((a) << 3) + (a))
+
+/**
+ * Perform modulo operation on number, a, up to 16-bits longer than the prime
+ * and put result in r.
+ *
+ * @param [in] r  The result of the reduction.
+ * @param [in] a  The number to operate on.
+ */
+static void p128_mod_small(uint64_t *r, uint64_t *a)
+{
+    __int128_t t;
+
+    t = (a[2] >> 1) * MOD_WORD; a[2] &= 0x1;
+    t += a[0]; r[0] = t; t >>= 64;
+    t += a[1]; r[1] = t; t >>= 64;
+    t += a[2]; r[2] = t;
+}
+
+/**
+ * Perform modulo operation on a product result in 128-bit elements.
+ *
+ * @param [in] r  The number reduce number.
+ * @param [in] a  The product result in 128-bit elements.
+ */
+static void p128_mod_long(uint64_t *r, __uint128_t *a)
+{
+    __uint128_t t;
+
+    t = (a[2] >> 1) + ((uint64_t)a[3] << 63); a[0] += MUL_MOD_WORD(t);
+    t = (a[3] >> 1) + ((uint64_t)a[4] << 63); a[1] += MUL_MOD_WORD(t);
+
+    r[0] = a[0]; a[1] += a[0] >> 64;
+    r[1] = a[1];
+    r[2] = (a[2] & 1) + (a[1] >> 64);
+
+    p128_mod_small(r, r);
+}
+
+/**
+ * Multiply two numbers, a and b, modulo the prime amd put in result in r.
+ *
+ * @param [in] r  The result of the multiplication.
+ * @param [in] a  The first operand number object.
+ * @param [in] b  The first operand number object.
+ */
+static void p128_mod_mul(uint64_t *r, uint64_t *a, uint64_t *b)
+{
+    uint64_t p64;
+    __uint128_t p128;
+    __uint128_t t[5];
+
+    t[0] = 0; t[1] = 0; t[2] = 0; t[3] = 0; t[4] = 0;
+
+    p128 = U128(a[0]) * b[0];
+    t[0] += (uint64_t)p128;
+    t[1] += p128 >> 64;
+    p128 = U128(a[0]) * b[1];
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    p128 = U128(a[1]) * b[0];
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    p64 = a[0] & (0 - b[2]);
+    t[2] += p64;
+    p128 = U128(a[1]) * b[1];
+    t[2] += (uint64_t)p128;
+    t[3] += p128 >> 64;
+    p64 = b[0] & (0 - a[2]);
+    t[2] += p64;
+    p64 = a[1] & (0 - b[2]);
+    t[3] += p64;
+    p64 = b[1] & (0 - a[2]);
+    t[3] += p64;
+    p64 = a[2] & b[2];
+    t[4] += p64;
+
+    p128_mod_long(r, t);
+}
+
+/**
+ * Multiply two numbers, a and b, add c and reduce modulo the prime and put
+ * result in r. The result is not fully reduced.
+ *
+ * @param [in] r  The result of the multiplication and addition.
+ * @param [in] a  The first operand number object.
+ * @param [in] b  The second operand number object.
+ * @param [in] c  The number object to add.
+ */
+static void p128_mod_mul_add(uint64_t *r, uint64_t *a, uint64_t *b,
+    uint64_t *c)
+{
+    uint64_t p64;
+    __uint128_t p128;
+    __uint128_t t[5];
+
+    t[0] = c[0]; t[1] = c[1]; t[2] = c[2]; t[3] = 0; t[4] = 0;
+
+    p128 = U128(a[0]) * b[0];
+    t[0] += (uint64_t)p128;
+    t[1] += p128 >> 64;
+    p128 = U128(a[0]) * b[1];
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    p128 = U128(a[1]) * b[0];
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    p64 = a[0] & (0 - b[2]);
+    t[2] += p64;
+    p128 = U128(a[1]) * b[1];
+    t[2] += (uint64_t)p128;
+    t[3] += p128 >> 64;
+    p64 = b[0] & (0 - a[2]);
+    t[2] += p64;
+    p64 = a[1] & (0 - b[2]);
+    t[3] += p64;
+    p64 = b[1] & (0 - a[2]);
+    t[3] += p64;
+    p64 = a[2] & b[2];
+    t[4] += p64;
+
+    p128_mod_long(r, t);
+}
+
+/**
+ * Reduce the number that is less than 2 times the prime modulo the prime.
+ *
+ * @param [in] r  The result of the reduction.
+ * @param [in] a  The number to reduce.
+ */
+static void p128_mod(uint64_t *r,uint64_t *a)
+{
+    uint64_t c;
+    __int128_t t;
+
+    c = (a[2] == 0x1) & (a[1] == 0xffffffffffffffff) & (a[0] >= 0xffffffffffffffe7);
+    t = c * MOD_WORD;
+    t += a[0]; r[0] = t; t >>= 64;
+    t += a[1]; r[1] = t; t >>= 64;
+    t += a[2]; r[2] = t & 0x1;
+}
+
+/** The number of bits in a limb of a signed number used in inversion. */
+#define INV_BITS	62
+/** The mask for a limb of a signed number used in inversion. */
+#define INV_MASK	0x3fffffffffffffff
+/** The number of limbs in a signed number used in inversion. */
+#define INV_ELEMS	3
+/** The number of iterations of INV_BITS division steps that guarantees the
+ * inversion is complete: 375 steps are required for 129 bits. */
+#define INV_ITER	7
+/** The inverse of the prime modulo 2^INV_BITS. */
+#define INV_MOD_INV	0x30a3d70a3d70a3d7
+
+/** The prime in signed limbs. */
+static const int64_t p128_inv_mod[INV_ELEMS] = {
+    0x3fffffffffffffe7,
+    0x3fffffffffffffff,
+    0x1f
+};
+
+/**
+ * Apply the transition matrix to f and g and divide by 2^INV_BITS.
+ * The bottom INV_BITS bits are zero before the division.
+ *
+ * @param [in] f  The signed number f.
+ * @param [in] g  The signed number g.
+ * @param [in] t  The transition matrix.
+ */
+static void p128_inv_update_fg(int64_t *f, int64_t *g, int64_t *t)
+{
+    __int128_t cf, cg;
+    int i;
+
+    cf = (__int128_t)t[0] * f[0] + (__int128_t)t[1] * g[0];
+    cg = (__int128_t)t[2] * f[0] + (__int128_t)t[3] * g[0];
+    cf >>= INV_BITS; cg >>= INV_BITS;
+    for (i=1; i<INV_ELEMS; i++)
+    {
+        cf += (__int128_t)t[0] * f[i] + (__int128_t)t[1] * g[i];
+        cg += (__int128_t)t[2] * f[i] + (__int128_t)t[3] * g[i];
+        f[i-1] = (int64_t)((uint64_t)cf & INV_MASK); cf >>= INV_BITS;
+        g[i-1] = (int64_t)((uint64_t)cg & INV_MASK); cg >>= INV_BITS;
+    }
+    f[INV_ELEMS-1] = (int64_t)cf;
+    g[INV_ELEMS-1] = (int64_t)cg;
+}
+
+/**
+ * Apply the transition matrix to d and e and divide by 2^INV_BITS modulo the
+ * prime. A multiple of the prime is added to make the bottom bits zero.
+ * d and e are in the range (-2.prime, prime) before and after.
+ *
+ * @param [in] d  The signed number d.
+ * @param [in] e  The signed number e.
+ * @param [in] t  The transition matrix.
+ */
+static void p128_inv_update_de(int64_t *d, int64_t *e, int64_t *t)
+{
+    int64_t u = t[0], v = t[1], q = t[2], r = t[3];
+    int64_t md, me, sd, se;
+    __int128_t cd, ce;
+    int i;
+
+    /* Add [u, q] when d is negative and [v, r] when e is negative. */
+    sd = d[INV_ELEMS-1] >> 63;
+    se = e[INV_ELEMS-1] >> 63;
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+    cd = (__int128_t)u * d[0] + (__int128_t)v * e[0];
+    ce = (__int128_t)q * d[0] + (__int128_t)r * e[0];
+    /* Multiples of the prime that make the bottom bits zero. */
+    md -= (int64_t)((INV_MOD_INV * (uint64_t)cd + (uint64_t)md) & INV_MASK);
+    me -= (int64_t)((INV_MOD_INV * (uint64_t)ce + (uint64_t)me) & INV_MASK);
+    cd += (__int128_t)p128_inv_mod[0] * md;
+    ce += (__int128_t)p128_inv_mod[0] * me;
+    cd >>= INV_BITS; ce >>= INV_BITS;
+    for (i=1; i<INV_ELEMS; i++)
+    {
+        cd += (__int128_t)u * d[i] + (__int128_t)v * e[i];
+        ce += (__int128_t)q * d[i] + (__int128_t)r * e[i];
+        cd += (__int128_t)p128_inv_mod[i] * md;
+        ce += (__int128_t)p128_inv_mod[i] * me;
+        d[i-1] = (int64_t)((uint64_t)cd & INV_MASK); cd >>= INV_BITS;
+        e[i-1] = (int64_t)((uint64_t)ce & INV_MASK); ce >>= INV_BITS;
+    }
+    d[INV_ELEMS-1] = (int64_t)cd;
+    e[INV_ELEMS-1] = (int64_t)ce;
+}
+
+/**
+ * Initialize the signed numbers of an inversion of a.
+ * f = prime, g = a, d = 0, e = 1 - d.a = f and e.a = g modulo prime.
+ *
+ * @param [in] f  The signed number f.
+ * @param [in] g  The signed number g.
+ * @param [in] d  The signed number d.
+ * @param [in] e  The signed number e.
+ * @param [in] a  The number to invert.
+ */
+static void p128_inv_init(int64_t *f, int64_t *g, int64_t *d, int64_t *e,
+    uint64_t *a)
+{
+    uint64_t n[NUM_ELEMS];
+    int i;
+
+    p128_mod(n, a);
+    g[0] = (int64_t)(n[0] & INV_MASK);
+    g[1] = (int64_t)(((n[0] >> 62) | (n[1] << 2)) & INV_MASK);
+    g[2] = (int64_t)((n[1] >> 60) | (n[2] << 4));
+    for (i=0; i<INV_ELEMS; i++)
+    {
+        f[i] = p128_inv_mod[i];
+        d[i] = 0;
+        e[i] = 0;
+    }
+    e[0] = 1;
+}
+
+/**
+ * Calculate the inverse from d once g is zero and f is 1 or -1.
+ * Bring d into the range (-prime, prime), negate when f is -1, and then into
+ * the range [0, prime).
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] d  The signed number d.
+ * @param [in] f  The signed number f.
+ */
+static void p128_inv_final(uint64_t *r, int64_t *d, int64_t *f)
+{
+    int64_t c;
+    int i;
+
+    c = d[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] += p128_inv_mod[i] & c;
+    c = f[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] = (d[i] ^ c) - c;
+    for (i=0; i<INV_ELEMS-1; i++)
+    {
+        d[i+1] += d[i] >> INV_BITS;
+        d[i] &= INV_MASK;
+    }
+    c = d[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] += p128_inv_mod[i] & c;
+    for (i=0; i<INV_ELEMS-1; i++)
+    {
+        d[i+1] += d[i] >> INV_BITS;
+        d[i] &= INV_MASK;
+    }
+
+    r[0] = (uint64_t)d[0] | ((uint64_t)d[1] << 62);
+    r[1] = ((uint64_t)d[1] >> 2) | ((uint64_t)d[2] << 60);
+    r[2] = ((uint64_t)d[2] >> 4);
+}
+
+#ifdef SHARE_INV_FERMAT
+
+/**
+ * Square the number, a, modulo the prime and put in result in r.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number object to square.
+ */
+static void p128_mod_sqr(uint64_t *r, uint64_t *a)
+{
+    uint64_t p64;
+    __uint128_t p128;
+    __uint128_t t[5];
+
+    t[0] = 0; t[1] = 0; t[2] = 0; t[3] = 0; t[4] = 0;
+
+    p128 = U128(a[0]) * a[0];
+    t[0] += (uint64_t)p128;
+    t[1] += p128 >> 64;
+    p128 = U128(a[0]) * a[1];
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    t[1] += (uint64_t)p128;
+    t[2] += p128 >> 64;
+    p64 = a[0] & (0 - a[2]);
+    t[2] += p64;
+    t[2] += p64;
+    p128 = U128(a[1]) * a[1];
+    t[2] += (uint64_t)p128;
+    t[3] += p128 >> 64;
+    p64 = a[1] & (0 - a[2]);
+    t[3] += p64;
+    t[3] += p64;
+    p64 = a[2];
+    t[4] += p64;
+
+    p128_mod_long(r, t);
+}
+
+/**
+ * Square the number, a, modulo the prime n times and put in result in r.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number object to square.
+ * @param [in] n  The number of times to square.
+ */
+static void p128_mod_sqr_n(uint64_t *r, uint64_t *a, uint16_t n)
+{
+    uint16_t i;
+
+    p128_mod_sqr(r, a);
+    for (i=1; i<n; i++)
+        p128_mod_sqr(r, r);
+}
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p128_mod_inv(uint64_t *r, uint64_t *a)
+{
+    uint64_t t[NUM_ELEMS];
+    uint64_t t2[NUM_ELEMS];
+    uint64_t t3[NUM_ELEMS];
+    uint64_t t5[NUM_ELEMS];
+
+    p128_mod_sqr(t2, a);
+    p128_mod_sqr(t, t2); p128_mod_mul(t5, a, t);
+    				p128_mod_mul(t, t2, a);		/* 2 */
+    p128_mod_sqr_n(t, t, 1);	p128_mod_mul(t, t, a);		/* 3 */
+    p128_mod_sqr_n(t2, t, 3);	p128_mod_mul(t3, t2, t);	/* 6 */
+    p128_mod_sqr_n(t2, t3, 6);	p128_mod_mul(t3, t2, t3);	/* 12 */
+    p128_mod_sqr_n(t2, t3, 3);	p128_mod_mul(t, t2, t);		/* 15 */
+    p128_mod_sqr_n(t2, t, 15);	p128_mod_mul(t, t2, t);		/* 30 */
+    p128_mod_sqr(t2, t);	p128_mod_mul(t, t2, a);		/* 31 */
+    p128_mod_sqr_n(t2, t, 31);	p128_mod_mul(t, t2, t);		/* 62 */
+    p128_mod_sqr_n(t2, t, 62);	p128_mod_mul(t, t2, t);		/* 124 */
+    p128_mod_sqr_n(t, t, 5);
+    p128_mod_mul(r, t, t5);
+}
+#else
+
+/**
+ * Perform INV_BITS division steps on the bottom bits of f and g.
+ * The transition matrix, scaled by 2^INV_BITS, is put in t: [u, v, q, r].
+ * Constant time - the steps are performed with masks.
+ *
+ * @param [in]  delta  The delta value before the steps.
+ * @param [in]  f      The bottom bits of f.
+ * @param [in]  g      The bottom bits of g.
+ * @param [out] t      The transition matrix.
+ * @return  The delta value after the steps.
+ */
+static int64_t p128_inv_divsteps(int64_t delta, uint64_t f, uint64_t g,
+    int64_t *t)
+{
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t c1, c2, x;
+    int i;
+
+    for (i=0; i<INV_BITS; i++)
+    {
+        /* c1 is all ones when delta > 0 and g is odd. */
+        c1 = (0 - ((uint64_t)(0 - delta) >> 63)) & (0 - (g & 1));
+        /* When c1: delta = -delta, (f, g) = (g, -f), (u, v, q, r) =
+         * (q, r, -u, -v). */
+        x = (f ^ g) & c1; f ^= x; g ^= x; g = (g ^ c1) - c1;
+        x = (u ^ q) & c1; u ^= x; q ^= x; q = (q ^ c1) - c1;
+        x = (v ^ r) & c1; v ^= x; r ^= x; r = (r ^ c1) - c1;
+        delta = (delta ^ (int64_t)c1) - (int64_t)c1 + 1;
+        /* When g is odd: g += f, q += u, r += v. */
+        c2 = 0 - (g & 1);
+        g += f & c2; q += u & c2; r += v & c2;
+        g >>= 1; u <<= 1; v <<= 1;
+    }
+
+    t[0] = (int64_t)u; t[1] = (int64_t)v; t[2] = (int64_t)q; t[3] = (int64_t)r;
+    return delta;
+}
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ * Constant time division steps (Bernstein and Yang) are used.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p128_mod_inv(uint64_t *r, uint64_t *a)
+{
+    int64_t f[INV_ELEMS], g[INV_ELEMS], d[INV_ELEMS], e[INV_ELEMS];
+    int64_t t[4];
+    int64_t delta = 1;
+    int i;
+
+    p128_inv_init(f, g, d, e, a);
+    for (i=0; i<INV_ITER; i++)
+    {
+        delta = p128_inv_divsteps(delta, (uint64_t)f[0], (uint64_t)g[0], t);
+        p128_inv_update_de(d, e, t);
+        p128_inv_update_fg(f, g, t);
+    }
+    /* g is zero and f is 1 or -1: the inverse is d or -d. */
+    p128_inv_final(r, d, f);
+}
+#endif
+
+/**
+ * Perform INV_BITS division steps on the bottom bits of f and g.
+ * The transition matrix, scaled by 2^INV_BITS, is put in t: [u, v, q, r].
+ * Variable time - runs of zero bits in g are skipped at once and up to six
+ * bits of g are eliminated with each multiple of f.
+ * Only to be used on public values.
+ *
+ * @param [in]  delta  The delta value before the steps.
+ * @param [in]  f      The bottom bits of f.
+ * @param [in]  g      The bottom bits of g.
+ * @param [out] t      The transition matrix.
+ * @return  The delta value after the steps.
+ */
+static int64_t p128_inv_divsteps_vt(int64_t delta, uint64_t f, uint64_t g,
+    int64_t *t)
+{
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t m, w, x;
+    int i = INV_BITS, limit, zeros;
+
+    for (;;)
+    {
+        /* Remove the zero bits at the bottom of g - at most i. */
+        zeros = __builtin_ctzll(g | ((uint64_t)-1 << i));
+        g >>= zeros; u <<= zeros; v <<= zeros;
+        delta += zeros;
+        i -= zeros;
+        if (i == 0)
+            break;
+
+        /* g is odd. */
+        if (delta > 0)
+        {
+            /* delta = -delta, (f, g) = (g, -f), (u, v, q, r) =
+             * (q, r, -u, -v). */
+            delta = -delta;
+            x = f; f = g; g = 0 - x;
+            x = u; u = q; q = 0 - x;
+            x = v; v = r; r = 0 - x;
+            /* Eliminate up to 6 bits: w = -g/f mod 2^limit. */
+            limit = ((int)(1 - delta) > i) ? i : (int)(1 - delta);
+            m = ((uint64_t)-1 >> (64 - limit)) & 63;
+            w = (f * g * (f * f - 2)) & m;
+        }
+        else
+        {
+            /* Eliminate up to 4 bits: w = -g/f mod 2^limit. */
+            limit = ((int)(1 - delta) > i) ? i : (int)(1 - delta);
+            m = ((uint64_t)-1 >> (64 - limit)) & 15;
+            w = f + (((f + 1) & 4) << 1);
+            w = ((0 - w) * g) & m;
+        }
+        g += f * w; q += u * w; r += v * w;
+    }
+
+    t[0] = (int64_t)u; t[1] = (int64_t)v; t[2] = (int64_t)q; t[3] = (int64_t)r;
+    return delta;
+}
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ * Variable time division steps (Bernstein and Yang) are used that stop as
+ * soon as g is zero.
+ * Only to be used on public values.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p128_mod_inv_vt(uint64_t *r, uint64_t *a)
+{
+    int64_t f[INV_ELEMS], g[INV_ELEMS], d[INV_ELEMS], e[INV_ELEMS];
+    int64_t t[4];
+    int64_t delta = 1;
+    int64_t z;
+    int i;
+
+    p128_inv_init(f, g, d, e, a);
+    do
+    {
+        delta = p128_inv_divsteps_vt(delta, (uint64_t)f[0], (uint64_t)g[0],
+            t);
+        p128_inv_update_de(d, e, t);
+        p128_inv_update_fg(f, g, t);
+
+        for (i=0,z=0; i<INV_ELEMS; i++)
+            z |= g[i];
+    }
+    while (z != 0);
+    /* g is zero and f is 1 or -1: the inverse is d or -d. */
+    p128_inv_final(r, d, f);
+}
+
+/**
+ * Convert LANES number objects into a lane number.
+ *
+ * @param [in] r  The lane number.
+ * @param [in] a  The array of LANES number objects.
+ */
+static void p128_lane_from_num(lane_t *r, uint64_t **a)
+{
+    uint64_t t[LANE_ELEMS][LANES];
+    uint64_t *n;
+    int i;
+
+    for (i=0; i<LANES; i++)
+    {
+        n = a[i];
+        t[0][i] = n[0] & LANE_MASK;
+        t[1][i] = (n[0] >> 29) & LANE_MASK;
+        t[2][i] = ((n[0] >> 58) | (n[1] << 6)) & LANE_MASK;
+        t[3][i] = (n[1] >> 23) & LANE_MASK;
+        t[4][i] = ((n[1] >> 52) | (n[2] << 12)) & LANE_MASK;
+    }
+
+    r[0] = LANE_LOAD(t[0]);
+    r[1] = LANE_LOAD(t[1]);
+    r[2] = LANE_LOAD(t[2]);
+    r[3] = LANE_LOAD(t[3]);
+    r[4] = LANE_LOAD(t[4]);
+}
+
+/**
+ * Set all lanes of a lane number to the value of the number object.
+ *
+ * @param [in] r  The lane number.
+ * @param [in] a  The number object.
+ */
+static void p128_lane_set(lane_t *r, uint64_t *a)
+{
+    r[0] = LANE_SET(a[0] & LANE_MASK);
+    r[1] = LANE_SET((a[0] >> 29) & LANE_MASK);
+    r[2] = LANE_SET(((a[0] >> 58) | (a[1] << 6)) & LANE_MASK);
+    r[3] = LANE_SET((a[1] >> 23) & LANE_MASK);
+    r[4] = LANE_SET(((a[1] >> 52) | (a[2] << 12)) & LANE_MASK);
+}
+
+/**
+ * Convert a lane number into LANES fully reduced number objects.
+ *
+ * @param [in] r  The array of LANES number objects.
+ * @param [in] a  The lane number.
+ */
+static void p128_lane_to_num(uint64_t **r, lane_t *a)
+{
+    uint64_t t[LANE_ELEMS][LANES];
+    uint64_t *n;
+    int i;
+
+    LANE_STORE(t[0], a[0]);
+    LANE_STORE(t[1], a[1]);
+    LANE_STORE(t[2], a[2]);
+    LANE_STORE(t[3], a[3]);
+    LANE_STORE(t[4], a[4]);
+
+    for (i=0; i<LANES; i++)
+    {
+        n = r[i];
+        n[0] = t[0][i] | (t[1][i] << 29) | (t[2][i] << 58);
+        n[1] = (t[2][i] >> 6) | (t[3][i] << 23) | (t[4][i] << 52);
+        n[2] = (t[4][i] >> 12);
+        p128_mod(n, n);
+    }
+}
+
+/**
+ * Reduce the product of lane numbers modulo the prime.
+ * The result has limbs of LANE_BITS bits but is not fully reduced.
+ *
+ * @param [in] r  The reduced lane number.
+ * @param [in] t  The product in 2 * LANE_ELEMS unnormalized limbs.
+ */
+static void p128_lane_mod_long(lane_t *r, lane_t *t)
+{
+    lane_t m = LANE_SET(LANE_MASK);
+    lane_t tm = LANE_SET(LANE_TOP_MASK);
+    lane_t w = LANE_SET(MOD_WORD);
+    lane_t h[LANE_ELEMS];
+    lane_t q;
+
+    /* Normalize the columns of the product into limbs. */
+    t[1] = LANE_ADD(t[1], LANE_SHR(t[0], LANE_BITS)); t[0] = LANE_AND(t[0], m);
+    t[2] = LANE_ADD(t[2], LANE_SHR(t[1], LANE_BITS)); t[1] = LANE_AND(t[1], m);
+    t[3] = LANE_ADD(t[3], LANE_SHR(t[2], LANE_BITS)); t[2] = LANE_AND(t[2], m);
+    t[4] = LANE_ADD(t[4], LANE_SHR(t[3], LANE_BITS)); t[3] = LANE_AND(t[3], m);
+    t[5] = LANE_ADD(t[5], LANE_SHR(t[4], LANE_BITS)); t[4] = LANE_AND(t[4], m);
+    t[6] = LANE_ADD(t[6], LANE_SHR(t[5], LANE_BITS)); t[5] = LANE_AND(t[5], m);
+    t[7] = LANE_ADD(t[7], LANE_SHR(t[6], LANE_BITS)); t[6] = LANE_AND(t[6], m);
+    t[8] = LANE_ADD(t[8], LANE_SHR(t[7], LANE_BITS)); t[7] = LANE_AND(t[7], m);
+    t[9] = LANE_ADD(t[9], LANE_SHR(t[8], LANE_BITS)); t[8] = LANE_AND(t[8], m);
+
+    /* h = bits above the modulus. */
+    h[0] = LANE_AND(LANE_OR(LANE_SHR(t[4], LANE_TOP_BITS), LANE_SHL(t[5], 16)), m);
+    h[1] = LANE_AND(LANE_OR(LANE_SHR(t[5], LANE_TOP_BITS), LANE_SHL(t[6], 16)), m);
+    h[2] = LANE_AND(LANE_OR(LANE_SHR(t[6], LANE_TOP_BITS), LANE_SHL(t[7], 16)), m);
+    h[3] = LANE_AND(LANE_OR(LANE_SHR(t[7], LANE_TOP_BITS), LANE_SHL(t[8], 16)), m);
+    h[4] = LANE_AND(LANE_OR(LANE_SHR(t[8], LANE_TOP_BITS), LANE_SHL(t[9], 16)), m);
+    t[4] = LANE_AND(t[4], tm);
+
+    /* t = bits of the modulus + h * MOD_WORD */
+    t[0] = LANE_MUL(t[0], h[0], w);
+    t[1] = LANE_MUL(t[1], h[1], w);
+    t[2] = LANE_MUL(t[2], h[2], w);
+    t[3] = LANE_MUL(t[3], h[3], w);
+    t[4] = LANE_MUL(t[4], h[4], w);
+
+    t[1] = LANE_ADD(t[1], LANE_SHR(t[0], LANE_BITS)); t[0] = LANE_AND(t[0], m);
+    t[2] = LANE_ADD(t[2], LANE_SHR(t[1], LANE_BITS)); t[1] = LANE_AND(t[1], m);
+    t[3] = LANE_ADD(t[3], LANE_SHR(t[2], LANE_BITS)); t[2] = LANE_AND(t[2], m);
+    t[4] = LANE_ADD(t[4], LANE_SHR(t[3], LANE_BITS)); t[3] = LANE_AND(t[3], m);
+
+    /* Fold in the few bits that are again above the modulus. */
+    q = LANE_SHR(t[4], LANE_TOP_BITS); t[4] = LANE_AND(t[4], tm);
+    t[0] = LANE_MUL(t[0], q, w);
+    t[1] = LANE_ADD(t[1], LANE_SHR(t[0], LANE_BITS)); r[0] = LANE_AND(t[0], m);
+    t[2] = LANE_ADD(t[2], LANE_SHR(t[1], LANE_BITS)); r[1] = LANE_AND(t[1], m);
+    t[3] = LANE_ADD(t[3], LANE_SHR(t[2], LANE_BITS)); r[2] = LANE_AND(t[2], m);
+    t[4] = LANE_ADD(t[4], LANE_SHR(t[3], LANE_BITS)); r[3] = LANE_AND(t[3], m);
+    r[4] = t[4];
+}
+
+/**
+ * Multiply two lane numbers, a and b, modulo the prime and put result in r.
+ *
+ * @param [in] r  The result of the multiplication.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
+ */
+static void p128_lane_mod_mul(lane_t *r, lane_t *a, lane_t *b)
+{
+    lane_t t[10];
+
+    t[0] = LANE_ZERO();
+    t[1] = LANE_ZERO();
+    t[2] = LANE_ZERO();
+    t[3] = LANE_ZERO();
+    t[4] = LANE_ZERO();
+    t[5] = LANE_ZERO();
+    t[6] = LANE_ZERO();
+    t[7] = LANE_ZERO();
+    t[8] = LANE_ZERO();
+    t[9] = LANE_ZERO();
+
+    t[0] = LANE_MUL(t[0], a[0], b[0]);
+    t[1] = LANE_MUL(t[1], a[0], b[1]);
+    t[1] = LANE_MUL(t[1], a[1], b[0]);
+    t[2] = LANE_MUL(t[2], a[0], b[2]);
+    t[2] = LANE_MUL(t[2], a[1], b[1]);
+    t[2] = LANE_MUL(t[2], a[2], b[0]);
+    t[3] = LANE_MUL(t[3], a[0], b[3]);
+    t[3] = LANE_MUL(t[3], a[1], b[2]);
+    t[3] = LANE_MUL(t[3], a[2], b[1]);
+    t[3] = LANE_MUL(t[3], a[3], b[0]);
+    t[4] = LANE_MUL(t[4], a[0], b[4]);
+    t[4] = LANE_MUL(t[4], a[1], b[3]);
+    t[4] = LANE_MUL(t[4], a[2], b[2]);
+    t[4] = LANE_MUL(t[4], a[3], b[1]);
+    t[4] = LANE_MUL(t[4], a[4], b[0]);
+    t[5] = LANE_MUL(t[5], a[1], b[4]);
+    t[5] = LANE_MUL(t[5], a[2], b[3]);
+    t[5] = LANE_MUL(t[5], a[3], b[2]);
+    t[5] = LANE_MUL(t[5], a[4], b[1]);
+    t[6] = LANE_MUL(t[6], a[2], b[4]);
+    t[6] = LANE_MUL(t[6], a[3], b[3]);
+    t[6] = LANE_MUL(t[6], a[4], b[2]);
+    t[7] = LANE_MUL(t[7], a[3], b[4]);
+    t[7] = LANE_MUL(t[7], a[4], b[3]);
+    t[8] = LANE_MUL(t[8], a[4], b[4]);
+
+    p128_lane_mod_long(r, t);
+}
+
+/**
+ * Multiply two lane numbers, a and b, add c and reduce modulo the prime.
+ *
+ * @param [in] r  The result of the multiplication and addition.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
+ * @param [in] c  The lane number to add.
+ */
+static void p128_lane_mod_mul_add(lane_t *r, lane_t *a, lane_t *b,
+    lane_t *c)
+{
+    lane_t t[10];
+
+    t[0] = c[0];
+    t[1] = c[1];
+    t[2] = c[2];
+    t[3] = c[3];
+    t[4] = c[4];
+    t[5] = LANE_ZERO();
+    t[6] = LANE_ZERO();
+    t[7] = LANE_ZERO();
+    t[8] = LANE_ZERO();
+    t[9] = LANE_ZERO();
+
+    t[0] = LANE_MUL(t[0], a[0], b[0]);
+    t[1] = LANE_MUL(t[1], a[0], b[1]);
+    t[1] = LANE_MUL(t[1], a[1], b[0]);
+    t[2] = LANE_MUL(t[2], a[0], b[2]);
+    t[2] = LANE_MUL(t[2], a[1], b[1]);
+    t[2] = LANE_MUL(t[2], a[2], b[0]);
+    t[3] = LANE_MUL(t[3], a[0], b[3]);
+    t[3] = LANE_MUL(t[3], a[1], b[2]);
+    t[3] = LANE_MUL(t[3], a[2], b[1]);
+    t[3] = LANE_MUL(t[3], a[3], b[0]);
+    t[4] = LANE_MUL(t[4], a[0], b[4]);
+    t[4] = LANE_MUL(t[4], a[1], b[3]);
+    t[4] = LANE_MUL(t[4], a[2], b[2]);
+    t[4] = LANE_MUL(t[4], a[3], b[1]);
+    t[4] = LANE_MUL(t[4], a[4], b[0]);
+    t[5] = LANE_MUL(t[5], a[1], b[4]);
+    t[5] = LANE_MUL(t[5], a[2], b[3]);
+    t[5] = LANE_MUL(t[5], a[3], b[2]);
+    t[5] = LANE_MUL(t[5], a[4], b[1]);
+    t[6] = LANE_MUL(t[6], a[2], b[4]);
+    t[6] = LANE_MUL(t[6], a[3], b[3]);
+    t[6] = LANE_MUL(t[6], a[4], b[2]);
+    t[7] = LANE_MUL(t[7], a[3], b[4]);
+    t[7] = LANE_MUL(t[7], a[4], b[3]);
+    t[8] = LANE_MUL(t[8], a[4], b[4]);
+
+    p128_lane_mod_long(r, t);
+}
+
+/**
+ * Subtract lane number b from a (modulo prime) and put the result r.
+ * Twice the prime is added so that no limb goes negative.
+ *
+ * @param [in] r  The result of the subtraction.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
+ */
+static void p128_lane_mod_sub(lane_t *r, lane_t *a, lane_t *b)
+{
+    lane_t m = LANE_SET(LANE_MASK);
+    lane_t t[LANE_ELEMS];
+
+    t[0] = LANE_SUB(LANE_ADD(a[0], LANE_SET(0x3fffffce)), b[0]);
+    t[1] = LANE_SUB(LANE_ADD(a[1], LANE_SET(0x3ffffffe)), b[1]);
+    t[2] = LANE_SUB(LANE_ADD(a[2], LANE_SET(0x3ffffffe)), b[2]);
+    t[3] = LANE_SUB(LANE_ADD(a[3], LANE_SET(0x3ffffffe)), b[3]);
+    t[4] = LANE_SUB(LANE_ADD(a[4], LANE_SET(0x3ffe)), b[4]);
+    t[1] = LANE_ADD(t[1], LANE_SHR(t[0], LANE_BITS)); r[0] = LANE_AND(t[0], m);
+    t[2] = LANE_ADD(t[2], LANE_SHR(t[1], LANE_BITS)); r[1] = LANE_AND(t[1], m);
+    t[3] = LANE_ADD(t[3], LANE_SHR(t[2], LANE_BITS)); r[2] = LANE_AND(t[2], m);
+    t[4] = LANE_ADD(t[4], LANE_SHR(t[3], LANE_BITS)); r[3] = LANE_AND(t[3], m);
+    r[4] = t[4];
+}
+
+/**
+ * Calculate the denominators of the Lagrange basis polynomials, LANES at a
+ * time.
+ * d[i] = x[i] * (product of all x[j] - x[i] where i != j)
+ *
+ * @param [in] d      The array of denominators as number objects.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret.
+ * @param [in] x      The array of x values as number objects.
+ */
+static void p128_lane_denoms(uint64_t *d, uint16_t parts, uint64_t **x)
+{
+    uint16_t i, j, k;
+    lane_t xi[LANE_ELEMS], xj[LANE_ELEMS], t[LANE_ELEMS], dl[LANE_ELEMS];
+    lane_t idx;
+    uint64_t li[LANES];
+    uint64_t *xp[LANES], *dp[LANES];
+    uint64_t unused[LANES][NUM_ELEMS];
+
+    for (i=0; i<parts; i+=LANES)
+    {
+        /* Lanes past the last part calculate a result that is discarded. */
+        for (k=0; k<LANES; k++)
+        {
+            li[k] = i + k;
+            xp[k] = (i + k < parts) ? x[i + k] : x[i];
+            dp[k] = (i + k < parts) ? &d[(i + k) * NUM_ELEMS] : unused[k];
+        }
+        idx = LANE_LOAD(li);
+        p128_lane_from_num(xi, xp);
+
+        dl[0] = LANE_SET(1);
+        dl[1] = LANE_ZERO();
+        dl[2] = LANE_ZERO();
+        dl[3] = LANE_ZERO();
+        dl[4] = LANE_ZERO();
+        for (j=0; j<parts; j++)
+        {
+            p128_lane_set(xj, x[j]);
+            p128_lane_mod_sub(t, xj, xi);
+            /* x[j] - x[i] is zero when i == j - multiply by one instead. */
+            t[0] = LANE_ADD(t[0], LANE_EQ_ONE(idx, LANE_SET(j)));
+            p128_lane_mod_mul(dl, dl, t);
+        }
+        p128_lane_mod_mul(dl, dl, xi);
+
+        p128_lane_to_num(dp, dl);
+    }
+}
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the secret in bytes.
+ * @param [out] num  The new number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+
+    len = len;
+
+    *num = share_malloc(NUM_ELEMS*sizeof(uint64_t));
+    if (*num == NULL)
+        err = ALLOC;
+
+    return err;
+}
+
+/**
+ * Free the dynamic memory associated with the number object.
+ *
+ * @param [in] num  The number object.
+ */
+void share_p128_avx2_num_free(void *num)
+{
+    if (num != NULL) share_free(num);
+}
+
+/**
+ * Initialize a number object in memory provided by the caller.
+ *
+ * @param [in]  len   The length of the secret in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_num_init(uint16_t len, void *num, size_t *size)
+{
+    len = len;
+
+    if (num != NULL)
+        memset(num, 0, NUM_ELEMS*sizeof(uint64_t));
+    *size = NUM_ELEMS*sizeof(uint64_t);
+
+    return NONE;
+}
+
+/**
+ * Load 8 bytes of big-endian data as a word.
+ * On little-endian CPUs this is a single byte swapping load.
+ *
+ * @param [in] d  The data to load.
+ * @return  The word.
+ */
+static uint64_t p128_load_be64(const uint8_t *d)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t w;
+
+    memcpy(&w, d, sizeof(w));
+    return __builtin_bswap64(w);
+#else
+    return ((uint64_t)d[0] << 56) | ((uint64_t)d[1] << 48) |
+           ((uint64_t)d[2] << 40) | ((uint64_t)d[3] << 32) |
+           ((uint64_t)d[4] << 24) | ((uint64_t)d[5] << 16) |
+           ((uint64_t)d[6] <<  8) | ((uint64_t)d[7]      );
+#endif
+}
+
+/**
+ * Store a word as 8 bytes of big-endian data.
+ * On little-endian CPUs this is a single byte swapping store.
+ *
+ * @param [in] d  The data to store into.
+ * @param [in] w  The word to store.
+ */
+static void p128_store_be64(uint8_t *d, uint64_t w)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    w = __builtin_bswap64(w);
+    memcpy(d, &w, sizeof(w));
+#else
+    d[0] = w >> 56; d[1] = w >> 48; d[2] = w >> 40; d[3] = w >> 32;
+    d[4] = w >> 24; d[5] = w >> 16; d[6] = w >>  8; d[7] = w;
+#endif
+}
+
+/**
+ * Decode exactly NUM_BYTES of big-endian data into a number.
+ *
+ * @param [in] n  The number.
+ * @param [in] d  The data to decode.
+ */
+static void p128_from_bin(uint64_t *n, const uint8_t *d)
+{
+    n[0] = p128_load_be64(d + 9);
+    n[1] = p128_load_be64(d + 1);
+    n[2] = d[0];
+}
+
+/**
+ * Encode a number into exactly NUM_BYTES of big-endian data.
+ *
+ * @param [in] n  The number.
+ * @param [in] d  The data to encode into.
+ */
+static void p128_to_bin(uint64_t *n, uint8_t *d)
+{
+    p128_store_be64(d + 9, n[0]);
+    p128_store_be64(d + 1, n[1]);
+    d[0] = n[2];
+}
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num)
+{
+    SHARE_ERR err = NONE;
+    uint8_t b[NUM_BYTES];
+
+    if (len > NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Shorter data is padded on the left with zeros. */
+    if (len < NUM_BYTES)
+    {
+        memset(b, 0, NUM_BYTES - len);
+        memcpy(b + NUM_BYTES - len, data, len);
+        data = b;
+    }
+    p128_from_bin(num, data);
+
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    if (len != NUM_BYTES)
+    {
+        for (i=0; (err == NONE) && (i<cnt); i++)
+            err = share_p128_avx2_num_from_bin(data + i * step, len, num[i]);
+        goto end;
+    }
+
+    for (i=0; i<cnt; i++)
+        p128_from_bin(num[i], data + i * step);
+
+end:
+    return err;
+}
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Longer data is padded on the left with zeros. */
+    memset(data, 0, len - NUM_BYTES);
+    p128_to_bin(num, data + len - NUM_BYTES);
+
+end:
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    data += len - NUM_BYTES;
+    for (i=0; i<cnt; i++)
+    {
+        memset(data + i * step - (len - NUM_BYTES), 0, len - NUM_BYTES);
+        p128_to_bin(num[i], data + i * step);
+    }
+
+end:
+    return err;
+}
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p128_avx2_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    SHARE_ERR err = NONE;
+    int16_t i;
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+        p128_mod_mul_add(yd, yd, xd, ad[i]);
+    p128_mod(yd, yd);
+
+    return err;
+}
+
+/**
+ * Calculate the y values of LANES splits at once.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The array of LANES x values as number objects.
+ * @param [in] y      The array of LANES y values as number objects.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y)
+{
+    SHARE_ERR err = NONE;
+    int16_t i;
+    lane_t xl[LANE_ELEMS], yl[LANE_ELEMS], al[LANE_ELEMS];
+    uint64_t **ad = (uint64_t **)a;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    p128_lane_from_num(xl, (uint64_t **)x);
+    p128_lane_set(yl, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+    {
+        p128_lane_set(al, ad[i]);
+        p128_lane_mod_mul_add(yl, yl, xl, al);
+    }
+    p128_lane_to_num((uint64_t **)y, yl);
+
+    return err;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The denominators are inverted together with one inversion.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint16_t i;
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+    uint64_t *cr = scratch;
+    uint64_t *dr = cr + NUM_ELEMS * parts;
+    uint64_t *c, *d;
+
+    prime = prime;
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    p128_copy(np, xd[0]);
+    for (i=1; i<parts; i++)
+        p128_mod_mul(np, np, xd[i]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(dr, parts, xd);
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*NUM_ELEMS];
+        d = &dr[i*NUM_ELEMS];
+        if (i == 0)
+            p128_copy(c, d);
+        else
+            p128_mod_mul(c, c - NUM_ELEMS, d);
+    }
+    /* inv = 1 / c[parts-1] */
+    p128_mod_inv(inv, &cr[(parts-1)*NUM_ELEMS]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    memset(sum, 0, sizeof(sum));
+    for (i=parts-1; i>0; i--)
+    {
+        p128_mod_mul(t, inv, &cr[(i-1)*NUM_ELEMS]);
+        p128_mod_mul(inv, inv, &dr[i*NUM_ELEMS]);
+        p128_mod_mul_add(sum, t, yd[i], sum);
+    }
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint16_t i;
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+    uint64_t *cr = scratch;
+    uint64_t *dr = cr + NUM_ELEMS * parts;
+    uint64_t *c, *d;
+
+    prime = prime;
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    p128_copy(np, xd[0]);
+    for (i=1; i<parts; i++)
+        p128_mod_mul(np, np, xd[i]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(dr, parts, xd);
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*NUM_ELEMS];
+        d = &dr[i*NUM_ELEMS];
+        if (i == 0)
+            p128_copy(c, d);
+        else
+            p128_mod_mul(c, c - NUM_ELEMS, d);
+    }
+    /* inv = 1 / c[parts-1] */
+    p128_mod_inv_vt(inv, &cr[(parts-1)*NUM_ELEMS]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    memset(sum, 0, sizeof(sum));
+    for (i=parts-1; i>0; i--)
+    {
+        p128_mod_mul(t, inv, &cr[(i-1)*NUM_ELEMS]);
+        p128_mod_mul(inv, inv, &dr[i*NUM_ELEMS]);
+        p128_mod_mul_add(sum, t, yd[i], sum);
+    }
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the y value of a split when 2 parts are required.
+ * y = x^0.a[0] + x^1.a[1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always 2.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_2(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = a[1].x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[1]);
+    p128_mod_mul_add(yd, yd, xd, ad[0]);
+    p128_mod(yd, yd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 2 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 2.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_2(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[2][NUM_ELEMS], d[2][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 2, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    /* inv = 1 / c[1] */
+    p128_mod_inv(inv, c[1]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul(sum, t, yd[1]);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 2 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 2.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt_2(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[2][NUM_ELEMS], d[2][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 2, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    /* inv = 1 / c[1] */
+    p128_mod_inv_vt(inv, c[1]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul(sum, t, yd[1]);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the y value of a split when 3 parts are required.
+ * y = x^0.a[0] + x^1.a[1] + x^2.a[2]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always 3.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_3(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = (a[2].x + a[1]).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[2]);
+    p128_mod_mul_add(yd, yd, xd, ad[1]);
+    p128_mod_mul_add(yd, yd, xd, ad[0]);
+    p128_mod(yd, yd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 3 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 3.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_3(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[3][NUM_ELEMS], d[3][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * x[2] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 3, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    /* inv = 1 / c[2] */
+    p128_mod_inv(inv, c[2]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + y[2] / d[2]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul(sum, t, yd[2]);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 3 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 3.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt_3(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[3][NUM_ELEMS], d[3][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * x[2] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 3, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    /* inv = 1 / c[2] */
+    p128_mod_inv_vt(inv, c[2]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + y[2] / d[2]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul(sum, t, yd[2]);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the y value of a split when 5 parts are required.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^4.a[4]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always 5.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_5(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = (..(a[4].x + a[3]).x + ..).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[4]);
+    p128_mod_mul_add(yd, yd, xd, ad[3]);
+    p128_mod_mul_add(yd, yd, xd, ad[2]);
+    p128_mod_mul_add(yd, yd, xd, ad[1]);
+    p128_mod_mul_add(yd, yd, xd, ad[0]);
+    p128_mod(yd, yd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 5 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 5.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_5(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[5][NUM_ELEMS], d[5][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[4] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 5, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    /* inv = 1 / c[4] */
+    p128_mod_inv(inv, c[4]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[4] / d[4]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul(sum, t, yd[4]);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 5 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 5.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt_5(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[5][NUM_ELEMS], d[5][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[4] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 5, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    /* inv = 1 / c[4] */
+    p128_mod_inv_vt(inv, c[4]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[4] / d[4]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul(sum, t, yd[4]);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the y value of a split when 8 parts are required.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^7.a[7]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always 8.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_8(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = (..(a[7].x + a[6]).x + ..).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[7]);
+    p128_mod_mul_add(yd, yd, xd, ad[6]);
+    p128_mod_mul_add(yd, yd, xd, ad[5]);
+    p128_mod_mul_add(yd, yd, xd, ad[4]);
+    p128_mod_mul_add(yd, yd, xd, ad[3]);
+    p128_mod_mul_add(yd, yd, xd, ad[2]);
+    p128_mod_mul_add(yd, yd, xd, ad[1]);
+    p128_mod_mul_add(yd, yd, xd, ad[0]);
+    p128_mod(yd, yd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 8 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 8.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_8(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[8][NUM_ELEMS], d[8][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[7] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+    p128_mod_mul(np, np, xd[5]);
+    p128_mod_mul(np, np, xd[6]);
+    p128_mod_mul(np, np, xd[7]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 8, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    p128_mod_mul(c[5], c[4], d[5]);
+    p128_mod_mul(c[6], c[5], d[6]);
+    p128_mod_mul(c[7], c[6], d[7]);
+    /* inv = 1 / c[7] */
+    p128_mod_inv(inv, c[7]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[7] / d[7]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[6]);
+    p128_mod_mul(inv, inv, d[7]);
+    p128_mod_mul(sum, t, yd[7]);
+    p128_mod_mul(t, inv, c[5]);
+    p128_mod_mul(inv, inv, d[6]);
+    p128_mod_mul_add(sum, t, yd[6], sum);
+    p128_mod_mul(t, inv, c[4]);
+    p128_mod_mul(inv, inv, d[5]);
+    p128_mod_mul_add(sum, t, yd[5], sum);
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul_add(sum, t, yd[4], sum);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 8 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 8.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt_8(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[8][NUM_ELEMS], d[8][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[7] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+    p128_mod_mul(np, np, xd[5]);
+    p128_mod_mul(np, np, xd[6]);
+    p128_mod_mul(np, np, xd[7]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 8, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    p128_mod_mul(c[5], c[4], d[5]);
+    p128_mod_mul(c[6], c[5], d[6]);
+    p128_mod_mul(c[7], c[6], d[7]);
+    /* inv = 1 / c[7] */
+    p128_mod_inv_vt(inv, c[7]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[7] / d[7]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[6]);
+    p128_mod_mul(inv, inv, d[7]);
+    p128_mod_mul(sum, t, yd[7]);
+    p128_mod_mul(t, inv, c[5]);
+    p128_mod_mul(inv, inv, d[6]);
+    p128_mod_mul_add(sum, t, yd[6], sum);
+    p128_mod_mul(t, inv, c[4]);
+    p128_mod_mul(inv, inv, d[5]);
+    p128_mod_mul_add(sum, t, yd[5], sum);
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul_add(sum, t, yd[4], sum);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the y value of a split when 16 parts are required.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^15.a[15]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always 16.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_split_16(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = (..(a[15].x + a[14]).x + ..).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p128_copy(yd, ad[15]);
+    p128_mod_mul_add(yd, yd, xd, ad[14]);
+    p128_mod_mul_add(yd, yd, xd, ad[13]);
+    p128_mod_mul_add(yd, yd, xd, ad[12]);
+    p128_mod_mul_add(yd, yd, xd, ad[11]);
+    p128_mod_mul_add(yd, yd, xd, ad[10]);
+    p128_mod_mul_add(yd, yd, xd, ad[9]);
+    p128_mod_mul_add(yd, yd, xd, ad[8]);
+    p128_mod_mul_add(yd, yd, xd, ad[7]);
+    p128_mod_mul_add(yd, yd, xd, ad[6]);
+    p128_mod_mul_add(yd, yd, xd, ad[5]);
+    p128_mod_mul_add(yd, yd, xd, ad[4]);
+    p128_mod_mul_add(yd, yd, xd, ad[3]);
+    p128_mod_mul_add(yd, yd, xd, ad[2]);
+    p128_mod_mul_add(yd, yd, xd, ad[1]);
+    p128_mod_mul_add(yd, yd, xd, ad[0]);
+    p128_mod(yd, yd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 16 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 16.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_16(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[16][NUM_ELEMS], d[16][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[15] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+    p128_mod_mul(np, np, xd[5]);
+    p128_mod_mul(np, np, xd[6]);
+    p128_mod_mul(np, np, xd[7]);
+    p128_mod_mul(np, np, xd[8]);
+    p128_mod_mul(np, np, xd[9]);
+    p128_mod_mul(np, np, xd[10]);
+    p128_mod_mul(np, np, xd[11]);
+    p128_mod_mul(np, np, xd[12]);
+    p128_mod_mul(np, np, xd[13]);
+    p128_mod_mul(np, np, xd[14]);
+    p128_mod_mul(np, np, xd[15]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 16, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    p128_mod_mul(c[5], c[4], d[5]);
+    p128_mod_mul(c[6], c[5], d[6]);
+    p128_mod_mul(c[7], c[6], d[7]);
+    p128_mod_mul(c[8], c[7], d[8]);
+    p128_mod_mul(c[9], c[8], d[9]);
+    p128_mod_mul(c[10], c[9], d[10]);
+    p128_mod_mul(c[11], c[10], d[11]);
+    p128_mod_mul(c[12], c[11], d[12]);
+    p128_mod_mul(c[13], c[12], d[13]);
+    p128_mod_mul(c[14], c[13], d[14]);
+    p128_mod_mul(c[15], c[14], d[15]);
+    /* inv = 1 / c[15] */
+    p128_mod_inv(inv, c[15]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[15] / d[15]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[14]);
+    p128_mod_mul(inv, inv, d[15]);
+    p128_mod_mul(sum, t, yd[15]);
+    p128_mod_mul(t, inv, c[13]);
+    p128_mod_mul(inv, inv, d[14]);
+    p128_mod_mul_add(sum, t, yd[14], sum);
+    p128_mod_mul(t, inv, c[12]);
+    p128_mod_mul(inv, inv, d[13]);
+    p128_mod_mul_add(sum, t, yd[13], sum);
+    p128_mod_mul(t, inv, c[11]);
+    p128_mod_mul(inv, inv, d[12]);
+    p128_mod_mul_add(sum, t, yd[12], sum);
+    p128_mod_mul(t, inv, c[10]);
+    p128_mod_mul(inv, inv, d[11]);
+    p128_mod_mul_add(sum, t, yd[11], sum);
+    p128_mod_mul(t, inv, c[9]);
+    p128_mod_mul(inv, inv, d[10]);
+    p128_mod_mul_add(sum, t, yd[10], sum);
+    p128_mod_mul(t, inv, c[8]);
+    p128_mod_mul(inv, inv, d[9]);
+    p128_mod_mul_add(sum, t, yd[9], sum);
+    p128_mod_mul(t, inv, c[7]);
+    p128_mod_mul(inv, inv, d[8]);
+    p128_mod_mul_add(sum, t, yd[8], sum);
+    p128_mod_mul(t, inv, c[6]);
+    p128_mod_mul(inv, inv, d[7]);
+    p128_mod_mul_add(sum, t, yd[7], sum);
+    p128_mod_mul(t, inv, c[5]);
+    p128_mod_mul(inv, inv, d[6]);
+    p128_mod_mul_add(sum, t, yd[6], sum);
+    p128_mod_mul(t, inv, c[4]);
+    p128_mod_mul(inv, inv, d[5]);
+    p128_mod_mul_add(sum, t, yd[5], sum);
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul_add(sum, t, yd[4], sum);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * 16 parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.
+ * The denominators are calculated LANES at a time.
+ * The denominators are inverted together with one inversion.
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always 16.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_join_vt_16(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[16][NUM_ELEMS], d[16][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = x[0] * x[1] * .. * x[15] */
+    p128_copy(np, xd[0]);
+    p128_mod_mul(np, np, xd[1]);
+    p128_mod_mul(np, np, xd[2]);
+    p128_mod_mul(np, np, xd[3]);
+    p128_mod_mul(np, np, xd[4]);
+    p128_mod_mul(np, np, xd[5]);
+    p128_mod_mul(np, np, xd[6]);
+    p128_mod_mul(np, np, xd[7]);
+    p128_mod_mul(np, np, xd[8]);
+    p128_mod_mul(np, np, xd[9]);
+    p128_mod_mul(np, np, xd[10]);
+    p128_mod_mul(np, np, xd[11]);
+    p128_mod_mul(np, np, xd[12]);
+    p128_mod_mul(np, np, xd[13]);
+    p128_mod_mul(np, np, xd[14]);
+    p128_mod_mul(np, np, xd[15]);
+
+    /* Calculate all the denominators - LANES at a time. */
+    p128_lane_denoms(d[0], 16, xd);
+
+    /* c[i] = d[0] * .. * d[i] */
+    p128_copy(c[0], d[0]);
+    p128_mod_mul(c[1], c[0], d[1]);
+    p128_mod_mul(c[2], c[1], d[2]);
+    p128_mod_mul(c[3], c[2], d[3]);
+    p128_mod_mul(c[4], c[3], d[4]);
+    p128_mod_mul(c[5], c[4], d[5]);
+    p128_mod_mul(c[6], c[5], d[6]);
+    p128_mod_mul(c[7], c[6], d[7]);
+    p128_mod_mul(c[8], c[7], d[8]);
+    p128_mod_mul(c[9], c[8], d[9]);
+    p128_mod_mul(c[10], c[9], d[10]);
+    p128_mod_mul(c[11], c[10], d[11]);
+    p128_mod_mul(c[12], c[11], d[12]);
+    p128_mod_mul(c[13], c[12], d[13]);
+    p128_mod_mul(c[14], c[13], d[14]);
+    p128_mod_mul(c[15], c[14], d[15]);
+    /* inv = 1 / c[15] */
+    p128_mod_inv_vt(inv, c[15]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[15] / d[15]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    p128_mod_mul(t, inv, c[14]);
+    p128_mod_mul(inv, inv, d[15]);
+    p128_mod_mul(sum, t, yd[15]);
+    p128_mod_mul(t, inv, c[13]);
+    p128_mod_mul(inv, inv, d[14]);
+    p128_mod_mul_add(sum, t, yd[14], sum);
+    p128_mod_mul(t, inv, c[12]);
+    p128_mod_mul(inv, inv, d[13]);
+    p128_mod_mul_add(sum, t, yd[13], sum);
+    p128_mod_mul(t, inv, c[11]);
+    p128_mod_mul(inv, inv, d[12]);
+    p128_mod_mul_add(sum, t, yd[12], sum);
+    p128_mod_mul(t, inv, c[10]);
+    p128_mod_mul(inv, inv, d[11]);
+    p128_mod_mul_add(sum, t, yd[11], sum);
+    p128_mod_mul(t, inv, c[9]);
+    p128_mod_mul(inv, inv, d[10]);
+    p128_mod_mul_add(sum, t, yd[10], sum);
+    p128_mod_mul(t, inv, c[8]);
+    p128_mod_mul(inv, inv, d[9]);
+    p128_mod_mul_add(sum, t, yd[9], sum);
+    p128_mod_mul(t, inv, c[7]);
+    p128_mod_mul(inv, inv, d[8]);
+    p128_mod_mul_add(sum, t, yd[8], sum);
+    p128_mod_mul(t, inv, c[6]);
+    p128_mod_mul(inv, inv, d[7]);
+    p128_mod_mul_add(sum, t, yd[7], sum);
+    p128_mod_mul(t, inv, c[5]);
+    p128_mod_mul(inv, inv, d[6]);
+    p128_mod_mul_add(sum, t, yd[6], sum);
+    p128_mod_mul(t, inv, c[4]);
+    p128_mod_mul(inv, inv, d[5]);
+    p128_mod_mul_add(sum, t, yd[5], sum);
+    p128_mod_mul(t, inv, c[3]);
+    p128_mod_mul(inv, inv, d[4]);
+    p128_mod_mul_add(sum, t, yd[4], sum);
+    p128_mod_mul(t, inv, c[2]);
+    p128_mod_mul(inv, inv, d[3]);
+    p128_mod_mul_add(sum, t, yd[3], sum);
+    p128_mod_mul(t, inv, c[1]);
+    p128_mod_mul(inv, inv, d[2]);
+    p128_mod_mul_add(sum, t, yd[2], sum);
+    p128_mod_mul(t, inv, c[0]);
+    p128_mod_mul(inv, inv, d[1]);
+    p128_mod_mul_add(sum, t, yd[1], sum);
+    p128_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p128_mod_mul(sd, np, sum);
+    p128_mod(sd, sd);
+
+    return NONE;
+}
+
+/**
+ * Calculate the inverse of a number modulo the prime.
+ *
+ * @param [in] prime  The prime as a number object.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_num_inv(void *prime, void *a, void *r)
+{
+    prime = prime;
+
+    p128_mod_inv(r, a);
+    p128_mod(r, r);
+
+    return NONE;
+}
+
+/**
+ * Get the size of the scratch space that join needs.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  NONE.
+ */
+SHARE_ERR share_p128_avx2_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    prime = prime;
+
+    *size = 2 * NUM_ELEMS * parts * sizeof(uint64_t);
+
+    return NONE;
+}
+
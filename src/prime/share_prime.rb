@@ -21,18 +21,109 @@
 
 class SharePrime
 
-  def initialize(bits, word)
+  # The vector instruction sets that multi-lane kernels are generated for.
+  #   lanes - the number of numbers operated on at once.
+  #   radix - the number of bits in each limb of a lane number.
+  #   hi    - whether the multiply instruction returns the high half of the
+  #           product separately.
+  LANE_ISA = {
+    "ifma" => { :lanes => 8, :radix => 52, :hi => true, :type => "__m512i" },
+    "avx2" => { :lanes => 4, :radix => 29, :hi => false, :type => "__m256i" },
+  }
+
+  # The scalar kernels with limbs of less than 64 bits and the number of bits
+  # in each limb. The modulus must be a whole number of limbs. The spare bits
+  # in each word let products be summed without carries.
+  RADIX = {
+    "r51" => 51,
+  }
+
+  # The numbers of parts that split and join are specialized for.
+  SPEC_PARTS = [ 2, 3, 5, 8, 16 ]
+
+  # The registers that hold columns of the product in the BMI2 and ADX
+  # kernels and their 32-bit names.
+  ADX_REGS = [ "rcx", "r10", "r11", "rbx", "r12", "r13", "r14", "r15" ]
+  ADX_REG32 = { "rcx" => "ecx", "r10" => "r10d", "r11" => "r11d",
+                "rbx" => "ebx", "r12" => "r12d", "r13" => "r13d",
+                "r14" => "r14d", "r15" => "r15d" }
+
+  # The kernel variants that can be chosen and the default of each.
+  #   mul  - ps: product scanning, os: operand scanning.
+  #   sqr  - ps: dedicated squaring, mul: multiply the number by itself.
+  #   word - shift: multiply by the prime's last word with shifts and adds,
+  #          mul: multiply by the prime's last word with a multiply.
+  TUNE_VARIANTS = {
+    "mul" => [ "ps", "os" ],
+    "sqr" => [ "ps", "mul" ],
+    "word" => [ "shift", "mul" ],
+  }
+
+  # The kernel variants of the C implementations chosen by the autotuner.
+  TUNE_FILE = File.dirname(__FILE__)+'/../share_tune.h'
+
+  def initialize(bits, word, mode, tune = {})
       @bits = bits
+      @mode = mode
+      @tune = {
+        "mul" => "ps",
+        "sqr" => "ps",
+        "word" => (bits <= 128) ? "shift" : "mul"
+      }
+      # Only the C implementations are tuned.
+      if mode == nil
+        @tune.merge!(read_tune())
+        @tune.merge!(tune)
+      end
+      @tune.each do |k, v|
+        if TUNE_VARIANTS[k] == nil or not TUNE_VARIANTS[k].include?(v)
+          raise "Unknown kernel variant: #{k}=#{v}"
+        end
+      end
+      @fn = (mode == nil) ? "p#{bits}" : "p#{bits}_#{mode}"
       @mod_bits = bits + 1
       @word = word
-      @elems = (@mod_bits + 63) / 64
+      @nr = RADIX[mode] || 64
+      if @nr != 64 and @mod_bits % @nr != 0
+        raise "The prime is not a whole number of #{@nr}-bit limbs"
+      end
+      @elems = (@mod_bits + @nr - 1) / @nr
       @bytes = (@mod_bits + 7) / 8
       @last = @elems-1
+      # The last of the 64-bit words that hold the encoding.
+      @wlast = (@bytes + 7) / 8 - 1
       @shift = @mod_bits & 63
       @mask = "0x#{((1 << @shift) - 1).to_s(16)}"
       @shift_l = 64 - @shift
       @prime = (1 << @mod_bits) - @word
       @hi_bits = @mod_bits & 63
+      @inv_elems = @mod_bits / 62 + 1
+      @lane = LANE_ISA[mode]
+      if @lane != nil
+        # Need at least 3 bits of headroom above the modulus in the top limb.
+        @lr = @lane[:radix]
+        @ln = (@mod_bits + 3 + @lr - 1) / @lr
+        @ls = @mod_bits - @lr * (@ln - 1)
+        @lmask = "0x#{((1 << @lr) - 1).to_s(16)}"
+        @ltmask = "0x#{((1 << @ls) - 1).to_s(16)}"
+      end
+      # A window of columns and the operand pointers must fit in registers.
+      if mode == "adx" and @elems > 6
+        raise "Too many words in the prime for the BMI2 and ADX kernels"
+      end
+  end
+
+  # Read the kernel variants chosen for this prime from the tune file.
+  # The variants are listed in the order: mul, sqr, word.
+  def read_tune()
+    tune = {}
+    return tune if not File.exist?(TUNE_FILE)
+    File.readlines(TUNE_FILE).each do |l|
+      if l =~ /^#define SHARE_P#{@bits}_TUNE\s+"([^"]*)"/
+        tune = Hash[[ "mul", "sqr", "word" ].zip($1.split(","))]
+      end
+    end
+    tune
   end
 
   def write_header()
@@ -49,6 +140,16 @@ class SharePrime
 
 #define U128(w)		((__uint128_t)w)
 EOF
+    if @nr != 64
+      puts <<EOF
+
+/** The number of bits in a limb of a number. */
+#define NUM_BITS	#{@nr}
+/** The mask for a limb of a number. */
+#define NUM_MASK	0x#{((1 << @nr) - 1).to_s(16)}
+EOF
+    end
+    write_lane_header() if @lane != nil
   end
 
   def write_copy()
@@ -93,26 +194,9 @@ EOF
   end
 
   def write_mod_small()
-    puts <<EOF
-/**
- * Multiply by prime's (mod's) last word.
- *
- * @param [in] a  The number to multiply.
- * @return  The multiplicative result.
- */
-#define MUL_MOD_WORD(a) \\
-EOF
-    if @bits <= 128
-      w = @word
-      h = w.to_s(2).length
-      print "    ("
-      h.downto(1) do |i|
-        print "((a) << #{i}) + " if w & (1 << i) != 0
-      end
-      puts "(a))"
-    else
-      puts "    ((a) * MOD_WORD)"
-    end
+    write_mul_mod_word()
+    # Only needed by subtraction and the reduction of one bit top words.
+    return if @lane != nil and @hi_bits != 1
 
     puts <<EOF
 
@@ -139,7 +223,31 @@ EOF
 EOF
   end
 
+  def write_mul_mod_word()
+    puts <<EOF
+/**
+ * Multiply by prime's (mod's) last word.
+ *
+ * @param [in] a  The number to multiply.
+ * @return  The multiplicative result.
+ */
+#define MUL_MOD_WORD(a) \\
+EOF
+    if @tune["word"] == "shift"
+      w = @word
+      h = w.to_s(2).length
+      print "    ("
+      h.downto(1) do |i|
+        print "((a) << #{i}) + " if w & (1 << i) != 0
+      end
+      puts "(a))"
+    else
+      puts "    ((a) * MOD_WORD)"
+    end
+  end
+
   def write_mod_long()
+    return write_mod_long_word() if @elems == 1
 puts <<EOF
 
 /**
@@ -172,56 +280,50 @@ EOF
 EOF
   end
 
-  def write_mod_long_1()
+  def write_mod_long_word()
 puts <<EOF
 
 /**
  * Perform modulo operation on a product result in 128-bit elements.
+ * The prime is one word: the product is reduced in a 128-bit register.
  *
  * @param [in] r  The number reduce number.
  * @param [in] a  The product result in 128-bit elements.
  */
 static void p#{@bits}_mod_long(uint64_t *r, __uint128_t *a)
 {
-    __uint128_t t;
-
-EOF
-    0.upto(@last-1) do |i|
-      puts "    t = (a[#{@last+i}] >> 1) + ((uint64_t)a[#{@last+i+1}] << 63); a[#{i}] += MUL_MOD_WORD(t);"
-    end
-    puts
-    0.upto(@last-2) do |i|
-        puts "    r[#{i}] = a[#{i}]; a[#{i+1}] += a[#{i}] >> 64;"
-    end
-    puts "    r[#{@last-1}] = a[#{@last-1}];"
-    puts "    r[#{@last}] = (a[#{@last}] & 1) + (a[#{@last-1}] >> 64);"
-    puts <<EOF
+    __uint128_t t = a[0] + (a[1] << 64);
+    uint64_t l;
 
-    p#{@bits}_mod_small(r, r);
+    l = ((uint64_t)t & #{@mask}) + MUL_MOD_WORD((uint64_t)(t >> #{@shift}));
+    r[0] = (l & #{@mask}) + MUL_MOD_WORD(l >> #{@shift});
 }
 EOF
   end
 
-  def write_mod_add()
-    puts <<EOF
+  def write_mod_long_1()
+puts <<EOF
 
 /**
- * Add two numbers, a and b, (modulo prime) and put the result in a third, r.
+ * Perform modulo operation on a product result in 128-bit elements.
  *
- * @param [in] r  The result of the addition.
- * @param [in] a  The first operand.
- * @param [in] b  The second operand.
+ * @param [in] r  The number reduce number.
+ * @param [in] a  The product result in 128-bit elements.
  */
-static void p#{@bits}_mod_add(uint64_t *r, uint64_t *a, uint64_t *b)
+static void p#{@bits}_mod_long(uint64_t *r, __uint128_t *a)
 {
-    __int128_t t;
+    __uint128_t t;
 
 EOF
-    0.upto(@last) do |i|
-      op = (i != 0) ? "+" : " "
-      shift_t = (i != @last) ? " t >>= 64;" : ""
-      puts "    t #{op}= a[#{i}]; t += b[#{i}]; r[#{i}] = t;#{shift_t}"
+    0.upto(@last-1) do |i|
+      puts "    t = (a[#{@last+i}] >> 1) + ((uint64_t)a[#{@last+i+1}] << 63); a[#{i}] += MUL_MOD_WORD(t);"
+    end
+    puts
+    0.upto(@last-2) do |i|
+        puts "    r[#{i}] = a[#{i}]; a[#{i+1}] += a[#{i}] >> 64;"
     end
+    puts "    r[#{@last-1}] = a[#{@last-1}];"
+    puts "    r[#{@last}] = (a[#{@last}] & 1) + (a[#{@last-1}] >> 64);"
     puts <<EOF
 
     p#{@bits}_mod_small(r, r);
@@ -262,6 +364,24 @@ EOF
   end
 
   def write_mod_sqr()
+    if @tune["sqr"] == "mul"
+      puts <<EOF
+
+/**
+ * Square the number, a, modulo the prime and put in result in r.
+ * The number is multiplied by itself.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number object to square.
+ */
+static void p#{@bits}_mod_sqr(uint64_t *r, uint64_t *a)
+{
+    p#{@bits}_mod_mul(r, a, a);
+}
+EOF
+      write_mod_sqr_n()
+      return
+    end
     if @hi_bits == 1
       p64 = "\n    uint64_t p64;"
       t_elems = @elems * 2 - 1;
@@ -319,6 +439,12 @@ EOF
 
     p#{@bits}_mod_long(r, t);
 }
+EOF
+    write_mod_sqr_n()
+  end
+
+  def write_mod_sqr_n()
+    puts <<EOF
 
 /**
  * Square the number, a, modulo the prime n times and put in result in r.
@@ -338,15 +464,22 @@ static void p#{@bits}_mod_sqr_n(uint64_t *r, uint64_t *a, uint16_t n)
 EOF
   end
 
-  def write_mod_mul()
-    if @hi_bits == 1
-      p64 = "\n    uint64_t p64;"
-      t_elems = @elems * 2 - 1;
+  def write_mod_mul_doc(add)
+    if add
+      puts <<EOF
+
+/**
+ * Multiply two numbers, a and b, add c and reduce modulo the prime and put
+ * result in r. The result is not fully reduced.
+ *
+ * @param [in] r  The result of the multiplication and addition.
+ * @param [in] a  The first operand number object.
+ * @param [in] b  The second operand number object.
+ * @param [in] c  The number object to add.
+ */
+EOF
     else
-      p64 = ""
-      t_elems = @elems * 2;
-    end
-    puts <<EOF
+      puts <<EOF
 
 /**
  * Multiply two numbers, a and b, modulo the prime amd put in result in r.
@@ -355,40 +488,72 @@ EOF
  * @param [in] a  The first operand number object.
  * @param [in] b  The first operand number object.
  */
-static void p#{@bits}_mod_mul(uint64_t *r, uint64_t *a, uint64_t *b)
+EOF
+    end
+  end
+
+  def write_mod_mul(add)
+    if @hi_bits == 1
+      p64 = "\n    uint64_t p64;"
+      t_elems = @elems * 2 - 1;
+    else
+      p64 = ""
+      t_elems = @elems * 2;
+    end
+    write_mod_mul_doc(add)
+    if add
+      puts "static void p#{@bits}_mod_mul_add(uint64_t *r, uint64_t *a, uint64_t *b,"
+      puts "    uint64_t *c)"
+    else
+      puts "static void p#{@bits}_mod_mul(uint64_t *r, uint64_t *a, uint64_t *b)"
+    end
+    puts <<EOF
 {#{p64}
     __uint128_t p128;
     __uint128_t t[#{t_elems}];
 
 EOF
     print "   "
-    0.upto(t_elems-1) { |i| print " t[#{i}] = 0;" }; puts
+    0.upto(t_elems-1) do |i|
+      print (add and i <= @last) ? " t[#{i}] = c[#{i}];" : " t[#{i}] = 0;"
+    end
     puts
-    0.upto(@last*2) do |i|
-      0.upto(@last) do |j|
-        k = i - j
-        next if k < 0 || k > @last
-        if @hi_bits == 1
-          if j == @last and k == @last
-            puts "    p64 = a[#{j}] & b[#{k}];"
-          elsif (j == @last or k == @last) and @mod_bits >= 256
-            puts "    p64 = a[#{j}] * b[#{k}];"
-          elsif j == @last
-            puts "    p64 = b[#{k}] & (0 - a[#{j}]);"
-          elsif k == @last
-            puts "    p64 = a[#{j}] & (0 - b[#{k}]);"
-          else
-            puts "    p128 = U128(a[#{j}]) * b[#{k}];"
-          end
-        else
-          puts "    p128 = U128(a[#{j}]) * b[#{k}];"
+    puts
+    # Product scanning calculates a column at a time while operand scanning
+    # calculates the products of a word of a at a time.
+    if @tune["mul"] == "os"
+      prods = []
+      0.upto(@last) { |j| 0.upto(@last) { |k| prods << [j + k, j, k] } }
+    else
+      prods = []
+      0.upto(@last*2) do |i|
+        0.upto(@last) do |j|
+          k = i - j
+          prods << [i, j, k] if k >= 0 && k <= @last
         end
-        if @hi_bits != 1 or (j != @last and k != @last)
-          puts "    t[#{i}] += (uint64_t)p128;"
-          puts "    t[#{i+1}] += p128 >> 64;"
+      end
+    end
+    prods.each do |i, j, k|
+      if @hi_bits == 1
+        if j == @last and k == @last
+          puts "    p64 = a[#{j}] & b[#{k}];"
+        elsif (j == @last or k == @last) and @mod_bits >= 256
+          puts "    p64 = a[#{j}] * b[#{k}];"
+        elsif j == @last
+          puts "    p64 = b[#{k}] & (0 - a[#{j}]);"
+        elsif k == @last
+          puts "    p64 = a[#{j}] & (0 - b[#{k}]);"
         else
-          puts "    t[#{i}] += p64;"
+          puts "    p128 = U128(a[#{j}]) * b[#{k}];"
         end
+      else
+        puts "    p128 = U128(a[#{j}]) * b[#{k}];"
+      end
+      if @hi_bits != 1 or (j != @last and k != @last)
+        puts "    t[#{i}] += (uint64_t)p128;"
+        puts "    t[#{i+1}] += p128 >> 64;"
+      else
+        puts "    t[#{i}] += p64;"
       end
     end
     puts <<EOF
@@ -398,104 +563,491 @@ EOF
 EOF
   end
 
-  def write_mod()
+  def write_radix_mod_small()
+    write_mul_mod_word()
     puts <<EOF
 
 /**
- * Reduce the number that is less than 2 times the prime modulo the prime.
+ * Propagate the carries of the limbs of a, up to 12 bits longer than a limb,
+ * and put the result in r. The carry out of the top limb is multiplied by the
+ * prime's last word and added to the bottom limb.
  *
  * @param [in] r  The result of the reduction.
- * @param [in] a  The number to reduce.
+ * @param [in] a  The number to operate on.
  */
-static void p#{@bits}_mod(uint64_t *r,uint64_t *a)
+static void p#{@bits}_mod_small(uint64_t *r, uint64_t *a)
 {
-    uint64_t c;
-    __int128_t t;
-
+    r[1] = a[1] + (a[0] >> NUM_BITS); r[0] = a[0] & NUM_MASK;
 EOF
-    top = ((1 << (@mod_bits & 63)) - 1)
-    mid = (1 << 64) - 1
-    bot = (1 << 64) - @word
-    print "    c = (a[#{@last}] == 0x#{top.to_s(16)}) & "
-    (@last-1).downto(1) do |i|
-      print "(a[#{i}] == 0x#{mid.to_s(16)}) & "
-    end
-    puts "(a[0] >= 0x#{bot.to_s(16)});"
-    puts "    t = c * MOD_WORD;"
-    0.upto(@last) do |i|
-      print "    t += a[#{i}]; r[#{i}] = t"
-      print "; t >>= 64;" if i != @last
-      print " & 0x#{top.to_s(16)};" if i == @last
-      puts
+    1.upto(@last-1) do |i|
+      puts "    r[#{i+1}] = a[#{i+1}] + (r[#{i}] >> NUM_BITS); r[#{i}] &= NUM_MASK;"
     end
     puts <<EOF
+    r[0] += MUL_MOD_WORD(r[#{@last}] >> NUM_BITS); r[#{@last}] &= NUM_MASK;
 }
 EOF
   end
 
-  def write_mod_inv()
-    ls = (@word + 1).to_s(2).length
-    w = (1 << ls) - (@word + 2)
-    ws = w.to_s(16)
-    t3 = ""
+  def write_radix_mod_long()
+    puts <<EOF
 
-    a = []
-    h = @mod_bits - ls
-    while h != 1
-      if h % 2 == 0
-        a << 2
-        h /= 2
-      elsif h % 5 == 0
-        a << 5
-        h /= 5
-        t3 = "\n    uint64_t t3[NUM_ELEMS];"
-      elsif h % 3 == 0
-        a << 3
-        h /= 3
-      else
-        a << 1
-        h -= 1;
-      end
+/**
+ * Perform modulo operation on a product result in 128-bit elements.
+ * Each element is a limb: the carries are propagated and the carry out of the
+ * top limb is multiplied by the prime's last word and added to the bottom limb.
+ *
+ * @param [in] r  The number reduce number.
+ * @param [in] t  The product result in 128-bit elements.
+ */
+static void p#{@bits}_mod_long(uint64_t *r, __uint128_t *t)
+{
+EOF
+    0.upto(@last-1) do |i|
+      puts "    t[#{i+1}] += t[#{i}] >> NUM_BITS; r[#{i}] = (uint64_t)t[#{i}] & NUM_MASK;"
+    end
+    puts <<EOF
+    t[0] = MUL_MOD_WORD(t[#{@last}] >> NUM_BITS) + r[0];
+    r[#{@last}] = (uint64_t)t[#{@last}] & NUM_MASK;
+    r[1] += (uint64_t)(t[0] >> NUM_BITS); r[0] = (uint64_t)t[0] & NUM_MASK;
+}
+EOF
+  end
+
+  def write_radix_mod_sub()
+    puts
+    0.upto(@last) do |i|
+        puts "/** Twice the prime element #{i}. */"
+        v = @prime >> (i * @nr)
+        v &= (1 << @nr) - 1 if i != @last
+        v *= 2
+        puts "#define P#{@bits}_#{i}\t0x#{v.to_s(16)}"
     end
 
     puts <<EOF
 
 /**
- * Calculate the inverse of a modulo the prime and store thre result in r.
+ * Subtract b from a (modulo prime) and put the result r.
+ * Twice the prime is added so that no limb goes negative.
  *
- * @param [in] r  The result of the inversion.
- * @param [in] a  The number to invert.
+ * @param [in] r  The result of the subtraction.
+ * @param [in] a  The first operand.
+ * @param [in] b  The second operand.
  */
-static void p#{@bits}_mod_inv(uint64_t *r, uint64_t *a)
+static void p#{@bits}_mod_sub(uint64_t *r, uint64_t *a, uint64_t *b)
 {
-    uint64_t t[NUM_ELEMS];
-    uint64_t t2[NUM_ELEMS];#{t3}
 EOF
-    puts "    uint64_t t#{ws}[NUM_ELEMS];" if w > 1
-    puts
+    0.upto(@last) do |i|
+      puts "    r[#{i}] = a[#{i}] + P#{@bits}_#{i} - b[#{i}];"
+    end
+    puts <<EOF
 
-    wt = w >> 1
-    n = "a"
-    wn = "a"
-    ts = "t2"
-    1.upto(ls) do |i|
-      break if wt == 0
-      print "    p#{@bits}_mod_sqr(#{ts}, #{n});"
-      print " p#{@bits}_mod_mul(t#{ws}, #{wn}, #{ts});" if (wt & 1) != 0
-      wn = "t#{ws}" if (wt & 1) != 0
-      puts
-      n = ts
-      ts = "t"
-      wt >>= 1
+    p#{@bits}_mod_small(r, r);
+}
+EOF
+  end
+
+  def write_radix_mod_mul(add)
+    write_mod_mul_doc(add)
+    if add
+      puts "static void p#{@bits}_mod_mul_add(uint64_t *r, uint64_t *a, uint64_t *b,"
+      puts "    uint64_t *c)"
+    else
+      puts "static void p#{@bits}_mod_mul(uint64_t *r, uint64_t *a, uint64_t *b)"
     end
+    puts <<EOF
+{
+    uint64_t w[NUM_ELEMS];
+    __uint128_t t[NUM_ELEMS];
 
-    h = 1
-    n = "a"
-    a.reverse.each do |o|
-      case o
-      when 1
-        if h == 1
-            print "    \t\t\t"
+EOF
+    # The products that overflow the top limb are reduced as they are made:
+    # 2^(NUM_BITS.NUM_ELEMS) is the prime's last word modulo the prime.
+    1.upto(@last) do |k|
+      puts "    w[#{k}] = MUL_MOD_WORD(b[#{k}]);"
+    end
+    0.upto(@last) do |i|
+      0.upto(@last) do |j|
+        k = (i - j) % @elems
+        o = (j > i) ? "w" : "b"
+        if j == 0
+          c = add ? "c[#{i}] + " : ""
+          puts "    t[#{i}] = #{c}U128(a[#{j}]) * #{o}[#{k}];"
+        else
+          puts "    t[#{i}] += U128(a[#{j}]) * #{o}[#{k}];"
+        end
+      end
+    end
+    puts <<EOF
+
+    p#{@bits}_mod_long(r, t);
+}
+EOF
+  end
+
+  def write_radix_mod_sqr()
+    puts <<EOF
+
+/**
+ * Square the number, a, modulo the prime and put in result in r.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number object to square.
+ */
+static void p#{@bits}_mod_sqr(uint64_t *r, uint64_t *a)
+{
+    __uint128_t t[NUM_ELEMS];
+
+EOF
+    0.upto(@last) do |i|
+      first = true
+      0.upto(@last) do |j|
+        k = (i - j) % @elems
+        next if j > k
+        m = (j == k) ? 1 : 2
+        m *= @word if j + k >= @elems
+        o = (m == 1) ? "a[#{k}]" : "(a[#{k}] * #{m})"
+        puts "    t[#{i}] #{first ? "=" : "+="} U128(a[#{j}]) * #{o};"
+        first = false
+      end
+    end
+    puts <<EOF
+
+    p#{@bits}_mod_long(r, t);
+}
+EOF
+    write_mod_sqr_n()
+  end
+
+  def write_radix_mod()
+    puts <<EOF
+
+/**
+ * Reduce the number modulo the prime.
+ * After the carries are propagated the number is less than 2 times the prime.
+ *
+ * @param [in] r  The result of the reduction.
+ * @param [in] a  The number to reduce.
+ */
+static void p#{@bits}_mod(uint64_t *r,uint64_t *a)
+{
+    uint64_t c;
+
+    p#{@bits}_mod_small(r, a);
+    /* c = 1 when r + the prime's last word overflows, r >= prime. */
+    c = (r[0] + MOD_WORD) >> NUM_BITS;
+EOF
+    1.upto(@last) do |i|
+      puts "    c = (r[#{i}] + c) >> NUM_BITS;"
+    end
+    puts "    r[0] += MUL_MOD_WORD(c);"
+    0.upto(@last-1) do |i|
+      puts "    r[#{i+1}] += r[#{i}] >> NUM_BITS; r[#{i}] &= NUM_MASK;"
+    end
+    puts <<EOF
+    r[#{@last}] &= NUM_MASK;
+}
+EOF
+  end
+
+  # Print the inline assembly statement made up of the instructions in s that
+  # use the first n of the column registers.
+  def adx_asm(s, n, inputs)
+    regs = ADX_REGS[0..n-1].map { |r| "\"#{r}\"" }.join(", ")
+    puts "    __asm__ __volatile__ ("
+    s.each { |l| puts "        \"#{l}\\n\\t\"" }
+    puts <<EOF
+        :
+        : #{inputs}
+        : "rax", "rdx", "r8", "r9", "memory", "cc",
+          #{regs}
+    );
+EOF
+  end
+
+  # Add the instructions that store the columns in registers c into the
+  # 128-bit elements of t from element o. Register rax is zero.
+  def adx_store(s, c, o)
+    c.each_with_index do |r, i|
+      s << "movq %%#{r}, #{16*(o+i)}(%[t])"
+      s << "movq %%rax, #{16*(o+i)+8}(%[t])"
+    end
+  end
+
+  # Add the instructions that multiply the first n words of a and b into the
+  # 128-bit elements of t.
+  # A row of products, a[i] * b, is added to a window of columns held in
+  # registers. The low words of the products are added with adcx (carry flag)
+  # and the high words with adox (overflow flag) so the two carry chains
+  # interleave. The bottom column of the window is complete after each row.
+  def adx_mul(s, n, b)
+    w = ADX_REGS[0..n]
+    s << "xorl %%eax, %%eax"
+    0.upto(n-1) do |i|
+      s << "movq #{8*i}(%[a]), %%rdx"
+      if i == 0
+        s << "mulxq 0(%[#{b}]), %%#{w[0]}, %%#{w[1]}"
+        1.upto(n-1) do |j|
+          s << "mulxq #{8*j}(%[#{b}]), %%r8, %%#{w[j+1]}"
+          s << "adcxq %%r8, %%#{w[j]}"
+        end
+      else
+        s << "xorl %%#{ADX_REG32[w[n]]}, %%#{ADX_REG32[w[n]]}"
+        0.upto(n-1) do |j|
+          s << "mulxq #{8*j}(%[#{b}]), %%r8, %%r9"
+          s << "adcxq %%r8, %%#{w[j]}"
+          s << "adoxq %%r9, %%#{w[j+1]}"
+        end
+      end
+      s << "adcxq %%rax, %%#{w[n]}"
+      # Column i is complete - its register becomes the new top column.
+      adx_store(s, [w[0]], i)
+      w = w.rotate
+    end
+    adx_store(s, w[0..n-1], n)
+  end
+
+  # Add the instructions that square the first n words of a into the 128-bit
+  # elements of t with all 2n columns held in registers.
+  # The products of different words are calculated once, in rows as for
+  # multiplication, then doubled with the carry flag chain while the squares
+  # of the words are added with the overflow flag chain.
+  def adx_sqr(s, n)
+    c = ADX_REGS[0..2*n-1]
+    s << "xorl %%#{ADX_REG32[c[0]]}, %%#{ADX_REG32[c[0]]}"
+    s << "xorl %%#{ADX_REG32[c[2*n-1]]}, %%#{ADX_REG32[c[2*n-1]]}"
+    s << "xorl %%eax, %%eax"
+    0.upto(n-2) do |i|
+      s << "movq #{8*i}(%[a]), %%rdx"
+      if i == 0
+        s << "mulxq 8(%[a]), %%#{c[1]}, %%#{c[2]}"
+        2.upto(n-1) do |j|
+          s << "mulxq #{8*j}(%[a]), %%r8, %%#{c[j+1]}"
+          s << "adcxq %%r8, %%#{c[j]}"
+        end
+      else
+        s << "xorl %%#{ADX_REG32[c[i+n]]}, %%#{ADX_REG32[c[i+n]]}"
+        (i+1).upto(n-1) do |j|
+          s << "mulxq #{8*j}(%[a]), %%r8, %%r9"
+          s << "adcxq %%r8, %%#{c[i+j]}"
+          s << "adoxq %%r9, %%#{c[i+j+1]}"
+        end
+      end
+      s << "adcxq %%rax, %%#{c[i+n]}"
+    end
+    s << "xorl %%eax, %%eax"
+    0.upto(n-1) do |i|
+      s << "movq #{8*i}(%[a]), %%rdx"
+      s << "mulxq %%rdx, %%r8, %%r9"
+      s << "adcxq %%#{c[2*i]}, %%#{c[2*i]}"
+      s << "adoxq %%r8, %%#{c[2*i]}"
+      s << "adcxq %%#{c[2*i+1]}, %%#{c[2*i+1]}"
+      s << "adoxq %%r9, %%#{c[2*i+1]}"
+    end
+    adx_store(s, c, 0)
+  end
+
+  # Print the products that involve the top word when the modulus has one bit
+  # in the top word - the top word of a reduced number is small.
+  def write_adx_top(sqr)
+    b = sqr ? "a" : "b"
+    puts "    t[#{@last*2}] = 0;"
+    0.upto(@last*2) do |i|
+      0.upto(@last) do |j|
+        k = i - j
+        next if k < 0 || k > @last || (sqr && j > k)
+        next if j != @last and k != @last
+        if j == @last and k == @last
+          puts sqr ? "    p64 = a[#{j}];" : "    p64 = a[#{j}] & b[#{k}];"
+        elsif @mod_bits >= 256
+          puts "    p64 = a[#{j}] * #{b}[#{k}];"
+        elsif j == @last
+          puts "    p64 = #{b}[#{k}] & (0 - a[#{j}]);"
+        else
+          puts "    p64 = a[#{j}] & (0 - #{b}[#{k}]);"
+        end
+        0.upto((sqr && j != k) ? 1 : 0) { puts "    t[#{i}] += p64;" }
+      end
+    end
+  end
+
+  def write_mod_sqr_adx()
+    n = (@hi_bits == 1) ? @last : @elems
+    if @hi_bits == 1
+      p64 = "\n    uint64_t p64;"
+      t_elems = @elems * 2 - 1;
+    else
+      p64 = ""
+      t_elems = @elems * 2;
+    end
+    puts <<EOF
+
+/**
+ * Square the number, a, modulo the prime and put in result in r.
+ * The product is calculated with the BMI2 and ADX instructions.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number object to square.
+ */
+static void p#{@bits}_mod_sqr(uint64_t *r, uint64_t *a)
+{#{p64}
+    __uint128_t t[#{t_elems}];
+
+EOF
+    s = []
+    if 2 * n <= ADX_REGS.length
+      adx_sqr(s, n)
+      adx_asm(s, 2 * n, "[t] \"r\" (t), [a] \"r\" (a)")
+    else
+      adx_mul(s, n, "a")
+      adx_asm(s, n + 1, "[t] \"r\" (t), [a] \"r\" (a)")
+    end
+    write_adx_top(true) if @hi_bits == 1
+    puts <<EOF
+
+    p#{@bits}_mod_long(r, t);
+}
+EOF
+    write_mod_sqr_n()
+  end
+
+  def write_mod_mul_adx(add)
+    n = (@hi_bits == 1) ? @last : @elems
+    if @hi_bits == 1
+      p64 = "\n    uint64_t p64;"
+      t_elems = @elems * 2 - 1;
+    else
+      p64 = ""
+      t_elems = @elems * 2;
+    end
+    write_mod_mul_doc(add)
+    if add
+      puts "static void p#{@bits}_mod_mul_add(uint64_t *r, uint64_t *a, uint64_t *b,"
+      puts "    uint64_t *c)"
+    else
+      puts "static void p#{@bits}_mod_mul(uint64_t *r, uint64_t *a, uint64_t *b)"
+    end
+    puts <<EOF
+{#{p64}
+    __uint128_t t[#{t_elems}];
+
+EOF
+    s = []
+    adx_mul(s, n, "b")
+    adx_asm(s, n + 1, "[t] \"r\" (t), [a] \"r\" (a), [b] \"r\" (b)")
+    write_adx_top(false) if @hi_bits == 1
+    0.upto(@last) { |i| puts "    t[#{i}] += c[#{i}];" } if add
+    puts <<EOF
+
+    p#{@bits}_mod_long(r, t);
+}
+EOF
+  end
+
+  def write_mod()
+    puts <<EOF
+
+/**
+ * Reduce the number that is less than 2 times the prime modulo the prime.
+ *
+ * @param [in] r  The result of the reduction.
+ * @param [in] a  The number to reduce.
+ */
+static void p#{@bits}_mod(uint64_t *r,uint64_t *a)
+{
+    uint64_t c;
+    __int128_t t;
+
+EOF
+    top = ((1 << (@mod_bits & 63)) - 1)
+    mid = (1 << 64) - 1
+    bot = (1 << 64) - @word
+    if @elems == 1
+      puts "    c = (a[0] >= 0x#{@prime.to_s(16)});"
+    else
+      print "    c = (a[#{@last}] == 0x#{top.to_s(16)}) & "
+      (@last-1).downto(1) do |i|
+        print "(a[#{i}] == 0x#{mid.to_s(16)}) & "
+      end
+      puts "(a[0] >= 0x#{bot.to_s(16)});"
+    end
+    puts "    t = c * MOD_WORD;"
+    0.upto(@last) do |i|
+      print "    t += a[#{i}]; r[#{i}] = t"
+      print "; t >>= 64;" if i != @last
+      print " & 0x#{top.to_s(16)};" if i == @last
+      puts
+    end
+    puts <<EOF
+}
+EOF
+  end
+
+  def write_mod_inv()
+    ls = (@word + 1).to_s(2).length
+    w = (1 << ls) - (@word + 2)
+    ws = w.to_s(16)
+    t3 = ""
+
+    a = []
+    h = @mod_bits - ls
+    while h != 1
+      if h % 2 == 0
+        a << 2
+        h /= 2
+      elsif h % 5 == 0
+        a << 5
+        h /= 5
+        t3 = "\n    uint64_t t3[NUM_ELEMS];"
+      elsif h % 3 == 0
+        a << 3
+        h /= 3
+      else
+        a << 1
+        h -= 1;
+      end
+    end
+
+    puts <<EOF
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p#{@bits}_mod_inv(uint64_t *r, uint64_t *a)
+{
+    uint64_t t[NUM_ELEMS];
+    uint64_t t2[NUM_ELEMS];#{t3}
+EOF
+    puts "    uint64_t t#{ws}[NUM_ELEMS];" if w > 1
+    puts
+
+    wt = w >> 1
+    n = "a"
+    wn = "a"
+    ts = "t2"
+    1.upto(ls) do |i|
+      break if wt == 0
+      print "    p#{@bits}_mod_sqr(#{ts}, #{n});"
+      print " p#{@bits}_mod_mul(t#{ws}, #{wn}, #{ts});" if (wt & 1) != 0
+      wn = "t#{ws}" if (wt & 1) != 0
+      puts
+      n = ts
+      ts = "t"
+      wt >>= 1
+    end
+
+    # The first step needs the square of a - the loop above only calculated
+    # it when the low bits of the exponent have more than one bit set.
+    sq = (w >> 1 == 0) ? "    p#{@bits}_mod_sqr(t2, a);" : "    \t\t\t"
+    h = 1
+    n = "a"
+    a.reverse.each do |o|
+      case o
+      when 1
+        if h == 1
+            print sq
         else
             print "    p#{@bits}_mod_sqr(t2, #{n});"
         end
@@ -504,17 +1056,18 @@ EOF
         h += 1
       when 2
         if h == 1
-           print "    \t\t\t"
+           print sq
+           print "\tp#{@bits}_mod_mul(t, t2, a);"
         else
            print "    p#{@bits}_mod_sqr_n(t2, #{n}, #{h});"
+           print "\tp#{@bits}_mod_mul(t, t2, t);"
         end
-        print "\tp#{@bits}_mod_mul(t, t2, t);"
         puts "\t\t/* #{h*2} */"
         h *= 2
       when 3
         puts "    p#{@bits}_copy(t2, #{n});" if n != "a"
         if h == 1
-           print "    \t\t\t"
+           print sq
            print "\tp#{@bits}_mod_mul(t, t2, a);"
         else
             print "    p#{@bits}_mod_sqr_n(t, #{n}, #{h});"
@@ -548,291 +1101,1592 @@ EOF
     p#{@bits}_mod_mul(r, t, #{wn});
 }
 EOF
-  end
-
-  def write_num_new()
+  end
+
+  # The expression for the width bits at offset off of the number n that has
+  # count limbs of radix bits. The bits above width are not masked off.
+  def radix_bits(n, radix, count, off, width)
+    terms = []
+    k = off / radix
+    while k < count and k * radix < off + width
+      b = k * radix
+      if b <= off
+        terms << ((b == off) ? "#{n}[#{k}]" : "(#{n}[#{k}] >> #{off - b})")
+      else
+        terms << "(#{n}[#{k}] << #{b - off})"
+      end
+      k += 1
+    end
+    terms.join(" | ")
+  end
+
+  # The expression e masked with mask.
+  def radix_mask(e, mask)
+    e.include?(" | ") ? "(#{e}) & #{mask}" : "#{e} & #{mask}"
+  end
+
+  # The expression for signed limb k from the words of number n.
+  def inv_limb(n, k)
+    if @nr != 64
+      e = radix_bits(n, @nr, @elems, k * 62, 62)
+      e = "(#{e})" if e.include?(" | ")
+      return (k == @inv_elems - 1) ? "(int64_t)#{e}" :
+                                     "(int64_t)(#{radix_mask(e, "INV_MASK")})"
+    end
+    b = k * 62
+    w = b / 64
+    o = b % 64
+    e = (o == 0) ? "#{n}[#{w}]" : "(#{n}[#{w}] >> #{o})"
+    if o + 62 > 64 and w + 1 < @elems
+      e = "(#{e} | (#{n}[#{w+1}] << #{64-o}))"
+    end
+    (k == @inv_elems - 1) ? "(int64_t)#{e}" : "(int64_t)(#{e} & INV_MASK)"
+  end
+
+  # The expression for word w of a number from the signed limbs of d.
+  def inv_word(d, w)
+    if @nr != 64
+      e = radix_bits("(uint64_t)#{d}", 62, @inv_elems, w * @nr, @nr)
+      return (w == @last) ? e : radix_mask(e, "NUM_MASK")
+    end
+    terms = []
+    0.upto(@inv_elems-1) do |k|
+      b = k * 62
+      next if b >= 64 * (w + 1) or b + 62 <= 64 * w
+      if b >= 64 * w
+        o = b - 64 * w
+        terms << ((o == 0) ? "(uint64_t)#{d}[#{k}]" :
+                             "((uint64_t)#{d}[#{k}] << #{o})")
+      else
+        terms << "((uint64_t)#{d}[#{k}] >> #{64 * w - b})"
+      end
+    end
+    terms.join(" | ")
+  end
+
+  def write_inv_common()
+    m62 = (1 << 62) - 1
+    # Inverse of the prime modulo 2^62 by Newton iteration.
+    mi = @prime
+    5.times { mi = (mi * (2 - @prime * mi)) & m62 }
+    # Bernstein and Yang: divsteps required for inputs of this many bits.
+    steps = (49 * @mod_bits + 57) / 17
+    iter = (steps + 61) / 62
+    puts <<EOF
+
+/** The number of bits in a limb of a signed number used in inversion. */
+#define INV_BITS	62
+/** The mask for a limb of a signed number used in inversion. */
+#define INV_MASK	0x#{m62.to_s(16)}
+/** The number of limbs in a signed number used in inversion. */
+#define INV_ELEMS	#{@inv_elems}
+/** The number of iterations of INV_BITS division steps that guarantees the
+ * inversion is complete: #{steps} steps are required for #{@mod_bits} bits. */
+#define INV_ITER	#{iter}
+/** The inverse of the prime modulo 2^INV_BITS. */
+#define INV_MOD_INV	0x#{mi.to_s(16)}
+
+/** The prime in signed limbs. */
+static const int64_t p#{@bits}_inv_mod[INV_ELEMS] = {
+EOF
+    0.upto(@inv_elems-1) do |k|
+      v = (k == @inv_elems - 1) ? (@prime >> (62 * k)) : ((@prime >> (62 * k)) & m62)
+      sep = (k == @inv_elems - 1) ? "" : ","
+      puts "    0x#{v.to_s(16)}#{sep}"
+    end
+    puts <<EOF
+};
+
+/**
+ * Apply the transition matrix to f and g and divide by 2^INV_BITS.
+ * The bottom INV_BITS bits are zero before the division.
+ *
+ * @param [in] f  The signed number f.
+ * @param [in] g  The signed number g.
+ * @param [in] t  The transition matrix.
+ */
+static void p#{@bits}_inv_update_fg(int64_t *f, int64_t *g, int64_t *t)
+{
+    __int128_t cf, cg;
+    int i;
+
+    cf = (__int128_t)t[0] * f[0] + (__int128_t)t[1] * g[0];
+    cg = (__int128_t)t[2] * f[0] + (__int128_t)t[3] * g[0];
+    cf >>= INV_BITS; cg >>= INV_BITS;
+    for (i=1; i<INV_ELEMS; i++)
+    {
+        cf += (__int128_t)t[0] * f[i] + (__int128_t)t[1] * g[i];
+        cg += (__int128_t)t[2] * f[i] + (__int128_t)t[3] * g[i];
+        f[i-1] = (int64_t)((uint64_t)cf & INV_MASK); cf >>= INV_BITS;
+        g[i-1] = (int64_t)((uint64_t)cg & INV_MASK); cg >>= INV_BITS;
+    }
+    f[INV_ELEMS-1] = (int64_t)cf;
+    g[INV_ELEMS-1] = (int64_t)cg;
+}
+
+/**
+ * Apply the transition matrix to d and e and divide by 2^INV_BITS modulo the
+ * prime. A multiple of the prime is added to make the bottom bits zero.
+ * d and e are in the range (-2.prime, prime) before and after.
+ *
+ * @param [in] d  The signed number d.
+ * @param [in] e  The signed number e.
+ * @param [in] t  The transition matrix.
+ */
+static void p#{@bits}_inv_update_de(int64_t *d, int64_t *e, int64_t *t)
+{
+    int64_t u = t[0], v = t[1], q = t[2], r = t[3];
+    int64_t md, me, sd, se;
+    __int128_t cd, ce;
+    int i;
+
+    /* Add [u, q] when d is negative and [v, r] when e is negative. */
+    sd = d[INV_ELEMS-1] >> 63;
+    se = e[INV_ELEMS-1] >> 63;
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+    cd = (__int128_t)u * d[0] + (__int128_t)v * e[0];
+    ce = (__int128_t)q * d[0] + (__int128_t)r * e[0];
+    /* Multiples of the prime that make the bottom bits zero. */
+    md -= (int64_t)((INV_MOD_INV * (uint64_t)cd + (uint64_t)md) & INV_MASK);
+    me -= (int64_t)((INV_MOD_INV * (uint64_t)ce + (uint64_t)me) & INV_MASK);
+    cd += (__int128_t)p#{@bits}_inv_mod[0] * md;
+    ce += (__int128_t)p#{@bits}_inv_mod[0] * me;
+    cd >>= INV_BITS; ce >>= INV_BITS;
+    for (i=1; i<INV_ELEMS; i++)
+    {
+        cd += (__int128_t)u * d[i] + (__int128_t)v * e[i];
+        ce += (__int128_t)q * d[i] + (__int128_t)r * e[i];
+        cd += (__int128_t)p#{@bits}_inv_mod[i] * md;
+        ce += (__int128_t)p#{@bits}_inv_mod[i] * me;
+        d[i-1] = (int64_t)((uint64_t)cd & INV_MASK); cd >>= INV_BITS;
+        e[i-1] = (int64_t)((uint64_t)ce & INV_MASK); ce >>= INV_BITS;
+    }
+    d[INV_ELEMS-1] = (int64_t)cd;
+    e[INV_ELEMS-1] = (int64_t)ce;
+}
+
+/**
+ * Initialize the signed numbers of an inversion of a.
+ * f = prime, g = a, d = 0, e = 1 - d.a = f and e.a = g modulo prime.
+ *
+ * @param [in] f  The signed number f.
+ * @param [in] g  The signed number g.
+ * @param [in] d  The signed number d.
+ * @param [in] e  The signed number e.
+ * @param [in] a  The number to invert.
+ */
+static void p#{@bits}_inv_init(int64_t *f, int64_t *g, int64_t *d, int64_t *e,
+    uint64_t *a)
+{
+    uint64_t n[NUM_ELEMS];
+    int i;
+
+    p#{@bits}_mod(n, a);
+EOF
+    0.upto(@inv_elems-1) do |k|
+      puts "    g[#{k}] = #{inv_limb("n", k)};"
+    end
+    puts <<EOF
+    for (i=0; i<INV_ELEMS; i++)
+    {
+        f[i] = p#{@bits}_inv_mod[i];
+        d[i] = 0;
+        e[i] = 0;
+    }
+    e[0] = 1;
+}
+
+/**
+ * Calculate the inverse from d once g is zero and f is 1 or -1.
+ * Bring d into the range (-prime, prime), negate when f is -1, and then into
+ * the range [0, prime).
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] d  The signed number d.
+ * @param [in] f  The signed number f.
+ */
+static void p#{@bits}_inv_final(uint64_t *r, int64_t *d, int64_t *f)
+{
+    int64_t c;
+    int i;
+
+    c = d[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] += p#{@bits}_inv_mod[i] & c;
+    c = f[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] = (d[i] ^ c) - c;
+    for (i=0; i<INV_ELEMS-1; i++)
+    {
+        d[i+1] += d[i] >> INV_BITS;
+        d[i] &= INV_MASK;
+    }
+    c = d[INV_ELEMS-1] >> 63;
+    for (i=0; i<INV_ELEMS; i++)
+        d[i] += p#{@bits}_inv_mod[i] & c;
+    for (i=0; i<INV_ELEMS-1; i++)
+    {
+        d[i+1] += d[i] >> INV_BITS;
+        d[i] &= INV_MASK;
+    }
+
+EOF
+    0.upto(@last) do |w|
+      puts "    r[#{w}] = #{inv_word("d", w)};"
+    end
+    puts "}"
+  end
+
+  def write_mod_inv_divsteps()
+    puts <<EOF
+
+/**
+ * Perform INV_BITS division steps on the bottom bits of f and g.
+ * The transition matrix, scaled by 2^INV_BITS, is put in t: [u, v, q, r].
+ * Constant time - the steps are performed with masks.
+ *
+ * @param [in]  delta  The delta value before the steps.
+ * @param [in]  f      The bottom bits of f.
+ * @param [in]  g      The bottom bits of g.
+ * @param [out] t      The transition matrix.
+ * @return  The delta value after the steps.
+ */
+static int64_t p#{@bits}_inv_divsteps(int64_t delta, uint64_t f, uint64_t g,
+    int64_t *t)
+{
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t c1, c2, x;
+    int i;
+
+    for (i=0; i<INV_BITS; i++)
+    {
+        /* c1 is all ones when delta > 0 and g is odd. */
+        c1 = (0 - ((uint64_t)(0 - delta) >> 63)) & (0 - (g & 1));
+        /* When c1: delta = -delta, (f, g) = (g, -f), (u, v, q, r) =
+         * (q, r, -u, -v). */
+        x = (f ^ g) & c1; f ^= x; g ^= x; g = (g ^ c1) - c1;
+        x = (u ^ q) & c1; u ^= x; q ^= x; q = (q ^ c1) - c1;
+        x = (v ^ r) & c1; v ^= x; r ^= x; r = (r ^ c1) - c1;
+        delta = (delta ^ (int64_t)c1) - (int64_t)c1 + 1;
+        /* When g is odd: g += f, q += u, r += v. */
+        c2 = 0 - (g & 1);
+        g += f & c2; q += u & c2; r += v & c2;
+        g >>= 1; u <<= 1; v <<= 1;
+    }
+
+    t[0] = (int64_t)u; t[1] = (int64_t)v; t[2] = (int64_t)q; t[3] = (int64_t)r;
+    return delta;
+}
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ * Constant time division steps (Bernstein and Yang) are used.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p#{@bits}_mod_inv(uint64_t *r, uint64_t *a)
+{
+    int64_t f[INV_ELEMS], g[INV_ELEMS], d[INV_ELEMS], e[INV_ELEMS];
+    int64_t t[4];
+    int64_t delta = 1;
+    int i;
+
+    p#{@bits}_inv_init(f, g, d, e, a);
+    for (i=0; i<INV_ITER; i++)
+    {
+        delta = p#{@bits}_inv_divsteps(delta, (uint64_t)f[0], (uint64_t)g[0], t);
+        p#{@bits}_inv_update_de(d, e, t);
+        p#{@bits}_inv_update_fg(f, g, t);
+    }
+    /* g is zero and f is 1 or -1: the inverse is d or -d. */
+    p#{@bits}_inv_final(r, d, f);
+}
+EOF
+  end
+
+  def write_mod_inv_vt()
+    puts <<EOF
+
+/**
+ * Perform INV_BITS division steps on the bottom bits of f and g.
+ * The transition matrix, scaled by 2^INV_BITS, is put in t: [u, v, q, r].
+ * Variable time - runs of zero bits in g are skipped at once and up to six
+ * bits of g are eliminated with each multiple of f.
+ * Only to be used on public values.
+ *
+ * @param [in]  delta  The delta value before the steps.
+ * @param [in]  f      The bottom bits of f.
+ * @param [in]  g      The bottom bits of g.
+ * @param [out] t      The transition matrix.
+ * @return  The delta value after the steps.
+ */
+static int64_t p#{@bits}_inv_divsteps_vt(int64_t delta, uint64_t f, uint64_t g,
+    int64_t *t)
+{
+    uint64_t u = 1, v = 0, q = 0, r = 1;
+    uint64_t m, w, x;
+    int i = INV_BITS, limit, zeros;
+
+    for (;;)
+    {
+        /* Remove the zero bits at the bottom of g - at most i. */
+        zeros = __builtin_ctzll(g | ((uint64_t)-1 << i));
+        g >>= zeros; u <<= zeros; v <<= zeros;
+        delta += zeros;
+        i -= zeros;
+        if (i == 0)
+            break;
+
+        /* g is odd. */
+        if (delta > 0)
+        {
+            /* delta = -delta, (f, g) = (g, -f), (u, v, q, r) =
+             * (q, r, -u, -v). */
+            delta = -delta;
+            x = f; f = g; g = 0 - x;
+            x = u; u = q; q = 0 - x;
+            x = v; v = r; r = 0 - x;
+            /* Eliminate up to 6 bits: w = -g/f mod 2^limit. */
+            limit = ((int)(1 - delta) > i) ? i : (int)(1 - delta);
+            m = ((uint64_t)-1 >> (64 - limit)) & 63;
+            w = (f * g * (f * f - 2)) & m;
+        }
+        else
+        {
+            /* Eliminate up to 4 bits: w = -g/f mod 2^limit. */
+            limit = ((int)(1 - delta) > i) ? i : (int)(1 - delta);
+            m = ((uint64_t)-1 >> (64 - limit)) & 15;
+            w = f + (((f + 1) & 4) << 1);
+            w = ((0 - w) * g) & m;
+        }
+        g += f * w; q += u * w; r += v * w;
+    }
+
+    t[0] = (int64_t)u; t[1] = (int64_t)v; t[2] = (int64_t)q; t[3] = (int64_t)r;
+    return delta;
+}
+
+/**
+ * Calculate the inverse of a modulo the prime and store thre result in r.
+ * Variable time division steps (Bernstein and Yang) are used that stop as
+ * soon as g is zero.
+ * Only to be used on public values.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void p#{@bits}_mod_inv_vt(uint64_t *r, uint64_t *a)
+{
+    int64_t f[INV_ELEMS], g[INV_ELEMS], d[INV_ELEMS], e[INV_ELEMS];
+    int64_t t[4];
+    int64_t delta = 1;
+    int64_t z;
+    int i;
+
+    p#{@bits}_inv_init(f, g, d, e, a);
+    do
+    {
+        delta = p#{@bits}_inv_divsteps_vt(delta, (uint64_t)f[0], (uint64_t)g[0],
+            t);
+        p#{@bits}_inv_update_de(d, e, t);
+        p#{@bits}_inv_update_fg(f, g, t);
+
+        for (i=0,z=0; i<INV_ELEMS; i++)
+            z |= g[i];
+    }
+    while (z != 0);
+    /* g is zero and f is 1 or -1: the inverse is d or -d. */
+    p#{@bits}_inv_final(r, d, f);
+}
+EOF
+  end
+
+  def write_num_new()
+    puts <<EOF
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the secret in bytes.
+ * @param [out] num  The new number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+
+    len = len;
+
+    *num = share_malloc(NUM_ELEMS*sizeof(uint64_t));
+    if (*num == NULL)
+        err = ALLOC;
+
+    return err;
+}
+EOF
+  end
+
+  def write_num_free()
+    puts <<EOF
+
+/**
+ * Free the dynamic memory associated with the number object.
+ *
+ * @param [in] num  The number object.
+ */
+void share_#{@fn}_num_free(void *num)
+{
+    if (num != NULL) share_free(num);
+}
+
+/**
+ * Initialize a number object in memory provided by the caller.
+ *
+ * @param [in]  len   The length of the secret in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_num_init(uint16_t len, void *num, size_t *size)
+{
+    len = len;
+
+    if (num != NULL)
+        memset(num, 0, NUM_ELEMS*sizeof(uint64_t));
+    *size = NUM_ELEMS*sizeof(uint64_t);
+
+    return NONE;
+}
+EOF
+  end
+
+  # The number of bytes of the encoding in the top word of a number.
+  def top_bytes()
+    @bytes - 8 * @wlast
+  end
+
+  def write_codec()
+    puts <<EOF
+
+/**
+ * Load 8 bytes of big-endian data as a word.
+ * On little-endian CPUs this is a single byte swapping load.
+ *
+ * @param [in] d  The data to load.
+ * @return  The word.
+ */
+static uint64_t p#{@bits}_load_be64(const uint8_t *d)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t w;
+
+    memcpy(&w, d, sizeof(w));
+    return __builtin_bswap64(w);
+#else
+    return ((uint64_t)d[0] << 56) | ((uint64_t)d[1] << 48) |
+           ((uint64_t)d[2] << 40) | ((uint64_t)d[3] << 32) |
+           ((uint64_t)d[4] << 24) | ((uint64_t)d[5] << 16) |
+           ((uint64_t)d[6] <<  8) | ((uint64_t)d[7]      );
+#endif
+}
+
+/**
+ * Store a word as 8 bytes of big-endian data.
+ * On little-endian CPUs this is a single byte swapping store.
+ *
+ * @param [in] d  The data to store into.
+ * @param [in] w  The word to store.
+ */
+static void p#{@bits}_store_be64(uint8_t *d, uint64_t w)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    w = __builtin_bswap64(w);
+    memcpy(d, &w, sizeof(w));
+#else
+    d[0] = w >> 56; d[1] = w >> 48; d[2] = w >> 40; d[3] = w >> 32;
+    d[4] = w >> 24; d[5] = w >> 16; d[6] = w >>  8; d[7] = w;
+#endif
+}
+
+/**
+ * Decode exactly NUM_BYTES of big-endian data into a number.
+ *
+ * @param [in] n  The number.
+ * @param [in] d  The data to decode.
+ */
+static void p#{@bits}_from_bin(uint64_t *n, const uint8_t *d)
+{
+EOF
+    # Numbers with limbs of less than 64 bits are loaded into words first.
+    nw = (@nr == 64) ? "n" : "w"
+    puts "    uint64_t w[#{@wlast+1}];\n\n" if @nr != 64
+    tb = top_bytes()
+    0.upto(@wlast-1) do |i|
+      puts "    #{nw}[#{i}] = p#{@bits}_load_be64(d + #{@bytes - 8 * (i + 1)});"
+    end
+    if tb == 8
+      puts "    #{nw}[#{@wlast}] = p#{@bits}_load_be64(d);"
+    else
+      t = (0..tb-1).map do |k|
+        s = 8 * (tb - 1 - k)
+        (s == 0) ? "d[#{k}]" : "((uint64_t)d[#{k}] << #{s})"
+      end
+      puts "    #{nw}[#{@wlast}] = #{t.join(" | ")};"
+    end
+    if @nr != 64
+      puts
+      0.upto(@last) do |k|
+        e = radix_bits("w", 64, @wlast + 1, k * @nr, @nr)
+        e = radix_mask(e, "NUM_MASK") if k != @last
+        puts "    n[#{k}] = #{e};"
+      end
+    end
+    puts <<EOF
+}
+
+/**
+ * Encode a number into exactly NUM_BYTES of big-endian data.
+ *
+ * @param [in] n  The number.
+ * @param [in] d  The data to encode into.
+ */
+static void p#{@bits}_to_bin(uint64_t *n, uint8_t *d)
+{
+EOF
+    if @nr != 64
+      puts "    uint64_t w[#{@wlast+1}];"
+      puts
+      0.upto(@wlast) do |i|
+        puts "    w[#{i}] = #{radix_bits("n", @nr, @elems, i * 64, 64)};"
+      end
+      puts
+    end
+    0.upto(@wlast-1) do |i|
+      puts "    p#{@bits}_store_be64(d + #{@bytes - 8 * (i + 1)}, #{nw}[#{i}]);"
+    end
+    if tb == 8
+      puts "    p#{@bits}_store_be64(d, #{nw}[#{@wlast}]);"
+    else
+      0.upto(tb-1) do |k|
+        s = 8 * (tb - 1 - k)
+        puts (s == 0) ? "    d[#{k}] = #{nw}[#{@wlast}];" :
+                        "    d[#{k}] = #{nw}[#{@wlast}] >> #{s};"
+      end
+    end
+    puts "}"
+  end
+
+  def write_num_from_bin()
+    puts <<EOF
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num)
+{
+    SHARE_ERR err = NONE;
+    uint8_t b[NUM_BYTES];
+
+    if (len > NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Shorter data is padded on the left with zeros. */
+    if (len < NUM_BYTES)
+    {
+        memset(b, 0, NUM_BYTES - len);
+        memcpy(b + NUM_BYTES - len, data, len);
+        data = b;
+    }
+    p#{@bits}_from_bin(num, data);
+
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    if (len != NUM_BYTES)
+    {
+        for (i=0; (err == NONE) && (i<cnt); i++)
+            err = share_#{@fn}_num_from_bin(data + i * step, len, num[i]);
+        goto end;
+    }
+
+    for (i=0; i<cnt; i++)
+        p#{@bits}_from_bin(num[i], data + i * step);
+
+end:
+    return err;
+}
+EOF
+  end
+
+  def write_num_to_bin()
+    puts <<EOF
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Longer data is padded on the left with zeros. */
+    memset(data, 0, len - NUM_BYTES);
+    p#{@bits}_to_bin(num, data + len - NUM_BYTES);
+
+end:
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    data += len - NUM_BYTES;
+    for (i=0; i<cnt; i++)
+    {
+        memset(data + i * step - (len - NUM_BYTES), 0, len - NUM_BYTES);
+        p#{@bits}_to_bin(num[i], data + i * step);
+    }
+
+end:
+    return err;
+}
+EOF
+  end
+
+  def write_num_inv()
+    puts <<EOF
+
+/**
+ * Calculate the inverse of a number modulo the prime.
+ *
+ * @param [in] prime  The prime as a number object.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_num_inv(void *prime, void *a, void *r)
+{
+    prime = prime;
+
+    p#{@bits}_mod_inv(r, a);
+    p#{@bits}_mod(r, r);
+
+    return NONE;
+}
+EOF
+  end
+
+  def write_scratch()
+    puts <<EOF
+
+/**
+ * Get the size of the scratch space that join needs.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    prime = prime;
+
+    *size = 2 * NUM_ELEMS * parts * sizeof(uint64_t);
+
+    return NONE;
+}
+EOF
+  end
+
+  def write_split(n = nil)
+    if n == nil
+      puts <<EOF
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_#{@fn}_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    SHARE_ERR err = NONE;
+    int16_t i;
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0]
+     * Only the final result is fully reduced.
+     */
+    p#{@bits}_copy(yd, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+        p#{@bits}_mod_mul_add(yd, yd, xd, ad[i]);
+    p#{@bits}_mod(yd, yd);
+
+    return err;
+}
+EOF
+      return
+    end
+    if n <= 3
+      poly = (0..n-1).map { |i| "x^#{i}.a[#{i}]" }.join(" + ")
+      horner = "a[#{n-1}]"
+      (n-2).downto(0) { |i| horner = "#{horner}.x + a[#{i}]" }
+      horner = "(a[2].x + a[1]).x + a[0]" if n == 3
+    else
+      poly = "x^0.a[0] + x^1.a[1] + ... + x^#{n-1}.a[#{n-1}]"
+      horner = "(..(a[#{n-1}].x + a[#{n-2}]).x + ..).x + a[0]"
+    end
+    puts <<EOF
+
+/**
+ * Calculate the y value of a split when #{n} parts are required.
+ * y = #{poly}
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. Always #{n}.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_split_#{n}(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+    parts = parts;
+
+    /* y = #{horner}
+     * Only the final result is fully reduced.
+     */
+    p#{@bits}_copy(yd, ad[#{n-1}]);
+EOF
+    (n-2).downto(0) do |i|
+      puts "    p#{@bits}_mod_mul_add(yd, yd, xd, ad[#{i}]);"
+    end
+    puts <<EOF
+    p#{@bits}_mod(yd, yd);
+
+    return NONE;
+}
+EOF
+  end
+
+  # The sum of terms for a comment: all the terms when there are few.
+  def sum_terms(n, op)
+    if n <= 3
+      (0..n-1).map { |i| yield i }.join(" #{op} ")
+    else
+      "#{yield 0} #{op} #{yield 1} #{op} .. #{op} #{yield n-1}"
+    end
+  end
+
+  def write_join_n(vt, n)
+    sfx = vt ? "_vt_#{n}" : "_#{n}"
+    doc = vt ? "\n * The x values are public: the denominators are inverted in variable time." : ""
+    if @lane == nil
+      denoms = "    /* d[i] = x[i] * product of (x[j] - x[i]) where j != i */\n"
+      (0..n-1).each do |i|
+        denoms += "\n" if i > 0
+        js = (0..n-1).to_a - [i]
+        denoms += "    p#{@bits}_mod_sub(d[#{i}], xd[#{js[0]}], xd[#{i}]);\n"
+        js[1..-1].each do |j|
+          denoms += "    p#{@bits}_mod_sub(t, xd[#{j}], xd[#{i}]);\n"
+          denoms += "    p#{@bits}_mod_mul(d[#{i}], d[#{i}], t);\n"
+        end
+        denoms += "    p#{@bits}_mod_mul(d[#{i}], d[#{i}], xd[#{i}]);\n"
+      end
+      lanes = ""
+    else
+      denoms = "    /* Calculate all the denominators - LANES at a time. */\n"
+      denoms += "    p#{@bits}_lane_denoms(d[0], #{n}, xd);\n"
+      lanes = "\n * The denominators are calculated LANES at a time."
+    end
+    np = "    p#{@bits}_copy(np, xd[0]);\n"
+    (1..n-1).each { |i| np += "    p#{@bits}_mod_mul(np, np, xd[#{i}]);\n" }
+    prod = "    p#{@bits}_copy(c[0], d[0]);\n"
+    (1..n-1).each do |i|
+      prod += "    p#{@bits}_mod_mul(c[#{i}], c[#{i-1}], d[#{i}]);\n"
+    end
+    sum = ""
+    (n-1).downto(1) do |i|
+      sum += "    p#{@bits}_mod_mul(t, inv, c[#{i-1}]);\n"
+      sum += "    p#{@bits}_mod_mul(inv, inv, d[#{i}]);\n"
+      if i == n - 1
+        sum += "    p#{@bits}_mod_mul(sum, t, yd[#{i}]);\n"
+      else
+        sum += "    p#{@bits}_mod_mul_add(sum, t, yd[#{i}], sum);\n"
+      end
+    end
+    sum += "    p#{@bits}_mod_mul_add(sum, inv, yd[0], sum);\n"
+    puts <<EOF
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * #{n} parts are required: straight-line code with the products of
+ * denominators and the denominators on the stack.#{lanes}
+ * The denominators are inverted together with one inversion.#{doc}
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret. Always #{n}.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_join#{sfx}(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t c[#{n}][NUM_ELEMS], d[#{n}][NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+
+    prime = prime;
+    parts = parts;
+    scratch = scratch;
+
+    /* np = #{sum_terms(n, "*") { |i| "x[#{i}]" }} */
+#{np}
+#{denoms}
+    /* c[i] = d[0] * .. * d[i] */
+#{prod}    /* inv = 1 / c[#{n-1}] */
+    p#{@bits}_mod_inv#{vt ? "_vt" : ""}(inv, c[#{n-1}]);
+
+    /* sum = #{sum_terms(n, "+") { |i| "y[#{i}] / d[#{i}]" }}
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+#{sum}
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p#{@bits}_mod_mul(sd, np, sum);
+    p#{@bits}_mod(sd, sd);
+
+    return NONE;
+}
+EOF
+  end
+
+  def write_join(vt, n = nil)
+    if n != nil
+      write_join_n(vt, n)
+      return
+    end
+    idx = (@lane == nil) ? "i, j" : "i"
+    sfx = vt ? "_vt" : ""
+    doc = vt ? "\n * The x values are public: the denominators are inverted in variable time." : ""
+    if @lane == nil
+      denoms = <<EOF
+    /* Calculate all the denominators. */
+    for (i=0; i<parts; i++)
+    {
+        /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
+        d = &dr[i*NUM_ELEMS];
+        p#{@bits}_set_word(d, 1);
+        for (j=0; j<parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            p#{@bits}_mod_sub(t, xd[j], xd[i]);
+            p#{@bits}_mod_mul(d, d, t);
+        }
+        p#{@bits}_mod_mul(d, d, xd[i]);
+    }
+EOF
+    else
+      denoms = <<EOF
+    /* Calculate all the denominators - LANES at a time. */
+    p#{@bits}_lane_denoms(dr, parts, xd);
+EOF
+    end
     puts <<EOF
 
 /**
- * Create a new number object.
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The denominators are inverted together with one inversion.#{doc}
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
  *
- * @param [in]  len  The length of the secret in bytes.
- * @param [out] num  The new number object.
- * @return  ALLOC when dynamic memory allocation fails.<br>
- *          NONE otherwise.
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
  */
-SHARE_ERR share_p#{@bits}_num_new(uint16_t len, void **num)
+SHARE_ERR share_#{@fn}_join#{sfx}(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
 {
-    SHARE_ERR err = NONE;
+    uint16_t #{idx};
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+    uint64_t *cr = scratch;
+    uint64_t *dr = cr + NUM_ELEMS * parts;
+    uint64_t *c, *d;
 
-    len = len;
+    prime = prime;
 
-    *num = malloc(NUM_ELEMS*sizeof(uint64_t));
-    if (*num == NULL)
-        err = ALLOC;
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    p#{@bits}_copy(np, xd[0]);
+    for (i=1; i<parts; i++)
+        p#{@bits}_mod_mul(np, np, xd[i]);
 
-    return err;
+#{denoms}
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*NUM_ELEMS];
+        d = &dr[i*NUM_ELEMS];
+        if (i == 0)
+            p#{@bits}_copy(c, d);
+        else
+            p#{@bits}_mod_mul(c, c - NUM_ELEMS, d);
+    }
+    /* inv = 1 / c[parts-1] */
+    p#{@bits}_mod_inv#{vt ? "_vt" : ""}(inv, &cr[(parts-1)*NUM_ELEMS]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    memset(sum, 0, sizeof(sum));
+    for (i=parts-1; i>0; i--)
+    {
+        p#{@bits}_mod_mul(t, inv, &cr[(i-1)*NUM_ELEMS]);
+        p#{@bits}_mod_mul(inv, inv, &dr[i*NUM_ELEMS]);
+        p#{@bits}_mod_mul_add(sum, t, yd[i], sum);
+    }
+    p#{@bits}_mod_mul_add(sum, inv, yd[0], sum);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    p#{@bits}_mod_mul(sd, np, sum);
+    p#{@bits}_mod(sd, sd);
+
+    return NONE;
 }
 EOF
   end
 
-  def write_num_free()
+  def write_lane_header()
+    puts <<EOF
+
+#include <immintrin.h>
+
+/** The number of numbers operated on at once. */
+#define LANES		#{@lane[:lanes]}
+/** The number of limbs in a lane number. */
+#define LANE_ELEMS	#{@ln}
+/** The number of bits in a limb of a lane number. */
+#define LANE_BITS	#{@lr}
+/** The mask for a limb of a lane number. */
+#define LANE_MASK	#{@lmask}
+/** The number of bits of the modulus in the top limb of a lane number. */
+#define LANE_TOP_BITS	#{@ls}
+/** The mask for the bits of the modulus in the top limb of a lane number. */
+#define LANE_TOP_MASK	#{@ltmask}
+
+/** A vector holding the same limb of each lane. */
+typedef #{@lane[:type]} lane_t;
+
+/* Operations on all lanes. */
+EOF
+    case @mode
+    when "ifma"
+      puts <<EOF
+#define LANE_ZERO()		_mm512_setzero_si512()
+#define LANE_SET(w)		_mm512_set1_epi64(w)
+#define LANE_LOAD(p)		_mm512_loadu_si512(p)
+#define LANE_STORE(p, a)	_mm512_storeu_si512(p, a)
+#define LANE_ADD(a, b)		_mm512_add_epi64(a, b)
+#define LANE_SUB(a, b)		_mm512_sub_epi64(a, b)
+#define LANE_AND(a, b)		_mm512_and_si512(a, b)
+#define LANE_OR(a, b)		_mm512_or_si512(a, b)
+#define LANE_SHR(a, n)		_mm512_srli_epi64(a, n)
+#define LANE_SHL(a, n)		_mm512_slli_epi64(a, n)
+/* One in the lanes where a and b are equal and zero otherwise. */
+#define LANE_EQ_ONE(a, b)	\\
+    _mm512_maskz_set1_epi64(_mm512_cmpeq_epi64_mask(a, b), 1)
+/* Add the low/high 52 bits of the 104-bit product of a and b to t. */
+#define LANE_MUL_LO(t, a, b)	_mm512_madd52lo_epu64(t, a, b)
+#define LANE_MUL_HI(t, a, b)	_mm512_madd52hi_epu64(t, a, b)
+EOF
+    when "avx2"
+      puts <<EOF
+#define LANE_ZERO()		_mm256_setzero_si256()
+#define LANE_SET(w)		_mm256_set1_epi64x(w)
+#define LANE_LOAD(p)		_mm256_loadu_si256((__m256i *)(p))
+#define LANE_STORE(p, a)	_mm256_storeu_si256((__m256i *)(p), a)
+#define LANE_ADD(a, b)		_mm256_add_epi64(a, b)
+#define LANE_SUB(a, b)		_mm256_sub_epi64(a, b)
+#define LANE_AND(a, b)		_mm256_and_si256(a, b)
+#define LANE_OR(a, b)		_mm256_or_si256(a, b)
+#define LANE_SHR(a, n)		_mm256_srli_epi64(a, n)
+#define LANE_SHL(a, n)		_mm256_slli_epi64(a, n)
+/* One in the lanes where a and b are equal and zero otherwise. */
+#define LANE_EQ_ONE(a, b)	\
+    _mm256_and_si256(_mm256_cmpeq_epi64(a, b), _mm256_set1_epi64x(1))
+/* Add the 64-bit product of the low 32 bits of a and b to t. */
+#define LANE_MUL(t, a, b)	_mm256_add_epi64(t, _mm256_mul_epu32(a, b))
+EOF
+    end
+  end
+
+  # The expression for limb k of a lane number from the words of number n.
+  def lane_limb(n, k)
+    b = k * @lr
+    w = b / 64
+    o = b % 64
+    e = (o == 0) ? "#{n}[#{w}]" : "(#{n}[#{w}] >> #{o})"
+    if o + @lr > 64 and w + 1 < @elems
+      e = "(#{e} | (#{n}[#{w+1}] << #{64-o}))"
+    end
+    "#{e} & LANE_MASK"
+  end
+
+  # The expression for word w of a number from the limbs of lane i in t.
+  def lane_word(t, w)
+    terms = []
+    0.upto(@ln-1) do |k|
+      b = k * @lr
+      next if b >= 64 * (w + 1) or b + @lr <= 64 * w
+      if b >= 64 * w
+        o = b - 64 * w
+        terms << ((o == 0) ? "#{t}[#{k}][i]" : "(#{t}[#{k}][i] << #{o})")
+      else
+        terms << "(#{t}[#{k}][i] >> #{64 * w - b})"
+      end
+    end
+    terms.join(" | ")
+  end
+
+  # Print a carry propagation through limbs from..to of t into r.
+  def lane_carry(r, t, from, to, mask)
+    from.upto(to-1) do |k|
+      puts "    #{t}[#{k+1}] = LANE_ADD(#{t}[#{k+1}], LANE_SHR(#{t}[#{k}], LANE_BITS)); #{r}[#{k}] = LANE_AND(#{t}[#{k}], #{mask});"
+    end
+  end
+
+  def write_lane_from_num()
     puts <<EOF
 
 /**
- * Free the dynamic memory associated with the number object.
+ * Convert LANES number objects into a lane number.
  *
- * @param [in] num  The number object.
+ * @param [in] r  The lane number.
+ * @param [in] a  The array of LANES number objects.
+ */
+static void p#{@bits}_lane_from_num(lane_t *r, uint64_t **a)
+{
+    uint64_t t[LANE_ELEMS][LANES];
+    uint64_t *n;
+    int i;
+
+    for (i=0; i<LANES; i++)
+    {
+        n = a[i];
+EOF
+    0.upto(@ln-1) do |k|
+      puts "        t[#{k}][i] = #{lane_limb("n", k)};"
+    end
+    puts "    }"
+    puts
+    0.upto(@ln-1) do |k|
+      puts "    r[#{k}] = LANE_LOAD(t[#{k}]);"
+    end
+    puts <<EOF
+}
+
+/**
+ * Set all lanes of a lane number to the value of the number object.
+ *
+ * @param [in] r  The lane number.
+ * @param [in] a  The number object.
  */
-void share_p#{@bits}_num_free(void *num)
+static void p#{@bits}_lane_set(lane_t *r, uint64_t *a)
 {
-    if (num != NULL) free(num);
+EOF
+    0.upto(@ln-1) do |k|
+      puts "    r[#{k}] = LANE_SET(#{lane_limb("a", k)});"
+    end
+    puts <<EOF
 }
 EOF
   end
 
-  def write_num_from_bin()
+  def write_lane_to_num()
     puts <<EOF
 
 /**
- * Encode the number object into data.
- * The data is assumed to be big-endian bytes.
+ * Convert a lane number into LANES fully reduced number objects.
  *
- * @param [in] num   The number object.
- * @param [in] data  The data to hold the encoding.
- * @param [in] len   The number of bytes that data can hold.
- * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
- *          NONE otherwise.
+ * @param [in] r  The array of LANES number objects.
+ * @param [in] a  The lane number.
  */
-SHARE_ERR share_p#{@bits}_num_from_bin(const uint8_t *data, uint16_t len,
-    void *num)
+static void p#{@bits}_lane_to_num(uint64_t **r, lane_t *a)
 {
-    SHARE_ERR err = NONE;
-    int8_t i, j;
-    uint64_t *n = num;
+    uint64_t t[LANE_ELEMS][LANES];
+    uint64_t *n;
+    int i;
 
-    if (len > NUM_BYTES)
+EOF
+    0.upto(@ln-1) do |k|
+      puts "    LANE_STORE(t[#{k}], a[#{k}]);"
+    end
+    puts <<EOF
+
+    for (i=0; i<LANES; i++)
     {
-        err = PARAM_BAD_LEN;
-        goto end;
+        n = r[i];
+EOF
+    0.upto(@last) do |w|
+      puts "        n[#{w}] = #{lane_word("t", w)};"
+    end
+    puts <<EOF
+        p#{@bits}_mod(n, n);
     }
-
-    for (i=0; i<NUM_ELEMS; i++)
-        n[i] = 0;
-    for (i=len-1,j=0; i>=0; i--,j++)
-        n[j/8] |= ((uint64_t)data[i]) << ((j & 7) * 8);
-
-end:
-    return err;
 }
 EOF
   end
 
-  def write_num_to_bin()
+  def write_lane_mod_long()
+    n = @ln
     puts <<EOF
 
 /**
- * Encode the number object into data.
- * The data is assumed to be big-endian bytes.
+ * Reduce the product of lane numbers modulo the prime.
+ * The result has limbs of LANE_BITS bits but is not fully reduced.
  *
- * @param [in] num   The number object.
- * @param [in] data  The data to hold the encoding.
- * @param [in] len   The number of bytes that data can hold.
- * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
- *          NONE otherwise.
+ * @param [in] r  The reduced lane number.
+ * @param [in] t  The product in 2 * LANE_ELEMS unnormalized limbs.
  */
-SHARE_ERR share_p#{@bits}_num_to_bin(void *num, uint8_t *data, uint16_t len)
+static void p#{@bits}_lane_mod_long(lane_t *r, lane_t *t)
 {
-    SHARE_ERR err = NONE;
-    int8_t i, j;
-    uint64_t *n = num;
-
-    if (len < NUM_BYTES)
-    {
-        err = PARAM_BAD_LEN;
-        goto end;
-    }
-
-    for (i=NUM_BYTES-1,j=0; i>=NUM_BYTES-len; i--,j++)
-        data[i] = n[j/8] >> ((j & 7) * 8);
-    for (; i>=0; i--)
-        data[i] = 0;
+    lane_t m = LANE_SET(LANE_MASK);
+    lane_t tm = LANE_SET(LANE_TOP_MASK);
+    lane_t w = LANE_SET(MOD_WORD);
+    lane_t h[LANE_ELEMS];
+    lane_t q;
 
-end:
-    return err;
-}
+    /* Normalize the columns of the product into limbs. */
 EOF
+    lane_carry("t", "t", 0, 2*n-1, "m")
+    puts
+    puts "    /* h = bits above the modulus. */"
+    0.upto(n-1) do |k|
+      puts "    h[#{k}] = LANE_AND(LANE_OR(LANE_SHR(t[#{n-1+k}], LANE_TOP_BITS), LANE_SHL(t[#{n+k}], #{@lr-@ls})), m);"
+    end
+    puts "    t[#{n-1}] = LANE_AND(t[#{n-1}], tm);"
+    puts
+    puts "    /* t = bits of the modulus + h * MOD_WORD */"
+    if @lane[:hi]
+      0.upto(n-1) do |k|
+        puts "    t[#{k}] = LANE_MUL_LO(t[#{k}], h[#{k}], w);"
+        if k < n-1
+          puts "    t[#{k+1}] = LANE_MUL_HI(t[#{k+1}], h[#{k}], w);"
+        else
+          puts "    q = LANE_MUL_HI(LANE_ZERO(), h[#{k}], w);"
+          puts "    t[#{k}] = LANE_ADD(t[#{k}], LANE_SHL(q, LANE_BITS));"
+        end
+      end
+    else
+      0.upto(n-1) do |k|
+        puts "    t[#{k}] = LANE_MUL(t[#{k}], h[#{k}], w);"
+      end
+    end
+    puts
+    lane_carry("t", "t", 0, n-1, "m")
+    puts
+    puts "    /* Fold in the few bits that are again above the modulus. */"
+    puts "    q = LANE_SHR(t[#{n-1}], LANE_TOP_BITS); t[#{n-1}] = LANE_AND(t[#{n-1}], tm);"
+    if @lane[:hi]
+      puts "    t[0] = LANE_MUL_LO(t[0], q, w);"
+    else
+      puts "    t[0] = LANE_MUL(t[0], q, w);"
+    end
+    lane_carry("r", "t", 0, n-1, "m")
+    puts "    r[#{n-1}] = t[#{n-1}];"
+    puts "}"
   end
 
-  def write_split()
-    puts <<EOF
+  def write_lane_mod_mul(add)
+    n = @ln
+    if add
+      puts <<EOF
 
 /**
- * Calculate the y value of a split.
- * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ * Multiply two lane numbers, a and b, add c and reduce modulo the prime.
  *
- * @param [in] prime  The prime as a number object. 
- * @param [in] parts  The number of parts that are required to recalcuate
- *                    secret. 
- * @param [in] a      The array of coefficients.
- * @param [in] x      The x value as a number object.
- * @param [in] y      The y value as a number object.
- * @return  ALLOC when dynamic memory allocation fails.<br>
- *          NONE otherwise.
+ * @param [in] r  The result of the multiplication and addition.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
+ * @param [in] c  The lane number to add.
  */
-SHARE_ERR share_p#{@bits}_split(void *prime, uint8_t parts, void **a, void *x,
-    void *y)
+static void p#{@bits}_lane_mod_mul_add(lane_t *r, lane_t *a, lane_t *b,
+    lane_t *c)
 {
-    SHARE_ERR err = NONE;
-    uint8_t i;
-    uint64_t t[NUM_ELEMS], m[NUM_ELEMS];
-    uint64_t **ad = (uint64_t **)a;
-    uint64_t *xd = x;
-    uint64_t *yd = y;
+    lane_t t[#{2*n}];
 
-    prime = prime;
+EOF
+    else
+      puts <<EOF
 
-    /* y = x^0.a[0] + x^1.a[1] - minimum of two parts. */
-    p#{@bits}_mod_mul(t, ad[1], xd);
-    p#{@bits}_mod_add(yd, ad[0], t);
+/**
+ * Multiply two lane numbers, a and b, modulo the prime and put result in r.
+ *
+ * @param [in] r  The result of the multiplication.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
+ */
+static void p#{@bits}_lane_mod_mul(lane_t *r, lane_t *a, lane_t *b)
+{
+    lane_t t[#{2*n}];
 
-    p#{@bits}_copy(m, xd);
-    for (i=2; i<parts; i++)
-    {
-        /* y += x^i.a[i] (m = x^i) */
-        p#{@bits}_mod_mul(m, m, xd);
-        p#{@bits}_mod_mul(t, ad[i], m);
-        p#{@bits}_mod_add(yd, yd, t);
-    }
-    p#{@bits}_mod(yd, yd);
+EOF
+    end
+    0.upto(2*n-1) do |k|
+      v = (add and k < n) ? "c[#{k}]" : "LANE_ZERO()"
+      puts "    t[#{k}] = #{v};"
+    end
+    puts
+    0.upto(2*n-2) do |i|
+      0.upto(n-1) do |j|
+        k = i - j
+        next if k < 0 || k > n-1
+        if @lane[:hi]
+          puts "    t[#{i}] = LANE_MUL_LO(t[#{i}], a[#{j}], b[#{k}]);"
+          puts "    t[#{i+1}] = LANE_MUL_HI(t[#{i+1}], a[#{j}], b[#{k}]);"
+        else
+          puts "    t[#{i}] = LANE_MUL(t[#{i}], a[#{j}], b[#{k}]);"
+        end
+      end
+    end
+    puts <<EOF
 
-    return err;
+    p#{@bits}_lane_mod_long(r, t);
 }
 EOF
   end
 
-  def write_join()
+  def write_lane_mod_sub()
+    n = @ln
+    # Twice the prime with all but the top limb borrowing from the next limb
+    # so that subtracting a reduced number leaves no limb negative.
+    p2 = 2 * @prime
+    l = (0...n).map { |k| (p2 >> (k * @lr)) & ((1 << @lr) - 1) }
+    l[n-1] = p2 >> (@lr * (n - 1))
+    0.upto(n-2) do |k|
+      l[k] += 1 << @lr
+      l[k+1] -= 1
+    end
     puts <<EOF
 
 /**
- * Calculate the secret from splits.
- * secret = sum of (i=0..parts-1) y[i] *
- *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * Subtract lane number b from a (modulo prime) and put the result r.
+ * Twice the prime is added so that no limb goes negative.
  *
- * @param [in] prime   The prime as a number object. 
- * @param [in] parts   The number of parts that are required to recalcuate
- *                     secret. 
- * @param [in] x       The array of x values as number objects.
- * @param [in] y       The array of y values as number objects.
- * @param [in] secret  The calculated secret as a number object.
- * @return  ALLOC when dynamic memory allocation fails.<br>
- *          NONE otherwise.
+ * @param [in] r  The result of the subtraction.
+ * @param [in] a  The first operand lane number.
+ * @param [in] b  The second operand lane number.
  */
-SHARE_ERR share_p#{@bits}_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret)
+static void p#{@bits}_lane_mod_sub(lane_t *r, lane_t *a, lane_t *b)
 {
-    SHARE_ERR err = NONE;
-    uint8_t i, j;
-    uint64_t np[NUM_ELEMS], t[NUM_ELEMS];
-    uint64_t **xd = (uint64_t **)x;
-    uint64_t **yd = (uint64_t **)y;
-    uint64_t *sd = secret;
-    uint64_t *nr, *n, *dr, *d;
-
-    prime = prime;
+    lane_t m = LANE_SET(LANE_MASK);
+    lane_t t[LANE_ELEMS];
 
-    /* Arrays of numerators and denominators as number objects. */
-    nr = malloc(NUM_ELEMS * parts * sizeof(uint64_t));
-    dr = malloc(NUM_ELEMS * parts * sizeof(uint64_t));
-    if ((nr == NULL) || (dr == NULL))
-    {
-        err = ALLOC;
-        goto end;
-    }
+EOF
+    0.upto(n-1) do |k|
+      puts "    t[#{k}] = LANE_SUB(LANE_ADD(a[#{k}], LANE_SET(0x#{l[k].to_s(16)})), b[#{k}]);"
+    end
+    lane_carry("r", "t", 0, n-1, "m")
+    puts "    r[#{n-1}] = t[#{n-1}];"
+    puts "}"
+  end
 
-    /* np = x[0] * x[1] * .. * x[parts-1] */
-    p#{@bits}_copy(np, xd[0]);
-    for (i=1; i<parts; i++)
-        p#{@bits}_mod_mul(np, np, x[i]);
+  def write_lane_denoms()
+    puts <<EOF
 
-    /* Calculate all the denominators. */
-    for (i=0; i<parts; i++)
+/**
+ * Calculate the denominators of the Lagrange basis polynomials, LANES at a
+ * time.
+ * d[i] = x[i] * (product of all x[j] - x[i] where i != j)
+ *
+ * @param [in] d      The array of denominators as number objects.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret.
+ * @param [in] x      The array of x values as number objects.
+ */
+static void p#{@bits}_lane_denoms(uint64_t *d, uint16_t parts, uint64_t **x)
+{
+    uint16_t i, j, k;
+    lane_t xi[LANE_ELEMS], xj[LANE_ELEMS], t[LANE_ELEMS], dl[LANE_ELEMS];
+    lane_t idx;
+    uint64_t li[LANES];
+    uint64_t *xp[LANES], *dp[LANES];
+    uint64_t unused[LANES][NUM_ELEMS];
+
+    for (i=0; i<parts; i+=LANES)
     {
-        /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
-        n = &nr[i*NUM_ELEMS];
-        d = &dr[i*NUM_ELEMS];
-        p#{@bits}_set_word(d, 1);
-        for (j=0; j<parts; j++)
+        /* Lanes past the last part calculate a result that is discarded. */
+        for (k=0; k<LANES; k++)
         {
-            if (i == j)
-                continue;
-
-            p#{@bits}_mod_sub(t, xd[j], xd[i]);
-            p#{@bits}_mod_mul(d, d, t);
+            li[k] = i + k;
+            xp[k] = (i + k < parts) ? x[i + k] : x[i];
+            dp[k] = (i + k < parts) ? &d[(i + k) * NUM_ELEMS] : unused[k];
         }
-        p#{@bits}_mod_mul(d, d, xd[i]);
-
-        /* n[i] = y[i].np (as x[i] is multiplied into denominator) */
-        p#{@bits}_mod_mul(n, np, yd[i]);
-    }
+        idx = LANE_LOAD(li);
+        p#{@bits}_lane_from_num(xi, xp);
 
-    /* Convert numerators to common denominator and sum. */
-    for (i=0; i<parts; i++)
-    {
-        n = &nr[i*NUM_ELEMS];
+EOF
+    puts "        dl[0] = LANE_SET(1);"
+    1.upto(@ln-1) do |k|
+      puts "        dl[#{k}] = LANE_ZERO();"
+    end
+    puts <<EOF
         for (j=0; j<parts; j++)
         {
-            if (i == j)
-                continue;
-            d = &dr[j*NUM_ELEMS];
-            p#{@bits}_mod_mul(n, n, d);
+            p#{@bits}_lane_set(xj, x[j]);
+            p#{@bits}_lane_mod_sub(t, xj, xi);
+            /* x[j] - x[i] is zero when i == j - multiply by one instead. */
+            t[0] = LANE_ADD(t[0], LANE_EQ_ONE(idx, LANE_SET(j)));
+            p#{@bits}_lane_mod_mul(dl, dl, t);
         }
-        if (i > 0)
-            p#{@bits}_mod_add(nr, nr, n);
+        p#{@bits}_lane_mod_mul(dl, dl, xi);
+
+        p#{@bits}_lane_to_num(dp, dl);
     }
-    /* Common denominator is product of all denominators. */
-    for (i=1; i<parts; i++)
-        p#{@bits}_mod_mul(dr, dr, &dr[i*NUM_ELEMS]);
+}
+EOF
+  end
 
-    /* secret = inverse denominator * sum of numerators. */
-    p#{@bits}_mod_inv(t, dr);
-    p#{@bits}_mod_mul(sd, t, nr);
-    p#{@bits}_mod(sd, sd);
+  def write_split_lanes()
+    puts <<EOF
+
+/**
+ * Calculate the y values of LANES splits at once.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The array of LANES x values as number objects.
+ * @param [in] y      The array of LANES y values as number objects.
+ * @return  NONE.
+ */
+SHARE_ERR share_#{@fn}_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y)
+{
+    SHARE_ERR err = NONE;
+    int16_t i;
+    lane_t xl[LANE_ELEMS], yl[LANE_ELEMS], al[LANE_ELEMS];
+    uint64_t **ad = (uint64_t **)a;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    p#{@bits}_lane_from_num(xl, (uint64_t **)x);
+    p#{@bits}_lane_set(yl, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+    {
+        p#{@bits}_lane_set(al, ad[i]);
+        p#{@bits}_lane_mod_mul_add(yl, yl, xl, al);
+    }
+    p#{@bits}_lane_to_num((uint64_t **)y, yl);
 
-end:
-    if (dr != NULL) free(dr);
-    if (nr != NULL) free(nr);
     return err;
 }
 EOF
   end
 
+  def write_lanes()
+    write_lane_from_num()
+    write_lane_to_num()
+    write_lane_mod_long()
+    write_lane_mod_mul(false)
+    write_lane_mod_mul(true)
+    write_lane_mod_sub()
+    write_lane_denoms()
+  end
+
+  def write_radix()
+    write_radix_mod_small()
+    write_radix_mod_long()
+    write_radix_mod_sub()
+    write_radix_mod_mul(false)
+    write_radix_mod_mul(true)
+    write_radix_mod()
+  end
+
   def write()
     write_header()
     write_copy()
-    write_set_word()
-    write_mod_small()
-    if @mod_bits & 63 == 1
-        write_mod_long_1()
+    write_set_word() if @lane == nil
+    if @nr != 64
+      write_radix()
+    else
+      write_mod_small()
+      if @mod_bits & 63 == 1
+          write_mod_long_1()
+      else
+          write_mod_long()
+      end
+      write_mod_sub() if @lane == nil
+      if @mode == "adx"
+        write_mod_mul_adx(false)
+        write_mod_mul_adx(true)
+      else
+        write_mod_mul(false)
+        write_mod_mul(true)
+      end
+      write_mod()
+    end
+    write_inv_common()
+    puts
+    puts "#ifdef SHARE_INV_FERMAT"
+    if @mode == "adx"
+      write_mod_sqr_adx()
+    elsif @nr != 64
+      write_radix_mod_sqr()
     else
-        write_mod_long()
+      write_mod_sqr()
     end
-    write_mod_add()
-    write_mod_sub()
-    write_mod_sqr()
-    write_mod_mul()
-    write_mod()
     write_mod_inv()
+    puts "#else"
+    write_mod_inv_divsteps()
+    puts "#endif"
+    write_mod_inv_vt()
+    write_lanes() if @lane != nil
     write_num_new()
     write_num_free()
+    write_codec()
     write_num_from_bin()
     write_num_to_bin()
     write_split()
-    write_join()
+    write_split_lanes() if @lane != nil
+    write_join(false)
+    write_join(true)
+    SPEC_PARTS.each do |n|
+      write_split(n)
+      write_join(false, n)
+      write_join(true, n)
+    end
+    write_num_inv()
+    write_scratch()
     puts
   end
 end
 
-prime = SharePrime.new(ARGV[0].to_i, ARGV[1].to_i(16))
+# Usage: share_prime.rb <bits> <word> [<mode>] [<kernel>=<variant> ...]
+# A mode of 'c' or no mode generates the C implementation.
+mode = nil
+tune = {}
+ARGV[2..-1].each do |arg|
+  if arg =~ /^(\w+)=(\w+)$/
+    tune[$1] = $2
+  elsif arg != "c"
+    mode = arg
+  end
+end
+
+prime = SharePrime.new(ARGV[0].to_i, ARGV[1].to_i(16), mode, tune)
 prime.write
 
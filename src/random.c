@@ -53,10 +53,11 @@ int pseudo_random(unsigned char *r, int l)
 
     return share_shake256(r, l, (unsigned char *)rd, sizeof(rd)) == 0;
 #else
-    int i;
-    static uint64_t rd[4] = { 0, 0, 0, 0 };
+    static uint64_t cnt = 0;
+    uint64_t rd[4] = { 0, 0, 0, 0 };
 
-    for (i=0; i<4 && ++rd[i] == 0; i++) ;
+    /* Threads each take a different value of the counter. */
+    rd[0] = __atomic_add_fetch(&cnt, 1, __ATOMIC_RELAXED);
 
     return share_shake256(r, l, (unsigned char *)rd, sizeof(rd)) == 0;
 #endif
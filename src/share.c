@@ -26,6 +26,12 @@
 #include "share_lcl.h"
 #include "random.h"
 
+/** The prime that supports up to 60-bit secrets. */
+static const uint8_t prime_60[] =
+{
+    0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff 
+};
+
 /** The prime that supports up to 126-bit secrets. */
 static const uint8_t prime_126[] =
 {
@@ -50,6 +56,15 @@ static const uint8_t prime_192[] =
     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe1 
 };
 
+/** The prime that supports up to 254-bit secrets: 2^255-19. */
+static const uint8_t prime_254[] =
+{
+    0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xed 
+};
+
 /** The prime that supports up to 256-bit secrets. */
 static const uint8_t prime_256[] =
 {
@@ -60,46 +75,163 @@ static const uint8_t prime_256[] =
     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xa3, 
 };
 
+/** The prime that supports up to 384-bit secrets. */
+static const uint8_t prime_384[] =
+{
+    0x01, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xf7, 
+};
+
+/** The prime that supports up to 520-bit secrets. */
+static const uint8_t prime_520[] =
+{
+    0x01, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+    0xff, 
+};
+
+/** Check an encoding has the length in bytes of share.h: a negative array
+ * size doesn't compile. */
+#define SHARE_PRIME_LEN_CHECK(name, bytes) \
+    typedef char name##_len[(sizeof(name) == (bytes)) ? 1 : -1]
+/** Check a prime of the list in share.h. */
+#define SHARE_PRIME_CHECK(bits, bytes, arg) \
+    SHARE_PRIME_LEN_CHECK(prime_##bits, bytes);
+SHARE_PRIMES(SHARE_PRIME_CHECK, 0)
+SHARE_PRIME_LEN_CHECK(prime_254, SHARE_PRIME_LEN(254, SHARE_METHS_FLAG_P254));
+
+/** An entry of the list of supported primes. */
+#define SHARE_PRIME_ENTRY(bits, bytes, arg) \
+    { bits, prime_##bits, sizeof(prime_##bits) },
+
 /** The list of supported primes. */
 static SHARE_PRIME share_primes[] =
 {
-    /* 0x7fffffffffffffffffffffffffffffff */
-    { 126, prime_126, sizeof(prime_126) },
-    /* 0x1ffffffffffffffffffffffffffffffe7 */
-    { 128, prime_128, sizeof(prime_128) },
-    /* 0x1ffffffffffffffffffffffffffffffffffffffffffffffe1 */
-    { 192, prime_192, sizeof(prime_192) },
-    /* 0x1ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffa3 */
-    { 256, prime_256, sizeof(prime_256) },
+    SHARE_PRIMES(SHARE_PRIME_ENTRY, 0)
 };
 
 /** The number of primes supported. */
 #define SHARE_PRIME_NUM ((int)(sizeof(share_primes)/(sizeof(*share_primes))))
 
+/** The list of primes supported when SHARE_METHS_FLAG_P254 is required. */
+static SHARE_PRIME share_p254_primes[] =
+{
+    /* 0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed */
+    { 254, prime_254, sizeof(prime_254) },
+};
+
+/** The number of primes supported when SHARE_METHS_FLAG_P254 is required. */
+#define SHARE_P254_PRIME_NUM \
+    ((int)(sizeof(share_p254_primes)/(sizeof(*share_p254_primes))))
+
+/** The polynomial of GF(2^128) without x^128: x^7 + x^2 + x + 1. */
+static const uint8_t poly_128[] =
+{
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x87 
+};
+
+SHARE_PRIME_LEN_CHECK(poly_128, SHARE_PRIME_LEN(128, SHARE_METHS_FLAG_BINARY));
+
+/** The list of supported binary fields. */
+static SHARE_PRIME share_fields[] =
+{
+    /* x^128 + x^7 + x^2 + x + 1 */
+    { 128, poly_128, sizeof(poly_128) },
+};
+
+/** The number of binary fields supported. */
+#define SHARE_FIELD_NUM ((int)(sizeof(share_fields)/(sizeof(*share_fields))))
+
+/** The prime with 2^32-th roots of unity: 2^64-2^32+1. */
+static const uint8_t prime_ntt_64[] =
+{
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01 
+};
+
+SHARE_PRIME_LEN_CHECK(prime_ntt_64, SHARE_PRIME_LEN(63, SHARE_METHS_FLAG_NTT));
+
+/** The list of primes supported for the number-theoretic transform. */
+static SHARE_PRIME share_ntt_primes[] =
+{
+    /* 0xffffffff00000001 */
+    { 63, prime_ntt_64, sizeof(prime_ntt_64) },
+};
+
+/** The number of primes supported for the number-theoretic transform. */
+#define SHARE_NTT_PRIME_NUM \
+    ((int)(sizeof(share_ntt_primes)/(sizeof(*share_ntt_primes))))
+
 /**
  * Retrieve the prime that supports the secret length specified.
+ * When a binary field is required, the field polynomial is retrieved instead.
+ * When the number-theoretic transform is required, a prime with large
+ * power-of-two roots of unity is retrieved.
+ * The prime 2^255-19 is only retrieved when required as shares modulo it are
+ * not compatible with shares modulo the default prime for the same secrets.
+ * XOR splits have no prime - numbers are the length of the secret but at
+ * least two bytes so that the index of any split fits in an x.
  *
- * @param [in]  len   The length of the secret in bits.
- * @param [out] data  The encoded prime.
- * @param [out] dlen  The length of the encoded prime in bytes.
- * @param [out] bits  The length of the encoded prime in bits.
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  flags  The flags required of the implementation.
+ * @param [out] data   The encoded prime.
+ * @param [out] dlen   The length of the encoded prime in bytes.
+ * @param [out] bits   The length of the encoded prime in bits.
  * @return  NOT_FOUND when the length is greater than any supported prime.<br>
  *          NONE otherwise.
  */
-SHARE_ERR share_prime_get(uint16_t len, const uint8_t **data, uint16_t *dlen,
-    uint16_t *bits)
+SHARE_ERR share_prime_get(uint16_t len, uint32_t flags, const uint8_t **data,
+    uint16_t *dlen, uint16_t *bits)
 {
     SHARE_ERR err = NOT_FOUND;
+    SHARE_PRIME *primes = share_primes;
+    int num = SHARE_PRIME_NUM;
     int i;
 
+    if (flags & SHARE_METHS_FLAG_XOR)
+    {
+        *data = NULL;
+        *dlen = SHARE_PRIME_LEN(len, SHARE_METHS_FLAG_XOR);
+        *bits = len;
+        err = NONE;
+        num = 0;
+    }
+    else if (flags & SHARE_METHS_FLAG_BINARY)
+    {
+        primes = share_fields;
+        num = SHARE_FIELD_NUM;
+    }
+    else if (flags & SHARE_METHS_FLAG_NTT)
+    {
+        primes = share_ntt_primes;
+        num = SHARE_NTT_PRIME_NUM;
+    }
+    else if (flags & SHARE_METHS_FLAG_P254)
+    {
+        primes = share_p254_primes;
+        num = SHARE_P254_PRIME_NUM;
+    }
+
     /* Return the first prime that is big enough to support secret. */
-    for (i=0; i<SHARE_PRIME_NUM; i++)
+    for (i=0; i<num; i++)
     {
-        if (len <= share_primes[i].max)
+        if (len <= primes[i].max)
         {
-            *data = share_primes[i].data;
-            *dlen = share_primes[i].len;
-            *bits = share_primes[i].max;
+            *data = primes[i].data;
+            *dlen = primes[i].len;
+            *bits = primes[i].max;
             err = NONE;
             break;
         }
@@ -109,53 +241,58 @@ SHARE_ERR share_prime_get(uint16_t len, const uint8_t **data, uint16_t *dlen,
 }
 
 /**
- * Create a new object that is used to split and join secrets.
+ * Get the length of the scratch space: the random coefficients when
+ * initializing split and the implementation's needs when splitting and
+ * joining.
  *
+ * @param [in]  meth   The implementation method.
+ * @param [in]  prime  The prime as a number object. NULL for implementations
+ *                     that are not generic.
  * @param [in]  len    The length of the secret in bytes.
  * @param [in]  parts  The number of parts required to recreate secret.
- * @param [in]  flags  Required features of the implementation.
- * @param [out] share  The new share operation object.
- * @return  PARAM_NULL when share is NULL.
- *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
- *          NOT_FOUND when no prime or implementation supports the requirements.
- *          <br>
- *          ALLOC when dynamic memory allocation fails.<br>
+ * @param [out] size   The length of the scratch space in bytes.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
-SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share)
+static SHARE_ERR share_scratch_len(SHARE_METH *meth, void *prime,
+    uint16_t len, uint16_t parts, size_t *size)
 {
     SHARE_ERR err = NONE;
-    SHARE *s = NULL;
-    SHARE_METH *meth;
-    uint16_t prime_bits;
-    uint16_t prime_len;
-    const uint8_t *prime_data;
-    void *prime = NULL;
-    int i;
+    size_t meth_len;
 
-    if (share == NULL)
+    *size = (size_t)len * (parts - 1);
+    if (meth->scratch != NULL)
     {
-        err = PARAM_NULL;
-        goto end;
-    }
-
-    /* Cannot split a secret into 0 or one splits.
-     * Don't allow excessive number of parts.
-     * A secret must be at least one byte.
-     */
-    if ((parts < 2) || (parts > SHARE_PARTS_MAX) || (len == 0))
-    {
-        err = PARAM_BAD_VALUE;
-        goto end;
+        err = meth->scratch(prime, parts, &meth_len);
+        if (err != NONE) goto end;
+        if (meth_len > *size)
+            *size = meth_len;
     }
+end:
+    return err;
+}
 
-    /* Retrieve the matching prime. */
-    err = share_prime_get(len, &prime_data, &prime_len, &prime_bits);
-    if (err != NONE) goto end;
-
-    /* Retrieve an implementation. */
-    err = share_meths_get(prime_bits, parts, flags, &meth);
-    if (err != NONE) goto end;
+/**
+ * Create a new object that is used to split and join secrets modulo the prime.
+ *
+ * @param [in]  len         The length of the secret in bits.
+ * @param [in]  prime_data  The encoded prime.
+ * @param [in]  prime_len   The length of the encoded prime in bytes.
+ * @param [in]  parts       The number of parts required to recreate secret.
+ * @param [in]  flags       Required features of the implementation.
+ * @param [in]  meth        The implementation method.
+ * @param [out] share       The new share operation object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+static SHARE_ERR share_new(uint16_t len, const uint8_t *prime_data,
+    uint16_t prime_len, uint16_t parts, uint32_t flags, SHARE_METH *meth,
+    SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    SHARE *s = NULL;
+    void *prime = NULL;
+    int i;
 
     /* Non-generic implementations are written for a prime. */
     if (meth->flags & SHARE_METHS_FLAG_GENERIC)
@@ -167,7 +304,7 @@ SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share)
     }
 
     /* Allocate dynamic memory and initialize for object. */
-    s = malloc(sizeof(*s));
+    s = share_malloc(sizeof(*s));
     if (s == NULL)
     {
         err = ALLOC;
@@ -177,15 +314,18 @@ SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share)
 
     /* Initialize object. */
     s->meth = meth;
+    s->join = meth->join;
+    if ((flags & SHARE_METHS_FLAG_PUBLIC_X) && (meth->join_vt != NULL))
+        s->join = meth->join_vt;
     s->len = (len + 7) / 8;
     s->mask = ((len & 7) == 0) ? 0xff : (1 << (len & 7)) - 1;
     s->parts = parts;
     s->prime_len = prime_len;
     s->prime = prime;
     prime = NULL;
-    s->num = malloc(parts * sizeof(*s->num));
-    s->y = malloc(parts * sizeof(*s->y));
-    s->random = malloc(prime_len);
+    s->num = share_malloc(parts * sizeof(*s->num));
+    s->y = share_malloc(parts * sizeof(*s->y));
+    s->random = share_malloc(prime_len);
     if ((s->num == NULL) || (s->y == NULL) || (s->random == NULL))
     {
         err = ALLOC;
@@ -195,6 +335,18 @@ SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share)
     memset(s->y, 0, parts * sizeof(*s->num));
     memset(s->random, 0, prime_len - s->len);
 
+    err = share_scratch_len(meth, s->prime, s->len, parts, &s->scratch_len);
+    if (err != NONE) goto end;
+    if (s->scratch_len > 0)
+    {
+        s->scratch = share_malloc(s->scratch_len);
+        if (s->scratch == NULL)
+        {
+            err = ALLOC;
+            goto end;
+        }
+    }
+
     /* Create numbers to support split and join operations. */
     for (i=0; i<s->parts; i++)
     {
@@ -216,6 +368,27 @@ SHARE_ERR SHARE_new(uint16_t len, uint8_t parts, uint32_t flags, SHARE **share)
     err = s->meth->num_new(s->prime_len, &s->res);
     if (err != NONE) goto end;
 
+    /* Create numbers to hold the x and y of each lane. */
+    if (s->meth->lanes > 0)
+    {
+        s->lx = share_malloc(s->meth->lanes * sizeof(*s->lx));
+        s->ly = share_malloc(s->meth->lanes * sizeof(*s->ly));
+        if ((s->lx == NULL) || (s->ly == NULL))
+        {
+            err = ALLOC;
+            goto end;
+        }
+        memset(s->lx, 0, s->meth->lanes * sizeof(*s->lx));
+        memset(s->ly, 0, s->meth->lanes * sizeof(*s->ly));
+        for (i=0; i<s->meth->lanes; i++)
+        {
+            err = s->meth->num_new(s->prime_len, &s->lx[i]);
+            if (err != NONE) goto end;
+            err = s->meth->num_new(s->prime_len, &s->ly[i]);
+            if (err != NONE) goto end;
+        }
+    }
+
     *share = s;
     s = NULL;
 end:
@@ -224,8 +397,384 @@ end:
     return err;
 }
 
+/**
+ * Create a new object that is used to split and join secrets.
+ * With SHARE_METHS_FLAG_XOR, exactly parts splits are generated and all are
+ * required to join. The secret can be any length.
+ *
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [in]  flags  Required features of the implementation.
+ * @param [out] share  The new share operation object.
+ * @return  PARAM_NULL when share is NULL.
+ *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no prime or implementation supports the requirements.
+ *          <br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_new(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    uint16_t prime_bits;
+    uint16_t prime_len;
+    const uint8_t *prime_data;
+    SHARE_METH *meth = NULL;
+
+    if (share == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    /* Cannot split a secret into 0 or one splits.
+     * Don't allow excessive number of parts - fewer when the field is only
+     * joined directly.
+     * A secret must be at least one byte.
+     */
+    if ((parts < 2) || (parts > SHARE_PARTS_MAX_FLAGS(flags)) || (len == 0))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    /* Retrieve the matching prime and an implementation. */
+    err = share_prime_get(len, flags, &prime_data, &prime_len, &prime_bits);
+    if (err != NONE) goto end;
+    err = share_meths_get(prime_bits, parts, flags, &meth);
+    if (err != NONE) goto end;
+
+    err = share_new(len, prime_data, prime_len, parts, flags, meth, share);
+end:
+    return err;
+}
+
+/**
+ * Create a new object that is used to split and join secrets with the
+ * implementation method specified rather than the one that would be chosen.
+ * Used to test each implementation. The method must support the prime for the
+ * length and flags, the number of parts and the CPU.
+ *
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [in]  flags  Required features of the implementation.
+ * @param [in]  meth   The implementation method.
+ * @param [out] share  The new share operation object.
+ * @return  PARAM_NULL when meth or share is NULL.
+ *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no prime supports the requirements.<br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_new_meth(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE_METH *meth, SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    uint16_t prime_bits;
+    uint16_t prime_len;
+    const uint8_t *prime_data;
+
+    if ((meth == NULL) || (share == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if ((parts < 2) || (parts > SHARE_PARTS_MAX_FLAGS(flags)) || (len == 0))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    err = share_prime_get(len, flags, &prime_data, &prime_len, &prime_bits);
+    if (err != NONE) goto end;
+
+    err = share_new(len, prime_data, prime_len, parts, flags, meth, share);
+end:
+    return err;
+}
+
+/**
+ * Create a new object that is used to split and join secrets modulo a prime
+ * supplied by the caller. A generic implementation is always used.
+ * The prime is not checked for primality.
+ *
+ * @param [in]  len        The length of the secret in bits. Must be less than
+ *                         the length of the prime in bits.
+ * @param [in]  prime      The prime as big-endian bytes.
+ * @param [in]  prime_len  The length of the prime in bytes.
+ * @param [in]  parts      The number of parts required to recreate secret.
+ * @param [in]  flags      Required features of the implementation.
+ * @param [out] share      The new share operation object.
+ * @return  PARAM_NULL when share or prime is NULL.
+ *          PARAM_BAD_VALUE when parts, length and/or prime are invalid.<br>
+ *          NOT_FOUND when no implementation supports the requirements.<br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_new_with_prime(uint16_t len, const uint8_t *prime,
+    uint16_t prime_len, uint16_t parts, uint32_t flags, SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    uint32_t prime_bits;
+    uint8_t b;
+    SHARE_METH *meth = NULL;
+
+    if ((share == NULL) || (prime == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    /* Leading zero bytes are not part of the prime. */
+    while ((prime_len > 0) && (prime[0] == 0))
+    {
+        prime++;
+        prime_len--;
+    }
+    prime_bits = 0;
+    if (prime_len > 0)
+    {
+        prime_bits = prime_len * 8;
+        for (b=prime[0]; (b & 0x80) == 0; b<<=1)
+            prime_bits--;
+    }
+
+    /* Cannot split a secret into 0 or one splits.
+     * Don't allow excessive number of parts - generic implementations only
+     * join directly.
+     * A secret must be at least one byte.
+     * The prime must be odd, greater than 3 and larger than any secret.
+     */
+    if ((parts < 2) || (parts > SHARE_PARTS_MAX_DIRECT) || (len == 0) ||
+        (prime_bits < 3) || (prime_bits > 0xffff) ||
+        ((prime[prime_len-1] & 1) == 0) || (len >= prime_bits))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    flags |= SHARE_METHS_FLAG_GENERIC;
+    err = share_meths_get(prime_bits, parts, flags, &meth);
+    if (err != NONE) goto end;
+
+    err = share_new(len, prime, prime_len, parts, flags, meth, share);
+end:
+    return err;
+}
+
+/** Round up to a multiple of the alignment of objects in caller memory. */
+#define SHARE_ALIGN(n) \
+    (((n) + SHARE_MEM_ALIGN - 1) & ~(size_t)(SHARE_MEM_ALIGN - 1))
+
+/** The layout of an object and its numbers in caller memory. */
+typedef struct share_layout_st
+{
+    /** The implementation method. */
+    SHARE_METH *meth;
+    /** The length of the encoded prime in bytes. */
+    uint16_t prime_len;
+    /** The number of number objects: coefficients, y values, result and the
+     * x and y values of each lane. */
+    size_t nums;
+    /** The length of a number object in bytes, aligned. */
+    size_t num_len;
+    /** The length of the scratch space in bytes. */
+    size_t scratch_len;
+    /** The total length in bytes. */
+    size_t len;
+} SHARE_LAYOUT;
+
+/**
+ * Calculate the layout of an object in caller memory.
+ * The object is followed by the array of number object pointers, the storage
+ * for encoding, the scratch space and then the numbers one after the other.
+ *
+ * @param [in]  len     The length of the secret in bits.
+ * @param [in]  parts   The number of parts required to recreate secret.
+ * @param [in]  flags   Required features of the implementation.
+ * @param [out] layout  The layout of the object.
+ * @return  PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no prime or implementation supports the requirements
+ *          in caller memory.<br>
+ *          NONE otherwise.
+ */
+static SHARE_ERR share_layout(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE_LAYOUT *layout)
+{
+    SHARE_ERR err = NONE;
+    uint16_t prime_bits;
+    const uint8_t *prime_data;
+
+    if ((parts < 2) || (parts > SHARE_PARTS_MAX_FLAGS(flags)) || (len == 0))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    err = share_prime_get(len, flags, &prime_data, &layout->prime_len,
+        &prime_bits);
+    if (err != NONE) goto end;
+    err = share_meths_get(prime_bits, parts, flags, &layout->meth);
+    if (err != NONE) goto end;
+    /* Generic implementations keep constants of the prime that are allocated.
+     */
+    if (layout->meth->num_init == NULL)
+    {
+        err = NOT_FOUND;
+        goto end;
+    }
+
+    err = layout->meth->num_init(layout->prime_len, NULL, &layout->num_len);
+    if (err != NONE) goto end;
+    layout->num_len = SHARE_ALIGN(layout->num_len);
+    err = share_scratch_len(layout->meth, NULL, (len + 7) / 8, parts,
+        &layout->scratch_len);
+    if (err != NONE) goto end;
+
+    layout->nums = 2 * (size_t)parts + 1 + 2 * (size_t)layout->meth->lanes;
+    layout->len = SHARE_ALIGN(sizeof(SHARE)) +
+                  SHARE_ALIGN(layout->nums * sizeof(void *)) +
+                  SHARE_ALIGN(layout->prime_len) +
+                  SHARE_ALIGN(layout->scratch_len) +
+                  layout->nums * layout->num_len;
+end:
+    return err;
+}
+
+/**
+ * Get the number of bytes of caller memory needed by SHARE_init().
+ *
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [in]  flags  Required features of the implementation.
+ * @param [out] size   The number of bytes of memory.
+ * @return  PARAM_NULL when size is NULL.<br>
+ *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no prime or implementation supports the requirements
+ *          in caller memory.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_size(uint16_t len, uint16_t parts, uint32_t flags,
+    size_t *size)
+{
+    SHARE_ERR err = NONE;
+    SHARE_LAYOUT layout;
+
+    if (size == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    err = share_layout(len, parts, flags, &layout);
+    if (err != NONE) goto end;
+
+    *size = layout.len;
+end:
+    return err;
+}
+
+/**
+ * Initialize an object that is used to split and join secrets in memory
+ * provided by the caller - on the stack, in an arena or in shared memory.
+ * The object, its numbers and its scratch space are laid out contiguously.
+ * No dynamic memory is allocated. Generic implementations are not supported.
+ * SHARE_free() zeroizes the memory and doesn't free it.
+ *
+ * @param [in]  buf    The memory to hold the object. Aligned to
+ *                     SHARE_MEM_ALIGN bytes.
+ * @param [in]  size   The number of bytes of memory. At least the size
+ *                     returned by SHARE_size().
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [in]  flags  Required features of the implementation.
+ * @param [out] share  The share operation object. Same address as buf.
+ * @return  PARAM_NULL when buf or share is NULL.<br>
+ *          PARAM_BAD_VALUE when parts and/or length are invalid or buf is not
+ *          aligned.<br>
+ *          PARAM_BAD_LEN when size is too small.<br>
+ *          NOT_FOUND when no prime or implementation supports the requirements
+ *          in caller memory.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_init(void *buf, size_t size, uint16_t len, uint16_t parts,
+    uint32_t flags, SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    SHARE_LAYOUT layout;
+    SHARE *s;
+    uint8_t *p = buf;
+    void **nums;
+    size_t i, num_len;
+
+    if ((buf == NULL) || (share == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if (((uintptr_t)buf & (SHARE_MEM_ALIGN - 1)) != 0)
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    err = share_layout(len, parts, flags, &layout);
+    if (err != NONE) goto end;
+    if (size < layout.len)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    memset(buf, 0, layout.len);
+    s = buf;
+    p += SHARE_ALIGN(sizeof(SHARE));
+    nums = (void **)p;
+    p += SHARE_ALIGN(layout.nums * sizeof(void *));
+    s->random = p;
+    p += SHARE_ALIGN(layout.prime_len);
+    if (layout.scratch_len > 0)
+        s->scratch = p;
+    p += SHARE_ALIGN(layout.scratch_len);
+
+    /* The numbers follow one another: coefficients, y values, result and
+     * lanes. */
+    for (i=0; i<layout.nums; i++)
+    {
+        err = layout.meth->num_init(layout.prime_len, p, &num_len);
+        if (err != NONE) goto end;
+        nums[i] = p;
+        p += layout.num_len;
+    }
+
+    s->meth = layout.meth;
+    s->join = layout.meth->join;
+    if ((flags & SHARE_METHS_FLAG_PUBLIC_X) && (layout.meth->join_vt != NULL))
+        s->join = layout.meth->join_vt;
+    s->len = (len + 7) / 8;
+    s->mask = ((len & 7) == 0) ? 0xff : (1 << (len & 7)) - 1;
+    s->parts = parts;
+    s->prime_len = layout.prime_len;
+    s->num = nums;
+    s->y = nums + parts;
+    s->res = nums[2 * parts];
+    if (layout.meth->lanes > 0)
+    {
+        s->lx = nums + 2 * parts + 1;
+        s->ly = s->lx + layout.meth->lanes;
+    }
+    s->scratch_len = layout.scratch_len;
+    s->mem_len = layout.len;
+
+    *share = s;
+end:
+    return err;
+}
+
 /**
  * Free the dynamic memory of the object.
+ * An object initialized in caller memory is zeroized and not freed.
  *
  * @param [in] share  The share operation object.
  */
@@ -233,27 +782,98 @@ void SHARE_free(SHARE *share)
 {
     int i;
 
-    if (share != NULL)
+    if ((share != NULL) && (share->mem_len != 0))
+    {
+        /* Numbers, scratch space and encodings all follow the object. */
+        share_zeroize(share, share->mem_len);
+    }
+    else if (share != NULL)
     {
+        if (share->ly != NULL)
+        {
+            for (i=0; i<share->meth->lanes; i++)
+                share->meth->num_free(share->ly[i]);
+            share_free(share->ly);
+        }
+        if (share->lx != NULL)
+        {
+            for (i=0; i<share->meth->lanes; i++)
+                share->meth->num_free(share->lx[i]);
+            share_free(share->lx);
+        }
         share->meth->num_free(share->res);
-        if (share->random != NULL) free(share->random);
+        if (share->scratch != NULL)
+        {
+            /* Scratch space holds random coefficients and intermediates. */
+            share_zeroize(share->scratch, share->scratch_len);
+            share_free(share->scratch);
+        }
+        if (share->random != NULL)
+        {
+            /* Holds the encodings of the secret and splits. */
+            share_zeroize(share->random, share->prime_len);
+            share_free(share->random);
+        }
         if (share->y != NULL)
         {
             for (i=0; i<share->parts; i++)
                 share->meth->num_free(share->y[i]);
-            free(share->y);
+            share_free(share->y);
         }
         if (share->num != NULL)
         {
             for (i=0; i<share->parts; i++)
                 share->meth->num_free(share->num[i]);
-            free(share->num);
+            share_free(share->num);
         }
         share->meth->num_free(share->prime);
-        free(share);
+        share_free(share);
     }
 }
 
+/**
+ * Scrub the secret state of the object so that it can be reused.
+ * All numbers are set to zero and the scratch space and encoding buffer are
+ * zeroized. The prime and the constants calculated for it are kept.
+ *
+ * @param [in] share  The share operation object.
+ * @return  PARAM_NULL when share is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_scrub(SHARE *share)
+{
+    SHARE_ERR err = NONE;
+    static const uint8_t zero[1] = { 0 };
+    int i;
+
+    if (share == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    for (i=0; (err == NONE) && (i<share->parts); i++)
+        err = share->meth->num_from_bin(zero, 1, share->num[i]);
+    for (i=0; (err == NONE) && (i<share->parts); i++)
+        err = share->meth->num_from_bin(zero, 1, share->y[i]);
+    if (err == NONE)
+        err = share->meth->num_from_bin(zero, 1, share->res);
+    for (i=0; (err == NONE) && (i<share->meth->lanes); i++)
+    {
+        err = share->meth->num_from_bin(zero, 1, share->lx[i]);
+        if (err == NONE)
+            err = share->meth->num_from_bin(zero, 1, share->ly[i]);
+    }
+    if (err != NONE) goto end;
+
+    if (share->scratch != NULL)
+        share_zeroize(share->scratch, share->scratch_len);
+    share_zeroize(share->random, share->prime_len);
+    share->cnt = 0;
+end:
+    return err;
+}
+
 /**
  * Get the length of the encoded share.
  *
@@ -329,7 +949,6 @@ end:
  * @param [in] share   The share operation object.
  * @param [in] secret  The data of the secret to split in big-endian bytes.
  * @return  PARAM_NULL when a parameter is NULL.<br>
- *          ALLOC when dynamic memory allocation fails.<br>
  *          RANDOM when the random number generator fails.<br>
  *          NONE otherwise.
  */
@@ -337,7 +956,7 @@ SHARE_ERR SHARE_split_init(SHARE *share, uint8_t *secret)
 {
     SHARE_ERR err = NONE;
     int i;
-    uint8_t *r, *t = NULL;
+    uint8_t *t;
 
     if ((share == NULL) || (secret == NULL))
     {
@@ -346,52 +965,44 @@ SHARE_ERR SHARE_split_init(SHARE *share, uint8_t *secret)
     }
 
     /* Generate all the random coefficient data at once - quicker. */
-    t = malloc(share->len * (share->parts-1));
-    if (t == NULL)
-    {
-        err = ALLOC;
-        goto end;
-    }
+    t = share->scratch;
     if (pseudo_random(t, share->len * (share->parts-1)) != 0)
     {
         err = RANDOM;
         goto end;
     }
 
-    /* The first coefficient is the secret. */
-    r = &share->random[share->prime_len-share->len];
+    /* Leading bytes of the encoding of a random x are zero. */
     memset(share->random, 0, share->prime_len-share->len);
-    memcpy(r, secret, share->len);
-    err = share->meth->num_from_bin(share->random, share->prime_len,
-        share->num[0]);
+
+    /* The first coefficient is the secret. */
+    err = share->meth->num_from_bin(secret, share->len, share->num[0]);
     if (err != NONE) goto end;
 
     /* Create number objects with the data for the random coefficients. */
     for (i=1; i<share->parts; i++)
-    {
-        memcpy(r, &t[share->len * (i-1)], share->len);
-        r[0] &= share->mask;
-        err = share->meth->num_from_bin(share->random, share->prime_len,
-            share->num[i]);
-        if (err != NONE) goto end;
-    }
+        t[share->len * (i-1)] &= share->mask;
+    err = share->meth->num_from_bin_n(t, share->len, share->len,
+        &share->num[1], share->parts-1);
+    if (err != NONE) goto end;
 
     /* Initialize the count of generated splits. */
     share->cnt = 0;
 end:
-    if (t != NULL) free(t);
     return err;
 }
 
 /**
  * Generate a split for the secret.
  * A random x is generated. There is a small chance that an x will be repeated.
+ * Implementations that calculate splits by index use the x of the next index
+ * instead and never repeat an x.
  * 
  * @param [in] share  The share operation object.
  * @param [in] data   The data of the generated split as big-endian bytes.
  * @return  PARAM_NULL when a parameter is NULL.<br>
- *          ALLOC when dynamic memory allocation fails.<br>
  *          RANDOM when the random number generator fails.<br>
+ *          FAILED when there are no more unique x values.<br>
  *          NONE otherwise.
  */
 SHARE_ERR SHARE_split(SHARE *share, uint8_t *data)
@@ -406,6 +1017,15 @@ SHARE_ERR SHARE_split(SHARE *share, uint8_t *data)
         goto end;
     }
 
+    if (share->meth->split_all != NULL)
+    {
+        err = share->meth->split_all(share->prime, share->parts, share->num,
+            share->cnt, 1, data, share->prime_len, share->scratch);
+        if (err != NONE) goto end;
+        share->cnt++;
+        goto end;
+    }
+
     x = share->y[0];
     r = &share->random[share->prime_len-share->len];
 
@@ -436,6 +1056,103 @@ end:
     return err;
 }
 
+/**
+ * Generate a number of splits for the secret.
+ * Implementations that have lanes calculate that many splits at once.
+ * A random x is generated for each split. There is a small chance that an x
+ * will be repeated.
+ * Implementations that calculate splits by index calculate all the splits in
+ * one operation - with the number-theoretic transform in O(num.log(num)).
+ * 
+ * @param [in] share  The share operation object.
+ * @param [in] data   The data of the generated splits as big-endian bytes.
+ *                    Each split is the length returned by SHARE_get_len().
+ * @param [in] num    The number of splits to generate.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          RANDOM when the random number generator fails.<br>
+ *          FAILED when there are no more unique x values.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_split_n(SHARE *share, uint8_t *data, uint16_t num)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i, j, n;
+    uint8_t lanes;
+    uint8_t *r;
+
+    if ((share == NULL) || (data == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    if (share->meth->split_all != NULL)
+    {
+        err = share->meth->split_all(share->prime, share->parts, share->num,
+            share->cnt, num, data, share->prime_len, share->scratch);
+        if (err != NONE) goto end;
+        share->cnt += num;
+        goto end;
+    }
+
+    lanes = share->meth->lanes;
+    /* Implementations without lanes calculate one split at a time. */
+    if (lanes == 0)
+    {
+        for (i=0; i<num; i++)
+        {
+            err = SHARE_split(share, data);
+            if (err != NONE) goto end;
+            data += share->prime_len * 2;
+        }
+        goto end;
+    }
+
+    r = &share->random[share->prime_len-share->len];
+    for (i=0; i<num; i+=lanes)
+    {
+        n = ((num - i) < lanes) ? (num - i) : lanes;
+
+        /* Generate a random x for each lane that will be used.
+         * The remaining lanes calculate with the last x and are ignored.
+         */
+        for (j=0; j<lanes; j++)
+        {
+            if (j < n)
+            {
+                if (pseudo_random(r, share->len) != 0)
+                {
+                    err = RANDOM;
+                    goto end;
+                }
+                r[0] &= share->mask;
+            }
+            err = share->meth->num_from_bin(share->random, share->prime_len,
+                share->lx[j]);
+            if (err != NONE) goto end;
+        }
+
+        /* Calculate the corresponding y of each lane using the coefficients.
+         */
+        err = share->meth->split_lanes(share->prime, share->parts, share->num,
+            share->lx, share->ly);
+        if (err != NONE) goto end;
+
+        /* Encode the x and y ordinates. */
+        err = share->meth->num_to_bin_n(share->lx, n, data, share->prime_len,
+            share->prime_len * 2);
+        if (err != NONE) goto end;
+        err = share->meth->num_to_bin_n(share->ly, n, data + share->prime_len,
+            share->prime_len, share->prime_len * 2);
+        if (err != NONE) goto end;
+        data += share->prime_len * 2 * n;
+
+        share->cnt += n;
+    }
+end:
+    return err;
+}
+
 /**
  * Initialize the joining of splits to calculate the secret.
  * 
@@ -466,7 +1183,6 @@ end:
  * @param [in] share  The share operation object.
  * @param [in] data   The data of the generated split as big-endian bytes.
  * @return  PARAM_NULL when a parameter is NULL.<br>
- *          ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
 SHARE_ERR SHARE_join_update(SHARE *share, uint8_t *data)
@@ -497,13 +1213,48 @@ end:
     return err;
 }
 
+/**
+ * Add a number of splits to be joined.
+ * Ignore any splits added beyond the minimum number required.
+ * 
+ * @param [in] share  The share operation object.
+ * @param [in] data   The data of the generated splits as big-endian bytes.
+ *                    Each split is the length returned by SHARE_get_len().
+ * @param [in] num    The number of splits in data.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_join_update_n(SHARE *share, uint8_t *data, uint16_t num)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (data == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if (num > share->parts - share->cnt)
+        num = share->parts - share->cnt;
+
+    /* Splits are an x and a y ordinate. */
+    err = share->meth->num_from_bin_n(data, share->prime_len,
+        share->prime_len * 2, &share->num[share->cnt], num);
+    if (err != NONE) goto end;
+    err = share->meth->num_from_bin_n(data + share->prime_len,
+        share->prime_len, share->prime_len * 2, &share->y[share->cnt], num);
+    if (err != NONE) goto end;
+
+    share->cnt += num;
+end:
+    return err;
+}
+
 /**
  * Calculate the secret from the splits.
  * 
  * @param [in] share   The share operation object.
  * @param [in] secret  The data of the secret as big-endian bytes.
  * @return  PARAM_NULL when a parameter is NULL.<br>
- *          ALLOC when dynamic memory allocation fails.<br>
  *          INVALID_DATA when the number of splits added is less than the number
  *          required (parts).<br>
  *          FAILED when the secret calculated is larger than expected.<br>
@@ -527,8 +1278,8 @@ SHARE_ERR SHARE_join_final(SHARE *share, uint8_t *secret)
         goto end;
     }
 
-    err = share->meth->join(share->prime, share->parts, share->num, share->y,
-        share->res);
+    err = share->join(share->prime, share->parts, share->num, share->y,
+        share->res, share->scratch);
     if (err != NONE) goto end;
 
     /* Encode the number up to prime length bytes. */
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "share_meth.h"
+
+#ifdef CPU_X86_64
+#include <emmintrin.h>
+#endif
+
+/** The function that allocates dynamic memory. malloc: NULL. */
+static SHARE_ALLOC_FUNC *share_alloc_func = NULL;
+/** The function that frees dynamic memory. free: NULL. */
+static SHARE_DEALLOC_FUNC *share_dealloc_func = NULL;
+/** The context passed to the allocator functions. */
+static void *share_alloc_ctx = NULL;
+
+/**
+ * Set the functions that allocate and free all dynamic memory of the library.
+ * Objects must be freed with the functions they were allocated with: set the
+ * allocator before creating any objects.
+ *
+ * @param [in] alloc    The function that allocates memory. malloc: NULL.
+ * @param [in] dealloc  The function that frees memory. free: NULL.
+ * @param [in] ctx      The context passed to the allocator functions.
+ * @return  PARAM_NULL when only one of the functions is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_set_allocator(SHARE_ALLOC_FUNC *alloc,
+    SHARE_DEALLOC_FUNC *dealloc, void *ctx)
+{
+    if ((alloc == NULL) != (dealloc == NULL))
+        return PARAM_NULL;
+
+    share_alloc_func = alloc;
+    share_dealloc_func = dealloc;
+    share_alloc_ctx = ctx;
+
+    return NONE;
+}
+
+/**
+ * Allocate dynamic memory with the allocator of the library.
+ *
+ * @param [in] size  The number of bytes to allocate.
+ * @return  The allocated memory or NULL on failure.
+ */
+void *share_malloc(size_t size)
+{
+    if (share_alloc_func == NULL)
+        return malloc(size);
+    return share_alloc_func(size, share_alloc_ctx);
+}
+
+/**
+ * Free dynamic memory with the allocator of the library.
+ *
+ * @param [in] ptr  The memory to free. May be NULL.
+ */
+void share_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+    if (share_dealloc_func == NULL)
+        free(ptr);
+    else
+        share_dealloc_func(ptr, share_alloc_ctx);
+}
+
+/**
+ * Zeroize memory such that the compiler doesn't remove the stores when the
+ * memory is about to be freed.
+ * Aligned 16 byte blocks are cleared with SSE2 stores, four at a time.
+ *
+ * @param [in] ptr  The memory to zeroize.
+ * @param [in] len  The number of bytes to zeroize.
+ */
+void share_zeroize(void *ptr, size_t len)
+{
+    uint8_t *p = ptr;
+#ifdef CPU_X86_64
+    __m128i z = _mm_setzero_si128();
+
+    for (; (len > 0) && (((uintptr_t)p & 15) != 0); len--)
+        *(p++) = 0;
+    for (; len >= 64; len -= 64, p += 64)
+    {
+        _mm_store_si128((__m128i *)p + 0, z);
+        _mm_store_si128((__m128i *)p + 1, z);
+        _mm_store_si128((__m128i *)p + 2, z);
+        _mm_store_si128((__m128i *)p + 3, z);
+    }
+    for (; len >= 16; len -= 16, p += 16)
+        _mm_store_si128((__m128i *)p, z);
+#endif
+    for (; len > 0; len--)
+        *(p++) = 0;
+
+    /* The memory is treated as read by the empty asm statement. */
+    __asm__ __volatile__ ("" : : "r" (ptr) : "memory");
+}
+
+/** The size of a transparent huge page in bytes. */
+#define ARENA_PAGE_SIZE		((size_t)2 << 20)
+/** The size of the header before each block in bytes. */
+#define ARENA_HDR_SIZE		16
+/** The number of sizes of block: 16 bytes to 2^47 bytes. */
+#define ARENA_CLASSES		44
+
+/** The header of a block of the arena. */
+typedef struct arena_hdr_st
+{
+    /** The number of bytes requested. Bytes beyond are always zero. */
+    uint64_t len;
+    /** The next free block of the same size class. */
+    struct arena_hdr_st *next;
+} ARENA_HDR;
+
+/** The data structure of an arena of locked memory. */
+struct share_arena_st
+{
+    /** The mapped memory. Aligned to a huge page. */
+    uint8_t *mem;
+    /** The length of the mapped memory in bytes. */
+    size_t size;
+    /** The number of bytes from the start handed out as blocks. */
+    size_t used;
+    /** The lists of free blocks - one for each size class. */
+    ARENA_HDR *free[ARENA_CLASSES];
+    /** The lock guarding the lists and the used count. */
+    uint8_t lock;
+};
+
+/**
+ * Get the size class of a block: the block holds 16 << cls bytes.
+ *
+ * @param [in] size  The number of bytes to hold.
+ * @return  The size class. ARENA_CLASSES when too big.
+ */
+static uint64_t arena_cls(size_t size)
+{
+    size_t len = 16;
+    uint64_t cls = 0;
+
+    while ((len < size) && (cls < ARENA_CLASSES))
+    {
+        len <<= 1;
+        cls++;
+    }
+
+    return cls;
+}
+
+/**
+ * Take the lock of the arena, spinning until available.
+ *
+ * @param [in] arena  The arena object.
+ */
+static void arena_lock(SHARE_ARENA *arena)
+{
+    while (__atomic_test_and_set(&arena->lock, __ATOMIC_ACQUIRE))
+    {
+        while (__atomic_load_n(&arena->lock, __ATOMIC_RELAXED))
+            ;
+    }
+}
+
+/**
+ * Release the lock of the arena.
+ *
+ * @param [in] arena  The arena object.
+ */
+static void arena_unlock(SHARE_ARENA *arena)
+{
+    __atomic_clear(&arena->lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * Create a new arena of memory for secret material.
+ * The memory is mapped aligned to transparent huge pages, kept out of core
+ * dumps and locked into RAM so that it is never swapped out. Locking faults
+ * in all pages: allocating from the arena has no page faults or system calls.
+ *
+ * @param [in]  size   The number of bytes of the arena. Rounded up to a
+ *                     multiple of a huge page.
+ * @param [out] arena  The new arena object.
+ * @return  PARAM_NULL when arena is NULL.<br>
+ *          PARAM_BAD_LEN when size is zero.<br>
+ *          ALLOC when mapping or locking the memory fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_ARENA_new(size_t size, SHARE_ARENA **arena)
+{
+    SHARE_ERR err = NONE;
+    SHARE_ARENA *a = NULL;
+    uint8_t *map = MAP_FAILED;
+    size_t map_len = 0, head;
+
+    if (arena == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if ((size == 0) || (size > SIZE_MAX - 2 * ARENA_PAGE_SIZE))
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+    size = (size + ARENA_PAGE_SIZE - 1) & ~(ARENA_PAGE_SIZE - 1);
+
+    a = malloc(sizeof(*a));
+    if (a == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    memset(a, 0, sizeof(*a));
+
+    /* Map an extra huge page and trim to get an aligned region. */
+    map_len = size + ARENA_PAGE_SIZE;
+    map = mmap(NULL, map_len, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    head = (ARENA_PAGE_SIZE - ((uintptr_t)map & (ARENA_PAGE_SIZE - 1))) &
+        (ARENA_PAGE_SIZE - 1);
+    if (head > 0)
+        munmap(map, head);
+    munmap(map + head + size, ARENA_PAGE_SIZE - head);
+    map += head;
+    map_len = size;
+
+#ifdef MADV_HUGEPAGE
+    madvise(map, size, MADV_HUGEPAGE);
+#endif
+#ifdef MADV_DONTDUMP
+    madvise(map, size, MADV_DONTDUMP);
+#endif
+    if (mlock(map, size) != 0)
+    {
+        err = ALLOC;
+        goto end;
+    }
+
+    a->mem = map;
+    a->size = size;
+    map = MAP_FAILED;
+    *arena = a;
+    a = NULL;
+end:
+    if (map != MAP_FAILED)
+        munmap(map, map_len);
+    if (a != NULL)
+        free(a);
+    return err;
+}
+
+/**
+ * Free the arena. The memory handed out is zeroized and unmapped.
+ * No blocks of the arena may be used after this call.
+ *
+ * @param [in] arena  The arena object.
+ */
+void SHARE_ARENA_free(SHARE_ARENA *arena)
+{
+    if (arena != NULL)
+    {
+        share_zeroize(arena->mem, arena->used);
+        munmap(arena->mem, arena->size);
+        free(arena);
+    }
+}
+
+/**
+ * Allocate a block of memory from the arena.
+ * Sizes are rounded up to a power of two and freed blocks are reused by size.
+ * Has the prototype of an allocator function: pass to SHARE_set_allocator()
+ * with the arena as the context.
+ *
+ * @param [in] size   The number of bytes to allocate.
+ * @param [in] arena  The arena object.
+ * @return  The allocated memory, aligned to 16 bytes, or NULL when the arena
+ *          is exhausted.
+ */
+void *SHARE_ARENA_alloc(size_t size, void *arena)
+{
+    SHARE_ARENA *a = arena;
+    ARENA_HDR *hdr = NULL;
+    uint64_t cls = arena_cls(size);
+    size_t len = (size_t)16 << cls;
+
+    if (cls == ARENA_CLASSES)
+        return NULL;
+
+    arena_lock(a);
+    if (a->free[cls] != NULL)
+    {
+        hdr = a->free[cls];
+        a->free[cls] = hdr->next;
+    }
+    else if (a->size - a->used >= ARENA_HDR_SIZE + len)
+    {
+        hdr = (ARENA_HDR *)(a->mem + a->used);
+        a->used += ARENA_HDR_SIZE + len;
+    }
+    arena_unlock(a);
+
+    if (hdr == NULL)
+        return NULL;
+    hdr->len = size;
+    hdr->next = NULL;
+    return (uint8_t *)hdr + ARENA_HDR_SIZE;
+}
+
+/**
+ * Free a block of memory to the arena.
+ * The bytes requested are zeroized before the block is available for reuse -
+ * the rest of the block was never written.
+ * Has the prototype of a free function: pass to SHARE_set_allocator() with
+ * the arena as the context.
+ *
+ * @param [in] ptr    The memory to free. May be NULL.
+ * @param [in] arena  The arena object.
+ */
+void SHARE_ARENA_dealloc(void *ptr, void *arena)
+{
+    SHARE_ARENA *a = arena;
+    ARENA_HDR *hdr;
+    uint64_t cls;
+
+    if (ptr == NULL)
+        return;
+
+    hdr = (ARENA_HDR *)((uint8_t *)ptr - ARENA_HDR_SIZE);
+    share_zeroize(ptr, hdr->len);
+    cls = arena_cls(hdr->len);
+
+    arena_lock(a);
+    hdr->next = a->free[cls];
+    a->free[cls] = hdr;
+    arena_unlock(a);
+}
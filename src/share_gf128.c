@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+#define NUM_ELEMS	2
+#define NUM_BYTES	16
+/** The reduction polynomial, x^128 + x^7 + x^2 + x + 1, without x^128. */
+#define GF128_POLY	0x87
+
+/**
+ * Copy the data of the number object into the result number object.
+ *
+ * @param [in] r  The result number object.
+ * @param [in] a  The number object to copy.
+ */
+static void gf128_copy(uint64_t *r, uint64_t *a)
+{
+    r[0] = a[0];
+    r[1] = a[1];
+}
+
+/**
+ * Multiply a by b in GF(2^128) and put the result in r.
+ * Constant time - one bit of b at a time with masks.
+ *
+ * @param [in] r  The result of the multiplication.
+ * @param [in] a  The first operand.
+ * @param [in] b  The second operand.
+ */
+static void gf128_mul(uint64_t *r, uint64_t *a, uint64_t *b)
+{
+    uint64_t r0 = 0, r1 = 0, m;
+    int i;
+
+    for (i=127; i>=0; i--)
+    {
+        /* r = r.x */
+        m = 0 - (r1 >> 63);
+        r1 = (r1 << 1) | (r0 >> 63);
+        r0 = (r0 << 1) ^ (m & GF128_POLY);
+        /* r = r + a when bit i of b is set. */
+        m = 0 - ((b[i >> 6] >> (i & 63)) & 1);
+        r0 ^= a[0] & m;
+        r1 ^= a[1] & m;
+    }
+
+    r[0] = r0;
+    r[1] = r1;
+}
+
+/**
+ * Square a in GF(2^128) n times and put the result in r.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number to square.
+ * @param [in] n  The number of times to square.
+ */
+static void gf128_sqr_n(uint64_t *r, uint64_t *a, uint16_t n)
+{
+    uint16_t i;
+
+    gf128_mul(r, a, a);
+    for (i=1; i<n; i++)
+        gf128_mul(r, r, r);
+}
+
+/**
+ * Calculate the inverse of a in GF(2^128) and put the result in r.
+ * r = a^(2^128 - 2) = (a^(2^127 - 1))^2
+ * The inverse of zero is zero.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void gf128_inv(uint64_t *r, uint64_t *a)
+{
+    uint64_t t[NUM_ELEMS];
+    uint64_t t2[NUM_ELEMS];
+    uint64_t t3[NUM_ELEMS];
+
+    /* t = a^(2^k - 1) for the k in the comments. */
+    gf128_sqr_n(t, a, 1);	gf128_mul(t, t, a);		/* 2 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 3 */
+    gf128_sqr_n(t2, t3, 3);	gf128_mul(t, t2, t3);		/* 6 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 7 */
+    gf128_sqr_n(t2, t3, 7);	gf128_mul(t, t2, t3);		/* 14 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 15 */
+    gf128_sqr_n(t2, t3, 15);	gf128_mul(t, t2, t3);		/* 30 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 31 */
+    gf128_sqr_n(t2, t3, 31);	gf128_mul(t, t2, t3);		/* 62 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 63 */
+    gf128_sqr_n(t2, t3, 63);	gf128_mul(t, t2, t3);		/* 126 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t, t, a);		/* 127 */
+    gf128_sqr_n(r, t, 1);
+}
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the secret in bytes.
+ * @param [out] num  The new number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf128_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+
+    len = len;
+
+    *num = share_malloc(NUM_ELEMS*sizeof(uint64_t));
+    if (*num == NULL)
+        err = ALLOC;
+
+    return err;
+}
+
+/**
+ * Free the dynamic memory associated with the number object.
+ *
+ * @param [in] num  The number object.
+ */
+void share_gf128_num_free(void *num)
+{
+    if (num != NULL) share_free(num);
+}
+
+/**
+ * Initialize a number object in memory provided by the caller.
+ *
+ * @param [in]  len   The length of the secret in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_num_init(uint16_t len, void *num, size_t *size)
+{
+    len = len;
+
+    if (num != NULL)
+        memset(num, 0, NUM_ELEMS*sizeof(uint64_t));
+    *size = NUM_ELEMS*sizeof(uint64_t);
+
+    return NONE;
+}
+
+/**
+ * Load 8 bytes of big-endian data as a word.
+ * On little-endian CPUs this is a single byte swapping load.
+ *
+ * @param [in] d  The data to load.
+ * @return  The word.
+ */
+static uint64_t gf128_load_be64(const uint8_t *d)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t w;
+
+    memcpy(&w, d, sizeof(w));
+    return __builtin_bswap64(w);
+#else
+    return ((uint64_t)d[0] << 56) | ((uint64_t)d[1] << 48) |
+           ((uint64_t)d[2] << 40) | ((uint64_t)d[3] << 32) |
+           ((uint64_t)d[4] << 24) | ((uint64_t)d[5] << 16) |
+           ((uint64_t)d[6] <<  8) | ((uint64_t)d[7]      );
+#endif
+}
+
+/**
+ * Store a word as 8 bytes of big-endian data.
+ * On little-endian CPUs this is a single byte swapping store.
+ *
+ * @param [in] d  The data to store into.
+ * @param [in] w  The word to store.
+ */
+static void gf128_store_be64(uint8_t *d, uint64_t w)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    w = __builtin_bswap64(w);
+    memcpy(d, &w, sizeof(w));
+#else
+    d[0] = w >> 56; d[1] = w >> 48; d[2] = w >> 40; d[3] = w >> 32;
+    d[4] = w >> 24; d[5] = w >> 16; d[6] = w >>  8; d[7] = w;
+#endif
+}
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes: the coefficient of x^0 is the
+ * least significant bit of the last byte.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf128_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num)
+{
+    SHARE_ERR err = NONE;
+    uint64_t *n = num;
+    uint8_t b[NUM_BYTES];
+
+    if (len > NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Shorter data is padded on the left with zeros. */
+    if (len < NUM_BYTES)
+    {
+        memset(b, 0, NUM_BYTES - len);
+        memcpy(b + NUM_BYTES - len, data, len);
+        data = b;
+    }
+    n[0] = gf128_load_be64(data + 8);
+    n[1] = gf128_load_be64(data);
+
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf128_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_gf128_num_from_bin(data + i * step, len, num[i]);
+
+    return err;
+}
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf128_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+    uint64_t *n = num;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Longer data is padded on the left with zeros. */
+    memset(data, 0, len - NUM_BYTES);
+    data += len - NUM_BYTES;
+    gf128_store_be64(data + 8, n[0]);
+    gf128_store_be64(data, n[1]);
+
+end:
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf128_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_gf128_num_to_bin(num[i], data + i * step, len);
+
+    return err;
+}
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ * Addition in GF(2^128) is XOR.
+ *
+ * @param [in] prime  The field polynomial as a number object. Not used.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    int16_t i;
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    gf128_copy(yd, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+    {
+        gf128_mul(yd, yd, xd);
+        yd[0] ^= ad[i][0];
+        yd[1] ^= ad[i][1];
+    }
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * Subtraction in GF(2^128) is XOR.
+ * The denominators are inverted together with one inversion.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in] prime    The field polynomial as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_join(void *prime, uint16_t parts, void **x,
+    void **y, void *secret,
+    void *scratch)
+{
+    uint16_t i, j;
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+    uint64_t *cr = scratch;
+    uint64_t *dr = cr + NUM_ELEMS * parts;
+    uint64_t *c, *d;
+
+    prime = prime;
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    gf128_copy(np, xd[0]);
+    for (i=1; i<parts; i++)
+        gf128_mul(np, np, xd[i]);
+
+    /* Calculate all the denominators. */
+    for (i=0; i<parts; i++)
+    {
+        /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
+        d = &dr[i*NUM_ELEMS];
+        gf128_copy(d, xd[i]);
+        for (j=0; j<parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            t[0] = xd[j][0] ^ xd[i][0];
+            t[1] = xd[j][1] ^ xd[i][1];
+            gf128_mul(d, d, t);
+        }
+    }
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*NUM_ELEMS];
+        d = &dr[i*NUM_ELEMS];
+        if (i == 0)
+            gf128_copy(c, d);
+        else
+            gf128_mul(c, c - NUM_ELEMS, d);
+    }
+    /* inv = 1 / c[parts-1] */
+    gf128_inv(inv, &cr[(parts-1)*NUM_ELEMS]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    memset(sum, 0, sizeof(sum));
+    for (i=parts-1; i>0; i--)
+    {
+        gf128_mul(t, inv, &cr[(i-1)*NUM_ELEMS]);
+        gf128_mul(inv, inv, &dr[i*NUM_ELEMS]);
+        gf128_mul(t, t, yd[i]);
+        sum[0] ^= t[0];
+        sum[1] ^= t[1];
+    }
+    gf128_mul(t, inv, yd[0]);
+    sum[0] ^= t[0];
+    sum[1] ^= t[1];
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    gf128_mul(sd, np, sum);
+
+    return NONE;
+}
+
+/**
+ * Calculate the inverse of a number in GF(2^128).
+ *
+ * @param [in] prime  The field polynomial as a number object. Not used.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_num_inv(void *prime, void *a, void *r)
+{
+    prime = prime;
+
+    gf128_inv(r, a);
+
+    return NONE;
+}
+
+/**
+ * Get the size of the scratch space that join needs.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in]  prime  The field polynomial as a number object. Not used.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    prime = prime;
+
+    *size = 2 * NUM_ELEMS * parts * sizeof(uint64_t);
+
+    return NONE;
+}
+
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+#ifdef CPU_X86_64
+
+#include <wmmintrin.h>
+
+#define NUM_ELEMS	2
+/** The reduction polynomial, x^128 + x^7 + x^2 + x + 1, without x^128. */
+#define GF128_POLY	0x87
+
+/**
+ * Copy the data of the number object into the result number object.
+ *
+ * @param [in] r  The result number object.
+ * @param [in] a  The number object to copy.
+ */
+static void gf128_copy(uint64_t *r, uint64_t *a)
+{
+    r[0] = a[0];
+    r[1] = a[1];
+}
+
+/**
+ * Reduce the 256-bit carry-less product, h.x^128 + l, and put the result in r.
+ * x^128 = x^7 + x^2 + x + 1 so h is multiplied by 0x87 and added to l. The
+ * bits of the product of the top word that are above x^127 are folded again.
+ *
+ * @param [in] r  The result of the reduction.
+ * @param [in] l  The bottom 128 bits of the product.
+ * @param [in] h  The top 128 bits of the product.
+ */
+static void gf128_reduce(uint64_t *r, __m128i l, __m128i h)
+{
+    __m128i p = _mm_set_epi64x(0, GF128_POLY);
+    __m128i t0, t1;
+
+    t0 = _mm_clmulepi64_si128(h, p, 0x00);
+    t1 = _mm_clmulepi64_si128(h, p, 0x01);
+    l = _mm_xor_si128(l, t0);
+    l = _mm_xor_si128(l, _mm_slli_si128(t1, 8));
+    t1 = _mm_clmulepi64_si128(_mm_srli_si128(t1, 8), p, 0x00);
+    l = _mm_xor_si128(l, t1);
+    _mm_storeu_si128((__m128i *)r, l);
+}
+
+/**
+ * Multiply a by b in GF(2^128) and put the result in r.
+ * Four carry-less multiplications of words and a reduction.
+ *
+ * @param [in] r  The result of the multiplication.
+ * @param [in] a  The first operand.
+ * @param [in] b  The second operand.
+ */
+static void gf128_mul(uint64_t *r, uint64_t *a, uint64_t *b)
+{
+    __m128i va = _mm_loadu_si128((const __m128i *)a);
+    __m128i vb = _mm_loadu_si128((const __m128i *)b);
+    __m128i l, h, m;
+
+    l = _mm_clmulepi64_si128(va, vb, 0x00);
+    h = _mm_clmulepi64_si128(va, vb, 0x11);
+    m = _mm_xor_si128(_mm_clmulepi64_si128(va, vb, 0x01),
+                      _mm_clmulepi64_si128(va, vb, 0x10));
+    l = _mm_xor_si128(l, _mm_slli_si128(m, 8));
+    h = _mm_xor_si128(h, _mm_srli_si128(m, 8));
+    gf128_reduce(r, l, h);
+}
+
+/**
+ * Square a in GF(2^128) n times and put the result in r.
+ * Squaring has no cross terms: two carry-less multiplications of words.
+ *
+ * @param [in] r  The result of the squaring.
+ * @param [in] a  The number to square.
+ * @param [in] n  The number of times to square.
+ */
+static void gf128_sqr_n(uint64_t *r, uint64_t *a, uint16_t n)
+{
+    __m128i va;
+    uint16_t i;
+
+    gf128_copy(r, a);
+    for (i=0; i<n; i++)
+    {
+        va = _mm_loadu_si128((const __m128i *)r);
+        gf128_reduce(r, _mm_clmulepi64_si128(va, va, 0x00),
+            _mm_clmulepi64_si128(va, va, 0x11));
+    }
+}
+
+/**
+ * Calculate the inverse of a in GF(2^128) and put the result in r.
+ * r = a^(2^128 - 2) = (a^(2^127 - 1))^2
+ * The inverse of zero is zero.
+ *
+ * @param [in] r  The result of the inversion.
+ * @param [in] a  The number to invert.
+ */
+static void gf128_inv(uint64_t *r, uint64_t *a)
+{
+    uint64_t t[NUM_ELEMS];
+    uint64_t t2[NUM_ELEMS];
+    uint64_t t3[NUM_ELEMS];
+
+    /* t = a^(2^k - 1) for the k in the comments. */
+    gf128_sqr_n(t, a, 1);	gf128_mul(t, t, a);		/* 2 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 3 */
+    gf128_sqr_n(t2, t3, 3);	gf128_mul(t, t2, t3);		/* 6 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 7 */
+    gf128_sqr_n(t2, t3, 7);	gf128_mul(t, t2, t3);		/* 14 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 15 */
+    gf128_sqr_n(t2, t3, 15);	gf128_mul(t, t2, t3);		/* 30 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 31 */
+    gf128_sqr_n(t2, t3, 31);	gf128_mul(t, t2, t3);		/* 62 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t3, t, a);		/* 63 */
+    gf128_sqr_n(t2, t3, 63);	gf128_mul(t, t2, t3);		/* 126 */
+    gf128_sqr_n(t, t, 1);	gf128_mul(t, t, a);		/* 127 */
+    gf128_sqr_n(r, t, 1);
+}
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ * Addition in GF(2^128) is XOR.
+ *
+ * @param [in] prime  The field polynomial as a number object. Not used.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_clmul_split(void *prime, uint16_t parts, void **a,
+    void *x, void *y)
+{
+    int16_t i;
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t *xd = x;
+    uint64_t *yd = y;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    gf128_copy(yd, ad[parts-1]);
+    for (i=parts-2; i>=0; i--)
+    {
+        gf128_mul(yd, yd, xd);
+        yd[0] ^= ad[i][0];
+        yd[1] ^= ad[i][1];
+    }
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * Subtraction in GF(2^128) is XOR.
+ * The denominators are inverted together with one inversion.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in] prime    The field polynomial as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_clmul_join(void *prime, uint16_t parts,
+    void **x, void **y, void *secret,
+    void *scratch)
+{
+    uint16_t i, j;
+    uint64_t np[NUM_ELEMS], t[NUM_ELEMS], inv[NUM_ELEMS], sum[NUM_ELEMS];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t **yd = (uint64_t **)y;
+    uint64_t *sd = secret;
+    uint64_t *cr = scratch;
+    uint64_t *dr = cr + NUM_ELEMS * parts;
+    uint64_t *c, *d;
+
+    prime = prime;
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    gf128_copy(np, xd[0]);
+    for (i=1; i<parts; i++)
+        gf128_mul(np, np, xd[i]);
+
+    /* Calculate all the denominators. */
+    for (i=0; i<parts; i++)
+    {
+        /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
+        d = &dr[i*NUM_ELEMS];
+        gf128_copy(d, xd[i]);
+        for (j=0; j<parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            t[0] = xd[j][0] ^ xd[i][0];
+            t[1] = xd[j][1] ^ xd[i][1];
+            gf128_mul(d, d, t);
+        }
+    }
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*NUM_ELEMS];
+        d = &dr[i*NUM_ELEMS];
+        if (i == 0)
+            gf128_copy(c, d);
+        else
+            gf128_mul(c, c - NUM_ELEMS, d);
+    }
+    /* inv = 1 / c[parts-1] */
+    gf128_inv(inv, &cr[(parts-1)*NUM_ELEMS]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    memset(sum, 0, sizeof(sum));
+    for (i=parts-1; i>0; i--)
+    {
+        gf128_mul(t, inv, &cr[(i-1)*NUM_ELEMS]);
+        gf128_mul(inv, inv, &dr[i*NUM_ELEMS]);
+        gf128_mul(t, t, yd[i]);
+        sum[0] ^= t[0];
+        sum[1] ^= t[1];
+    }
+    gf128_mul(t, inv, yd[0]);
+    sum[0] ^= t[0];
+    sum[1] ^= t[1];
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    gf128_mul(sd, np, sum);
+
+    return NONE;
+}
+
+/**
+ * Calculate the inverse of a number in GF(2^128).
+ *
+ * @param [in] prime  The field polynomial as a number object. Not used.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_clmul_num_inv(void *prime, void *a, void *r)
+{
+    prime = prime;
+
+    gf128_inv(r, a);
+
+    return NONE;
+}
+
+/**
+ * Get the size of the scratch space that join needs.
+ * The products of denominators and the denominators are kept in the scratch
+ * space.
+ *
+ * @param [in]  prime  The field polynomial as a number object. Not used.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  NONE.
+ */
+SHARE_ERR share_gf128_clmul_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    prime = prime;
+
+    *size = 2 * NUM_ELEMS * parts * sizeof(uint64_t);
+
+    return NONE;
+}
+
+#endif
+
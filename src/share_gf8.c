@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_lcl.h"
+#include "random.h"
+
+/** The reduction polynomial of GF(2^8) without the top bit: x^4+x^3+x+1. */
+#define GF8_POLY	0x1b
+
+/**
+ * Multiply each byte of a word by x in GF(2^8).
+ *
+ * @param [in] v  The word of bytes.
+ * @return  The word of products.
+ */
+#define GF8_XTIME64(v)                                                      \
+    ((((v) & 0x7f7f7f7f7f7f7f7fULL) << 1) ^                                 \
+     ((((v) >> 7) & 0x0101010101010101ULL) * GF8_POLY))
+
+/**
+ * Multiply two elements of GF(2^8).
+ * Constant time.
+ *
+ * @param [in] a  The first operand.
+ * @param [in] b  The second operand.
+ * @return  The product.
+ */
+uint8_t share_gf8_mul(uint8_t a, uint8_t b)
+{
+    uint8_t r = 0;
+    int i;
+
+    for (i=0; i<8; i++)
+    {
+        r ^= a & (0 - ((b >> i) & 1));
+        a = (a << 1) ^ (GF8_POLY & (0 - (a >> 7)));
+    }
+
+    return r;
+}
+
+/**
+ * Calculate the inverse of an element of GF(2^8): a^254.
+ *
+ * @param [in] a  The element to invert.
+ * @return  The inverse. Zero when a is zero.
+ */
+static uint8_t share_gf8_inv(uint8_t a)
+{
+    uint8_t r = a;
+    int i;
+
+    /* r = a^(2^7 - 1) and then squared: a^(2^8 - 2). */
+    for (i=0; i<6; i++)
+        r = share_gf8_mul(share_gf8_mul(r, r), a);
+
+    return share_gf8_mul(r, r);
+}
+
+/**
+ * Multiply rows of bytes by constants in GF(2^8) and sum the products.
+ * Eight bytes are operated on at once in a word. Only the bits that are set in
+ * the constants are used. The constants are public.
+ *
+ * @param [in] rows    The rows of bytes.
+ * @param [in] stride  The number of bytes from the start of one row to the
+ *                     next.
+ * @param [in] n       The number of rows.
+ * @param [in] m       The constants to multiply each row by.
+ * @param [in] r       The sum of products.
+ * @param [in] len     The number of bytes in each row and in r.
+ */
+void share_gf8_c_mul_sum(const uint8_t *rows, uint32_t stride, uint8_t n,
+    const uint8_t *m, uint8_t *r, uint32_t len)
+{
+    uint32_t i;
+    uint8_t k, c;
+    uint64_t a, v;
+
+    for (i=0; i+8<=len; i+=8)
+    {
+        a = 0;
+        for (k=0; k<n; k++)
+        {
+            memcpy(&v, rows + (size_t)k * stride + i, sizeof(v));
+            for (c=m[k]; c!=0; c>>=1)
+            {
+                a ^= v & (0 - (uint64_t)(c & 1));
+                v = GF8_XTIME64(v);
+            }
+        }
+        memcpy(r + i, &a, sizeof(a));
+    }
+    for (; i<len; i++)
+    {
+        a = 0;
+        for (k=0; k<n; k++)
+            a ^= share_gf8_mul(rows[(size_t)k * stride + i], m[k]);
+        r[i] = (uint8_t)a;
+    }
+}
+
+/**
+ * Create a new object that is used to split and join secrets of any length.
+ * Each byte of the secret is split and joined independently in GF(2^8).
+ *
+ * @param [in]  len    The length of the secret in bytes.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [out] share  The new share operation object.
+ * @return  PARAM_NULL when share is NULL.
+ *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no implementation is available.<br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_new(uint32_t len, uint8_t parts, SHARE_GF8 **share)
+{
+    SHARE_ERR err = NONE;
+    SHARE_GF8 *s = NULL;
+    SHARE_GF8_METH *meth;
+
+    if (share == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    /* Cannot split a secret into 0 or one splits.
+     * There are at most 255 parts - one for each non-zero x.
+     * A secret must be at least one byte.
+     */
+    if ((parts < 2) || (len == 0))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    /* Retrieve an implementation. */
+    err = share_gf8_meths_get(&meth);
+    if (err != NONE) goto end;
+
+    /* Allocate dynamic memory and initialize for object. */
+    s = share_malloc(sizeof(*s));
+    if (s == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    memset(s, 0, sizeof(*s));
+
+    s->meth = meth;
+    s->len = len;
+    s->parts = parts;
+    s->rows = share_malloc((size_t)len * parts);
+    if (s->rows == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+
+    *share = s;
+    s = NULL;
+end:
+    SHARE_GF8_free(s);
+    return err;
+}
+
+/**
+ * Free the dynamic memory of the object.
+ * The coefficients and y values are cleared as they reveal the secret.
+ *
+ * @param [in] share  The share operation object.
+ */
+void SHARE_GF8_free(SHARE_GF8 *share)
+{
+    if (share != NULL)
+    {
+        if (share->rows != NULL)
+        {
+            share_zeroize(share->rows, (size_t)share->len * share->parts);
+            share_free(share->rows);
+        }
+        share_free(share);
+    }
+}
+
+/**
+ * Get the length of the encoded share: the x byte and the y bytes.
+ *
+ * @param [in]  share  The share operation object.
+ * @param [out] len    The length of the encoded share in bytes.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_get_len(SHARE_GF8 *share, uint32_t *len)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (len == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    *len = share->len + 1;
+end:
+    return err;
+}
+
+/**
+ * Get the number of splits generated or added for joining.
+ *
+ * @param [in]  share  The share operation object.
+ * @param [out] num    The number of splits.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_get_num(SHARE_GF8 *share, uint16_t *num)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (num == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    *num = share->cnt;
+end:
+    return err;
+}
+
+/**
+ * Get the name of the implementation method.
+ *
+ * @param [in]  share  The share operation object.
+ * @param [out] name   The name of the implementation method.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_get_impl_name(SHARE_GF8 *share, char **name)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (name == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    *name = share->meth->name;
+end:
+    return err;
+}
+
+/**
+ * Initialize the generation of splits from the secret.
+ * 
+ * @param [in] share   The share operation object.
+ * @param [in] secret  The data of the secret.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          RANDOM when the random number generator fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_split_init(SHARE_GF8 *share, uint8_t *secret)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (secret == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    /* The first coefficient is the secret and the rest are random. */
+    memcpy(share->rows, secret, share->len);
+    if (pseudo_random(share->rows + share->len,
+        share->len * (share->parts - 1)) != 0)
+    {
+        err = RANDOM;
+        goto end;
+    }
+
+    /* Initialize the count of generated splits. */
+    share->cnt = 0;
+end:
+    return err;
+}
+
+/**
+ * Generate a split for the secret.
+ * The x values are 1, 2, .. 255 in the order the splits are generated: an x
+ * is never repeated.
+ * 
+ * @param [in] share  The share operation object.
+ * @param [in] data   The data of the generated split: x then y bytes.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          FAILED when all 255 x values have been used.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_split(SHARE_GF8 *share, uint8_t *data)
+{
+    SHARE_ERR err = NONE;
+    uint8_t x;
+    int i;
+
+    if ((share == NULL) || (data == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if (share->cnt == 255)
+    {
+        err = FAILED;
+        goto end;
+    }
+
+    /* y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1] */
+    x = share->cnt + 1;
+    share->m[0] = 1;
+    for (i=1; i<share->parts; i++)
+        share->m[i] = share_gf8_mul(share->m[i-1], x);
+    data[0] = x;
+    share->meth->mul_sum(share->rows, share->len, share->parts, share->m,
+        data + 1, share->len);
+
+    share->cnt++;
+end:
+    return err;
+}
+
+/**
+ * Initialize the joining of splits.
+ * 
+ * @param [in] share  The share operation object.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_join_init(SHARE_GF8 *share)
+{
+    SHARE_ERR err = NONE;
+
+    if (share == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    /* Initialize the number of splits stored. */
+    share->cnt = 0;
+end:
+    return err;
+}
+
+/**
+ * Add a split to be joined.
+ * Ignore any splits added beyond the minimum number required.
+ * 
+ * @param [in] share  The share operation object.
+ * @param [in] data   The data of the generated split: x then y bytes.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          INVALID_DATA when the x value is zero.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_join_update(SHARE_GF8 *share, uint8_t *data)
+{
+    SHARE_ERR err = NONE;
+
+    if ((share == NULL) || (data == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    if (share->parts == share->cnt)
+        goto end;
+    if (data[0] == 0)
+    {
+        err = INVALID_DATA;
+        goto end;
+    }
+
+    share->x[share->cnt] = data[0];
+    memcpy(share->rows + (size_t)share->cnt * share->len, data + 1,
+        share->len);
+
+    share->cnt++;
+end:
+    return err;
+}
+
+/**
+ * Calculate the secret from the splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * Subtraction is XOR in GF(2^8).
+ * 
+ * @param [in] share   The share operation object.
+ * @param [in] secret  The data of the secret.
+ * @return  PARAM_NULL when a parameter is NULL.<br>
+ *          INVALID_DATA when the number of splits added is less than the number
+ *          required (parts) or an x value is repeated.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_GF8_join_final(SHARE_GF8 *share, uint8_t *secret)
+{
+    SHARE_ERR err = NONE;
+    uint8_t n, d;
+    int i, j;
+
+    if ((share == NULL) || (secret == NULL))
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+    /* Must have parts number of splits to be able to calcuate secret. */
+    if (share->cnt < share->parts)
+    {
+        err = INVALID_DATA;
+        goto end;
+    }
+
+    /* The Lagrange coefficients at 0 - the x values are public. */
+    for (i=0; i<share->parts; i++)
+    {
+        n = 1;
+        d = 1;
+        for (j=0; j<share->parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            n = share_gf8_mul(n, share->x[j]);
+            d = share_gf8_mul(d, share->x[j] ^ share->x[i]);
+        }
+        if (d == 0)
+        {
+            err = INVALID_DATA;
+            goto end;
+        }
+        share->m[i] = share_gf8_mul(n, share_gf8_inv(d));
+    }
+
+    share->meth->mul_sum(share->rows, share->len, share->parts, share->m,
+        secret, share->len);
+end:
+    return err;
+}
+
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <string.h>
+#include "share_lcl.h"
+
+#ifdef CPU_X86_64
+
+#include <tmmintrin.h>
+
+/**
+ * Multiply rows of bytes by constants in GF(2^8) and sum the products.
+ * The products of each constant with all 16 values of a nibble are put in
+ * tables and looked up with pshufb, 16 bytes at a time.
+ * The constants are public. Bytes beyond the last whole block are handled by
+ * the C implementation.
+ *
+ * @param [in] rows    The rows of bytes.
+ * @param [in] stride  The number of bytes from the start of one row to the
+ *                     next.
+ * @param [in] n       The number of rows.
+ * @param [in] m       The constants to multiply each row by.
+ * @param [in] r       The sum of products.
+ * @param [in] len     The number of bytes in each row and in r.
+ */
+void share_gf8_ssse3_mul_sum(const uint8_t *rows, uint32_t stride, uint8_t n,
+    const uint8_t *m, uint8_t *r, uint32_t len)
+{
+    __m128i lo[256], hi[256];
+    __m128i mask, a, v, l, h;
+    uint8_t t[16];
+    uint32_t i;
+    int j, k;
+
+    /* Tables of products with the low nibble and high nibble. */
+    for (k=0; k<n; k++)
+    {
+        for (j=0; j<16; j++)
+            t[j] = share_gf8_mul(m[k], j);
+        lo[k] = _mm_loadu_si128((__m128i *)t);
+        for (j=0; j<16; j++)
+            t[j] = share_gf8_mul(m[k], j << 4);
+        hi[k] = _mm_loadu_si128((__m128i *)t);
+    }
+    mask = _mm_set1_epi8(0x0f);
+
+    for (i=0; i+16<=len; i+=16)
+    {
+        a = _mm_setzero_si128();
+        for (k=0; k<n; k++)
+        {
+            v = _mm_loadu_si128(
+                (const __m128i *)(rows + (size_t)k * stride + i));
+            l = _mm_shuffle_epi8(lo[k], _mm_and_si128(v, mask));
+            h = _mm_shuffle_epi8(hi[k],
+                _mm_and_si128(_mm_srli_epi64(v, 4), mask));
+            a = _mm_xor_si128(a, _mm_xor_si128(l, h));
+        }
+        _mm_storeu_si128((__m128i *)(r + i), a);
+    }
+    if (i < len)
+        share_gf8_c_mul_sum(rows + i, stride, n, m, r + i, len - i);
+}
+
+#endif
+
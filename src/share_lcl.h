@@ -40,12 +40,14 @@ struct share_st
 {
     /** The methods of an implementation of share operations. */
     SHARE_METH *meth;
+    /** The join function of the implementation to use. */
+    SHARE_JOIN_FUNC *join;
     /** The length of the secret in bytes. */
     uint16_t len;
     /** The mask for the top word. */
     uint8_t mask;
     /** The number of parts required to calculate the secret. */
-    uint8_t parts;
+    uint16_t parts;
     /** The length of the prime in bytes. */
     uint16_t prime_len;
     /** The prime as a number object. */
@@ -58,7 +60,46 @@ struct share_st
     uint8_t *random;
     /** Result number object. */
     void *res;
+    /** An array of x number objects - one for each lane. */
+    void **lx;
+    /** An array of y number objects - one for each lane. */
+    void **ly;
+    /** Scratch space for generating random coefficients, splitting and
+     * joining - allocated once so that these operations don't allocate. */
+    void *scratch;
+    /** The length of the scratch space in bytes. */
+    size_t scratch_len;
+    /** The length of the caller's memory that holds the object and its
+     * numbers. Dynamically allocated: 0. */
+    size_t mem_len;
+    /** The pool the object is returned to. Not pooled: NULL. */
+    void *pool;
+    /** The next object in a list of free objects of the pool. */
+    struct share_st *next;
+    /** Count of splits generated when splitting or added when joining. */
+    int cnt;
+};
+
+/** The data structure for the GF(2^8) share operations object. */
+struct share_gf8_st
+{
+    /** The methods of an implementation of GF(2^8) operations. */
+    SHARE_GF8_METH *meth;
+    /** The length of the secret in bytes. */
+    uint32_t len;
+    /** The number of parts required to calculate the secret. */
+    uint8_t parts;
+    /** The rows of coefficients when splitting and of y values when joining.
+     * Each row is the length of the secret. */
+    uint8_t *rows;
+    /** The x values of the splits added when joining. */
+    uint8_t x[256];
+    /** The constant to multiply each row by. */
+    uint8_t m[256];
     /** Count of splits generated when splitting or added when joining. */
     int cnt;
 };
 
+SHARE_ERR share_scrub(SHARE *share);
+SHARE_ERR share_new_meth(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE_METH *meth, SHARE **share);
@@ -23,46 +23,405 @@
 
 #include <stdlib.h>
 #include "share_meth.h"
+#include "share_tune.h"
 
-/** The implementation methods for share operations. */
+/** An implementation method specialized for a number of parts. */
+#define SHARE_METH_PARTS(name, len, p, flags, cpu, impl, lanes,              \
+                         split_lanes)                                        \
+    { name "/" #p,                                                           \
+      len, p, (flags) | SHARE_METHS_FLAG_PUBLIC_X, cpu,                      \
+      impl##_num_new, impl##_num_free,                                       \
+      impl##_num_from_bin, impl##_num_to_bin,                                \
+      impl##_split_##p, impl##_join_##p,                                     \
+      lanes, split_lanes,                                                    \
+      impl##_num_inv, impl##_join_vt_##p,                                    \
+      impl##_num_from_bin_n, impl##_num_to_bin_n,                            \
+      NULL, NULL, impl##_num_init }
+/** The implementation methods, with extra flags, specialized for each number
+ * of parts that split and join are generated for. */
+#define SHARE_METH_ALL_PARTS_FLAGS(name, len, flags, cpu, impl, lanes,       \
+                                   split_lanes)                              \
+    SHARE_METH_PARTS(name, len, 2, flags, cpu, impl, lanes, split_lanes),    \
+    SHARE_METH_PARTS(name, len, 3, flags, cpu, impl, lanes, split_lanes),    \
+    SHARE_METH_PARTS(name, len, 5, flags, cpu, impl, lanes, split_lanes),    \
+    SHARE_METH_PARTS(name, len, 8, flags, cpu, impl, lanes, split_lanes),    \
+    SHARE_METH_PARTS(name, len, 16, flags, cpu, impl, lanes, split_lanes)
+/** The implementation methods specialized for each number of parts that
+ * split and join are generated for. */
+#define SHARE_METH_ALL_PARTS(name, len, cpu, impl, lanes, split_lanes)       \
+    SHARE_METH_ALL_PARTS_FLAGS(name, len, 0, cpu, impl, lanes, split_lanes)
+
+/** The implementation methods for share operations.
+ * Implementations specialized for a number of parts come before the
+ * implementation that supports any number of parts. */
 SHARE_METH share_meths[] =
 {
+    /* The 60-bit prime optimized implementation. */
+    SHARE_METH_ALL_PARTS("P60 C (" SHARE_P60_TUNE ")", 60, 0,
+        share_p60, 0, NULL),
+    { "P60 C (" SHARE_P60_TUNE ")",
+      60, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_p60_num_new, share_p60_num_free,
+      share_p60_num_from_bin, share_p60_num_to_bin,
+      share_p60_split, share_p60_join,
+      0, NULL,
+      share_p60_num_inv, share_p60_join_vt,
+      share_p60_num_from_bin_n, share_p60_num_to_bin_n,
+      NULL, share_p60_scratch,
+      share_p60_num_init },
+#ifdef CPU_X86_64
+    /* The 126-bit prime BMI2 and ADX implementation. */
+    SHARE_METH_ALL_PARTS("P126 ADX", 126, SHARE_CPU_BMI2_ADX, share_p126_adx,
+        0, NULL),
+    { "P126 ADX",
+      126, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_BMI2_ADX,
+      share_p126_adx_num_new, share_p126_adx_num_free,
+      share_p126_adx_num_from_bin, share_p126_adx_num_to_bin,
+      share_p126_adx_split, share_p126_adx_join,
+      0, NULL,
+      share_p126_adx_num_inv, share_p126_adx_join_vt,
+      share_p126_adx_num_from_bin_n, share_p126_adx_num_to_bin_n,
+      NULL, share_p126_adx_scratch,
+      share_p126_adx_num_init },
+    /* The 126-bit prime AVX2 implementation. */
+    SHARE_METH_ALL_PARTS("P126 AVX2", 126, SHARE_CPU_AVX2, share_p126_avx2,
+        4, share_p126_avx2_split_lanes),
+    { "P126 AVX2",
+      126, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX2,
+      share_p126_avx2_num_new, share_p126_avx2_num_free,
+      share_p126_avx2_num_from_bin, share_p126_avx2_num_to_bin,
+      share_p126_avx2_split, share_p126_avx2_join,
+      4, share_p126_avx2_split_lanes,
+      share_p126_avx2_num_inv, share_p126_avx2_join_vt,
+      share_p126_avx2_num_from_bin_n, share_p126_avx2_num_to_bin_n,
+      NULL, share_p126_avx2_scratch,
+      share_p126_avx2_num_init },
+#endif
     /* The 126-bit prime optimized implementation. */
-    { "P126 C",
-      126, 0, 0,
+    SHARE_METH_ALL_PARTS("P126 C (" SHARE_P126_TUNE ")", 126, 0,
+        share_p126, 0, NULL),
+    { "P126 C (" SHARE_P126_TUNE ")",
+      126, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
       share_p126_num_new, share_p126_num_free,
       share_p126_num_from_bin, share_p126_num_to_bin,
-      share_p126_split, share_p126_join },
+      share_p126_split, share_p126_join,
+      0, NULL,
+      share_p126_num_inv, share_p126_join_vt,
+      share_p126_num_from_bin_n, share_p126_num_to_bin_n,
+      NULL, share_p126_scratch,
+      share_p126_num_init },
+#ifdef CPU_X86_64
+    /* The 128-bit prime BMI2 and ADX implementation. */
+    SHARE_METH_ALL_PARTS("P128 ADX", 128, SHARE_CPU_BMI2_ADX, share_p128_adx,
+        0, NULL),
+    { "P128 ADX",
+      128, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_BMI2_ADX,
+      share_p128_adx_num_new, share_p128_adx_num_free,
+      share_p128_adx_num_from_bin, share_p128_adx_num_to_bin,
+      share_p128_adx_split, share_p128_adx_join,
+      0, NULL,
+      share_p128_adx_num_inv, share_p128_adx_join_vt,
+      share_p128_adx_num_from_bin_n, share_p128_adx_num_to_bin_n,
+      NULL, share_p128_adx_scratch,
+      share_p128_adx_num_init },
+    /* The 128-bit prime AVX2 implementation. */
+    SHARE_METH_ALL_PARTS("P128 AVX2", 128, SHARE_CPU_AVX2, share_p128_avx2,
+        4, share_p128_avx2_split_lanes),
+    { "P128 AVX2",
+      128, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX2,
+      share_p128_avx2_num_new, share_p128_avx2_num_free,
+      share_p128_avx2_num_from_bin, share_p128_avx2_num_to_bin,
+      share_p128_avx2_split, share_p128_avx2_join,
+      4, share_p128_avx2_split_lanes,
+      share_p128_avx2_num_inv, share_p128_avx2_join_vt,
+      share_p128_avx2_num_from_bin_n, share_p128_avx2_num_to_bin_n,
+      NULL, share_p128_avx2_scratch,
+      share_p128_avx2_num_init },
+#endif
     /* The 128-bit prime optimized implementation. */
-    { "P128 C",
-      128, 0, 0,
+    SHARE_METH_ALL_PARTS("P128 C (" SHARE_P128_TUNE ")", 128, 0,
+        share_p128, 0, NULL),
+    { "P128 C (" SHARE_P128_TUNE ")",
+      128, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
       share_p128_num_new, share_p128_num_free,
       share_p128_num_from_bin, share_p128_num_to_bin,
-      share_p128_split, share_p128_join },
+      share_p128_split, share_p128_join,
+      0, NULL,
+      share_p128_num_inv, share_p128_join_vt,
+      share_p128_num_from_bin_n, share_p128_num_to_bin_n,
+      NULL, share_p128_scratch,
+      share_p128_num_init },
+#ifdef CPU_X86_64
+    /* The 192-bit prime AVX-512 IFMA implementation. */
+    SHARE_METH_ALL_PARTS("P192 IFMA", 192, SHARE_CPU_AVX512IFMA, share_p192_ifma,
+        8, share_p192_ifma_split_lanes),
+    { "P192 IFMA",
+      192, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX512IFMA,
+      share_p192_ifma_num_new, share_p192_ifma_num_free,
+      share_p192_ifma_num_from_bin, share_p192_ifma_num_to_bin,
+      share_p192_ifma_split, share_p192_ifma_join,
+      8, share_p192_ifma_split_lanes,
+      share_p192_ifma_num_inv, share_p192_ifma_join_vt,
+      share_p192_ifma_num_from_bin_n, share_p192_ifma_num_to_bin_n,
+      NULL, share_p192_ifma_scratch,
+      share_p192_ifma_num_init },
+    /* The 192-bit prime BMI2 and ADX implementation. */
+    SHARE_METH_ALL_PARTS("P192 ADX", 192, SHARE_CPU_BMI2_ADX, share_p192_adx,
+        0, NULL),
+    { "P192 ADX",
+      192, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_BMI2_ADX,
+      share_p192_adx_num_new, share_p192_adx_num_free,
+      share_p192_adx_num_from_bin, share_p192_adx_num_to_bin,
+      share_p192_adx_split, share_p192_adx_join,
+      0, NULL,
+      share_p192_adx_num_inv, share_p192_adx_join_vt,
+      share_p192_adx_num_from_bin_n, share_p192_adx_num_to_bin_n,
+      NULL, share_p192_adx_scratch,
+      share_p192_adx_num_init },
+    /* The 192-bit prime AVX2 implementation. */
+    SHARE_METH_ALL_PARTS("P192 AVX2", 192, SHARE_CPU_AVX2, share_p192_avx2,
+        4, share_p192_avx2_split_lanes),
+    { "P192 AVX2",
+      192, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX2,
+      share_p192_avx2_num_new, share_p192_avx2_num_free,
+      share_p192_avx2_num_from_bin, share_p192_avx2_num_to_bin,
+      share_p192_avx2_split, share_p192_avx2_join,
+      4, share_p192_avx2_split_lanes,
+      share_p192_avx2_num_inv, share_p192_avx2_join_vt,
+      share_p192_avx2_num_from_bin_n, share_p192_avx2_num_to_bin_n,
+      NULL, share_p192_avx2_scratch,
+      share_p192_avx2_num_init },
+#endif
     /* The 192-bit prime optimized implementation. */
-    { "P192 C",
-      192, 0, 0,
+    SHARE_METH_ALL_PARTS("P192 C (" SHARE_P192_TUNE ")", 192, 0,
+        share_p192, 0, NULL),
+    { "P192 C (" SHARE_P192_TUNE ")",
+      192, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
       share_p192_num_new, share_p192_num_free,
       share_p192_num_from_bin, share_p192_num_to_bin,
-      share_p192_split, share_p192_join },
+      share_p192_split, share_p192_join,
+      0, NULL,
+      share_p192_num_inv, share_p192_join_vt,
+      share_p192_num_from_bin_n, share_p192_num_to_bin_n,
+      NULL, share_p192_scratch,
+      share_p192_num_init },
+    /* The 254-bit prime, 2^255-19, implementation with 51-bit limbs. */
+    SHARE_METH_ALL_PARTS_FLAGS("P254 R51", 254, SHARE_METHS_FLAG_P254, 0,
+        share_p254_r51, 0, NULL),
+    { "P254 R51",
+      254, 0, SHARE_METHS_FLAG_P254 | SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_p254_r51_num_new, share_p254_r51_num_free,
+      share_p254_r51_num_from_bin, share_p254_r51_num_to_bin,
+      share_p254_r51_split, share_p254_r51_join,
+      0, NULL,
+      share_p254_r51_num_inv, share_p254_r51_join_vt,
+      share_p254_r51_num_from_bin_n, share_p254_r51_num_to_bin_n,
+      NULL, share_p254_r51_scratch,
+      share_p254_r51_num_init },
+#ifdef CPU_X86_64
+    /* The 256-bit prime AVX-512 IFMA implementation. */
+    SHARE_METH_ALL_PARTS("P256 IFMA", 256, SHARE_CPU_AVX512IFMA, share_p256_ifma,
+        8, share_p256_ifma_split_lanes),
+    { "P256 IFMA",
+      256, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX512IFMA,
+      share_p256_ifma_num_new, share_p256_ifma_num_free,
+      share_p256_ifma_num_from_bin, share_p256_ifma_num_to_bin,
+      share_p256_ifma_split, share_p256_ifma_join,
+      8, share_p256_ifma_split_lanes,
+      share_p256_ifma_num_inv, share_p256_ifma_join_vt,
+      share_p256_ifma_num_from_bin_n, share_p256_ifma_num_to_bin_n,
+      NULL, share_p256_ifma_scratch,
+      share_p256_ifma_num_init },
+    /* The 256-bit prime BMI2 and ADX implementation. */
+    SHARE_METH_ALL_PARTS("P256 ADX", 256, SHARE_CPU_BMI2_ADX, share_p256_adx,
+        0, NULL),
+    { "P256 ADX",
+      256, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_BMI2_ADX,
+      share_p256_adx_num_new, share_p256_adx_num_free,
+      share_p256_adx_num_from_bin, share_p256_adx_num_to_bin,
+      share_p256_adx_split, share_p256_adx_join,
+      0, NULL,
+      share_p256_adx_num_inv, share_p256_adx_join_vt,
+      share_p256_adx_num_from_bin_n, share_p256_adx_num_to_bin_n,
+      NULL, share_p256_adx_scratch,
+      share_p256_adx_num_init },
+    /* The 256-bit prime AVX2 implementation. */
+    SHARE_METH_ALL_PARTS("P256 AVX2", 256, SHARE_CPU_AVX2, share_p256_avx2,
+        4, share_p256_avx2_split_lanes),
+    { "P256 AVX2",
+      256, 0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_CPU_AVX2,
+      share_p256_avx2_num_new, share_p256_avx2_num_free,
+      share_p256_avx2_num_from_bin, share_p256_avx2_num_to_bin,
+      share_p256_avx2_split, share_p256_avx2_join,
+      4, share_p256_avx2_split_lanes,
+      share_p256_avx2_num_inv, share_p256_avx2_join_vt,
+      share_p256_avx2_num_from_bin_n, share_p256_avx2_num_to_bin_n,
+      NULL, share_p256_avx2_scratch,
+      share_p256_avx2_num_init },
+#endif
     /* The 256-bit prime optimized implementation. */
-    { "P256 C",
-      256, 0, 0,
+    SHARE_METH_ALL_PARTS("P256 C (" SHARE_P256_TUNE ")", 256, 0,
+        share_p256, 0, NULL),
+    { "P256 C (" SHARE_P256_TUNE ")",
+      256, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
       share_p256_num_new, share_p256_num_free,
       share_p256_num_from_bin, share_p256_num_to_bin,
-      share_p256_split, share_p256_join },
+      share_p256_split, share_p256_join,
+      0, NULL,
+      share_p256_num_inv, share_p256_join_vt,
+      share_p256_num_from_bin_n, share_p256_num_to_bin_n,
+      NULL, share_p256_scratch,
+      share_p256_num_init },
+    /* The 384-bit prime optimized implementation. */
+    SHARE_METH_ALL_PARTS("P384 C (" SHARE_P384_TUNE ")", 384, 0,
+        share_p384, 0, NULL),
+    { "P384 C (" SHARE_P384_TUNE ")",
+      384, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_p384_num_new, share_p384_num_free,
+      share_p384_num_from_bin, share_p384_num_to_bin,
+      share_p384_split, share_p384_join,
+      0, NULL,
+      share_p384_num_inv, share_p384_join_vt,
+      share_p384_num_from_bin_n, share_p384_num_to_bin_n,
+      NULL, share_p384_scratch,
+      share_p384_num_init },
+    /* The 520-bit prime optimized implementation. */
+    SHARE_METH_ALL_PARTS("P520 C (" SHARE_P520_TUNE ")", 520, 0,
+        share_p520, 0, NULL),
+    { "P520 C (" SHARE_P520_TUNE ")",
+      520, 0, SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_p520_num_new, share_p520_num_free,
+      share_p520_num_from_bin, share_p520_num_to_bin,
+      share_p520_split, share_p520_join,
+      0, NULL,
+      share_p520_num_inv, share_p520_join_vt,
+      share_p520_num_from_bin_n, share_p520_num_to_bin_n,
+      NULL, share_p520_scratch,
+      share_p520_num_init },
+    /* The 2^64-2^32+1 prime implementation that calculates many splits with a
+     * number-theoretic transform. */
+    { "P64 NTT",
+      63, 0, SHARE_METHS_FLAG_NTT | SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_p64_ntt_num_new, share_p64_ntt_num_free,
+      share_p64_ntt_num_from_bin, share_p64_ntt_num_to_bin,
+      share_p64_ntt_split, share_p64_ntt_join,
+      0, NULL,
+      share_p64_ntt_num_inv, share_p64_ntt_join,
+      share_p64_ntt_num_from_bin_n, share_p64_ntt_num_to_bin_n,
+      share_p64_ntt_split_all, share_p64_ntt_scratch,
+      share_p64_ntt_num_init },
+    /* The n-of-n implementation for secrets of any length: the splits XOR to
+     * the secret. */
+    { "XOR N-of-N",
+      0, 0, SHARE_METHS_FLAG_XOR | SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_xor_num_new, share_xor_num_free,
+      share_xor_num_from_bin, share_xor_num_to_bin,
+      share_xor_split, share_xor_join,
+      0, NULL,
+      NULL, share_xor_join,
+      share_xor_num_from_bin_n, share_xor_num_to_bin_n,
+      share_xor_split_all, share_xor_scratch,
+      share_xor_num_init },
+#ifdef CPU_X86_64
+    /* The GF(2^128) PCLMULQDQ implementation. */
+    { "GF128 CLMUL",
+      128, 0, SHARE_METHS_FLAG_BINARY | SHARE_METHS_FLAG_PUBLIC_X,
+      SHARE_CPU_PCLMUL,
+      share_gf128_num_new, share_gf128_num_free,
+      share_gf128_num_from_bin, share_gf128_num_to_bin,
+      share_gf128_clmul_split, share_gf128_clmul_join,
+      0, NULL,
+      share_gf128_clmul_num_inv, share_gf128_clmul_join,
+      share_gf128_num_from_bin_n, share_gf128_num_to_bin_n,
+      NULL, share_gf128_clmul_scratch,
+      share_gf128_num_init },
+#endif
+    /* The GF(2^128) implementation. */
+    { "GF128 C",
+      128, 0, SHARE_METHS_FLAG_BINARY | SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_gf128_num_new, share_gf128_num_free,
+      share_gf128_num_from_bin, share_gf128_num_to_bin,
+      share_gf128_split, share_gf128_join,
+      0, NULL,
+      share_gf128_num_inv, share_gf128_join,
+      share_gf128_num_from_bin_n, share_gf128_num_to_bin_n,
+      NULL, share_gf128_scratch,
+      share_gf128_num_init },
+    /* The generic implementation with Montgomery multiplication for primes of
+     * up to 4096 bits. */
+    { "Montgomery Generic",
+      4096, 0, SHARE_METHS_FLAG_GENERIC | SHARE_METHS_FLAG_PUBLIC_X, 0,
+      share_mont_num_new, share_mont_num_free,
+      share_mont_num_from_bin, share_mont_num_to_bin,
+      share_mont_split, share_mont_join,
+      0, NULL,
+      share_mont_num_inv, share_mont_join_vt,
+      share_mont_num_from_bin_n, share_mont_num_to_bin_n,
+      NULL, share_mont_scratch,
+      NULL },
 #ifdef SHARE_USE_OPENSSL
     /* The generic implementation that uses OpenSSL. */
     { "OpenSSL Generic",
-      0, 0, SHARE_METHS_FLAG_GENERIC,
+      0, 0, SHARE_METHS_FLAG_GENERIC | SHARE_METHS_FLAG_PUBLIC_X, 0,
       share_openssl_num_new, share_openssl_num_free,
       share_openssl_num_from_bin, share_openssl_num_to_bin,
-      share_openssl_split, share_openssl_join },
+      share_openssl_split, share_openssl_join,
+      0, NULL,
+      share_openssl_num_inv, share_openssl_join,
+      share_openssl_num_from_bin_n, share_openssl_num_to_bin_n,
+      NULL, share_openssl_scratch,
+      NULL },
 #endif
 };
 
 /** The number of implementation methods. */
-#define SHARE_METHS_NUM ((int8_t)(sizeof(share_meths)/(sizeof(*share_meths))))
+#define SHARE_METHS_NUM ((int16_t)(sizeof(share_meths)/(sizeof(*share_meths))))
+
+/** The GF(2^8) implementation methods in order of preference. */
+SHARE_GF8_METH share_gf8_meths[] =
+{
+#ifdef CPU_X86_64
+    /* The AVX2 implementation - 32 bytes at a time with vpshufb. */
+    { "GF8 AVX2", SHARE_CPU_AVX2, share_gf8_avx2_mul_sum },
+    /* The SSSE3 implementation - 16 bytes at a time with pshufb. */
+    { "GF8 SSSE3", SHARE_CPU_SSSE3, share_gf8_ssse3_mul_sum },
+#endif
+    /* The C implementation - 8 bytes at a time in a word. */
+    { "GF8 C", 0, share_gf8_c_mul_sum },
+};
+
+/** The number of GF(2^8) implementation methods. */
+#define SHARE_GF8_METHS_NUM \
+    ((int)(sizeof(share_gf8_meths)/(sizeof(*share_gf8_meths))))
+
+/**
+ * Retrieves the features of the CPU that implementations may require.
+ *
+ * @return  The SHARE_CPU_* flags of the features the CPU supports.
+ */
+uint32_t share_cpu_features(void)
+{
+    uint32_t cpu = 0;
+
+#ifdef CPU_X86_64
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") &&
+        __builtin_cpu_supports("avx512ifma"))
+    {
+        cpu |= SHARE_CPU_AVX512IFMA;
+    }
+    if (__builtin_cpu_supports("avx2"))
+        cpu |= SHARE_CPU_AVX2;
+    if (__builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx"))
+        cpu |= SHARE_CPU_BMI2_ADX;
+    if (__builtin_cpu_supports("ssse3"))
+        cpu |= SHARE_CPU_SSSE3;
+    if (__builtin_cpu_supports("pclmul"))
+        cpu |= SHARE_CPU_PCLMUL;
+#endif
+
+    return cpu;
+}
 
 /**
  * Retrieves an implementation method that matches the requirements.
@@ -75,23 +434,39 @@ SHARE_METH share_meths[] =
  * @return  NOT_FOUND when no available method meets the requirements.<br>
  *          NONE otherwise.
  */
-SHARE_ERR share_meths_get(uint16_t len, uint8_t parts, uint32_t flags,
+SHARE_ERR share_meths_get(uint16_t len, uint16_t parts, uint32_t flags,
     SHARE_METH **meth)
 {
     SHARE_ERR err = NOT_FOUND;
-    int8_t i;
+    int16_t i;
     SHARE_METH *m = NULL;
+    uint32_t cpu = share_cpu_features();
 
     /* Find the first implementation that matches. */
     for (i=0; i<SHARE_METHS_NUM; i++)
     {
-        /* Length of zero indicates no restriction. Otherwise it must match.
+        /* Length of zero indicates no restriction. Otherwise it must match
+         * or, for generic implementations, be at most the length.
          * Parts of zero indicates no restriction. Otherwise it must match.
          * Must have at least the flags requested.
+         * Binary field, number-theoretic transform, XOR and 2^255-19
+         * implementations only when requested.
+         * The CPU must have all the features required.
          */
-        if (((share_meths[i].len == 0) || (share_meths[i].len == len)) &&
+        if (((share_meths[i].len == 0) || (share_meths[i].len == len) ||
+             ((share_meths[i].flags & SHARE_METHS_FLAG_GENERIC) &&
+              (len <= share_meths[i].len))) &&
             ((share_meths[i].parts == 0) || (share_meths[i].parts == parts)) &&
-            ((share_meths[i].flags & flags) == flags))
+            ((share_meths[i].flags & flags) == flags) &&
+            ((share_meths[i].flags & SHARE_METHS_FLAG_BINARY) ==
+             (flags & SHARE_METHS_FLAG_BINARY)) &&
+            ((share_meths[i].flags & SHARE_METHS_FLAG_NTT) ==
+             (flags & SHARE_METHS_FLAG_NTT)) &&
+            ((share_meths[i].flags & SHARE_METHS_FLAG_XOR) ==
+             (flags & SHARE_METHS_FLAG_XOR)) &&
+            ((share_meths[i].flags & SHARE_METHS_FLAG_P254) ==
+             (flags & SHARE_METHS_FLAG_P254)) &&
+            ((share_meths[i].cpu & cpu) == share_meths[i].cpu))
         {
             m = &share_meths[i];
             err = NONE;
@@ -104,3 +479,54 @@ SHARE_ERR share_meths_get(uint16_t len, uint8_t parts, uint32_t flags,
     return err;
 }
 
+/**
+ * Retrieves an implementation method by its index in the list of methods.
+ * Used to test every implementation - the CPU may not support the method.
+ *
+ * @param [in]  idx   The index of the method.
+ * @param [out] meth  The method at the index.
+ * @return  NOT_FOUND when the index is past the end of the list.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_meths_get_idx(int16_t idx, SHARE_METH **meth)
+{
+    SHARE_ERR err = NOT_FOUND;
+
+    *meth = NULL;
+    if ((idx >= 0) && (idx < SHARE_METHS_NUM))
+    {
+        *meth = &share_meths[idx];
+        err = NONE;
+    }
+
+    return err;
+}
+
+/**
+ * Retrieves the fastest GF(2^8) implementation method that the CPU supports.
+ *
+ * @param [out] meth  The method that matches the requirements.
+ * @return  NOT_FOUND when no available method meets the requirements.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_gf8_meths_get(SHARE_GF8_METH **meth)
+{
+    SHARE_ERR err = NOT_FOUND;
+    int i;
+    SHARE_GF8_METH *m = NULL;
+    uint32_t cpu = share_cpu_features();
+
+    for (i=0; i<SHARE_GF8_METHS_NUM; i++)
+    {
+        if ((share_gf8_meths[i].cpu & cpu) == share_gf8_meths[i].cpu)
+        {
+            m = &share_gf8_meths[i];
+            err = NONE;
+            break;
+        }
+    }
+
+    *meth = m;
+
+    return err;
+}
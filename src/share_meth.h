@@ -23,10 +23,21 @@
 
 #include "share.h"
 
+/** CPU feature: AVX-512 Integer Fused Multiply Add (with AVX-512F). */
+#define SHARE_CPU_AVX512IFMA		0x01
+/** CPU feature: AVX2. */
+#define SHARE_CPU_AVX2			0x02
+/** CPU feature: BMI2 and ADX - mulx, adcx and adox instructions. */
+#define SHARE_CPU_BMI2_ADX		0x04
+/** CPU feature: SSSE3 - pshufb instruction. */
+#define SHARE_CPU_SSSE3			0x08
+/** CPU feature: PCLMULQDQ - carry-less multiplication. */
+#define SHARE_CPU_PCLMUL		0x10
+
 /**
  * The prototype of a function that creates a new number object.
  *
- * @param [in]  len  The length of the secret in bytes.
+ * @param [in]  len  The length of the prime in bytes.
  * @param [out] num  The new number object.
  * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
@@ -38,6 +49,18 @@ typedef SHARE_ERR (SHARE_NUM_NEW_FUNC)(uint16_t len, void **num);
  * @param [in] num  The number object.
  */
 typedef void (SHARE_NUM_FREE_FUNC)(void *num);
+/**
+ * The prototype of a function that initializes a number object in memory
+ * provided by the caller. The number object is not freed.
+ *
+ * @param [in]  len   The length of the prime in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL
+ *                    to only get the size.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE on success.
+ */
+typedef SHARE_ERR (SHARE_NUM_INIT_FUNC)(uint16_t len, void *num,
+    size_t *size);
 /**
  * The prototype of a function that decodes data into a number object.
  * The data is assumed to be big-endian bytes.
@@ -62,6 +85,36 @@ typedef SHARE_ERR (SHARE_NUM_FROM_BIN_FUNC)(const uint8_t *data, uint16_t len,
  */
 typedef SHARE_ERR (SHARE_NUM_TO_BIN_FUNC)(void *num, uint8_t *data,
     uint16_t len);
+/**
+ * The prototype of a function that decodes many items of data into number
+ * objects. The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+typedef SHARE_ERR (SHARE_NUM_FROM_BIN_N_FUNC)(const uint8_t *data,
+    uint16_t len, uint16_t step, void **num, uint16_t cnt);
+/**
+ * The prototype of a function that encodes many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+typedef SHARE_ERR (SHARE_NUM_TO_BIN_N_FUNC)(void **num, uint16_t cnt,
+    uint8_t *data, uint16_t len, uint16_t step);
 /**
  * The prototype of a function that calculates the y value of a split.
  * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
@@ -75,36 +128,101 @@ typedef SHARE_ERR (SHARE_NUM_TO_BIN_FUNC)(void *num, uint8_t *data,
  * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
-typedef SHARE_ERR (SHARE_SPLIT_FUNC)(void *prime, uint8_t parts, void **a,
+typedef SHARE_ERR (SHARE_SPLIT_FUNC)(void *prime, uint16_t parts, void **a,
     void *x, void *y);
+/**
+ * The prototype of a function that calculates the y values of a number of
+ * splits at once - one for each lane.
+ * y[k] = x[k]^0.a[0] + x[k]^1.a[1] + ... + x[k]^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The array of x values as number objects - one per lane.
+ * @param [in] y      The array of y values as number objects - one per lane.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+typedef SHARE_ERR (SHARE_SPLIT_LANES_FUNC)(void *prime, uint16_t parts,
+    void **a, void **x, void **y);
 /**
  * The prototype of a function that calculates the secret from splits.
  * secret = sum of (i=0..parts-1) y[i] *
  *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
  *
- * @param [in] prime   The prime as a number object. 
- * @param [in] parts   The number of parts that are required to recalcuate
- *                     secret. 
- * @param [in] x       The array of x values as number objects.
- * @param [in] y       The array of y values as number objects.
- * @param [in] secret  The calculated secret as a number object.
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE on success.
+ */
+typedef SHARE_ERR (SHARE_JOIN_FUNC)(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+/**
+ * The prototype of a function that calculates the inverse of a number modulo
+ * the prime.
+ *
+ * @param [in] prime  The prime as a number object.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
  * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
-typedef SHARE_ERR (SHARE_JOIN_FUNC)(void *prime, uint8_t parts, void **x,
-    void **y, void *secret);
+typedef SHARE_ERR (SHARE_NUM_INV_FUNC)(void *prime, void *a, void *r);
+/**
+ * The prototype of a function that calculates the x and y values of many
+ * splits at once. The implementation chooses the x value of each index of
+ * split so that no two indices have the same x value.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] a        The array of coefficients.
+ * @param [in] first    The index of the first split to calculate.
+ * @param [in] num      The number of splits to calculate.
+ * @param [in] data     The encoded x and y values of the splits.
+ * @param [in] len      The number of bytes in the encoding of an x or a y.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  FAILED when there are no more unique x values.<br>
+ *          NONE otherwise.
+ */
+typedef SHARE_ERR (SHARE_SPLIT_ALL_FUNC)(void *prime, uint16_t parts,
+    void **a, uint32_t first, uint16_t num, uint8_t *data, uint16_t len,
+    void *scratch);
+/**
+ * The prototype of a function that prepares the prime for splitting and
+ * joining, and gets the size of the scratch space that join and split_all
+ * need. The scratch space is allocated once with the share object so that
+ * splitting and joining don't allocate.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+typedef SHARE_ERR (SHARE_SCRATCH_FUNC)(void *prime, uint16_t parts,
+    size_t *size);
 
 /** The data structure of an implementation method. */
 typedef struct share_meth_st
 {
     /** The name of the implementation method. */
     char *name;
-    /** The maximim length of the secret. No maximum: 0. */
+    /** The length of the prime in bits. Generic implementations: the maximum
+     * length of the prime. No maximum: 0. */
     uint16_t len;
     /** The number of parts that the implementation supports. Any: 0. */
-    uint8_t parts;
+    uint16_t parts;
     /** Flags indicating features of implementation. */
     uint32_t flags;
+    /** CPU features required by the implementation. None: 0. */
+    uint32_t cpu;
     /** Creates a new number object. */
     SHARE_NUM_NEW_FUNC *num_new;
     /** Frees a number object. */
@@ -117,50 +235,558 @@ typedef struct share_meth_st
     SHARE_SPLIT_FUNC *split;
     /** Calculates the secret from splits. */
     SHARE_JOIN_FUNC *join;
+    /** The number of splits calculated at once. Not supported: 0. */
+    uint8_t lanes;
+    /** Calculates the y values of lanes number of splits. */
+    SHARE_SPLIT_LANES_FUNC *split_lanes;
+    /** Calculates the inverse of a number modulo the prime. */
+    SHARE_NUM_INV_FUNC *num_inv;
+    /** Calculates the secret from splits with variable time operations on
+     * the public x values. */
+    SHARE_JOIN_FUNC *join_vt;
+    /** Decodes many items of data into number objects. */
+    SHARE_NUM_FROM_BIN_N_FUNC *num_from_bin_n;
+    /** Encodes many number objects into data. */
+    SHARE_NUM_TO_BIN_N_FUNC *num_to_bin_n;
+    /** Calculates the x and y values of splits by index. Random x values: NULL.
+     */
+    SHARE_SPLIT_ALL_FUNC *split_all;
+    /** Prepares the prime and gets the size of the scratch space. No scratch
+     * space: NULL. */
+    SHARE_SCRATCH_FUNC *scratch;
+    /** Initializes a number object in caller memory. Number objects always
+     * allocated: NULL. */
+    SHARE_NUM_INIT_FUNC *num_init;
 } SHARE_METH;
 
-SHARE_ERR share_meths_get(uint16_t len, uint8_t parts, uint32_t flags,
+SHARE_ERR share_meths_get(uint16_t len, uint16_t parts, uint32_t flags,
     SHARE_METH **meth);
+SHARE_ERR share_meths_get_idx(int16_t idx, SHARE_METH **meth);
+uint32_t share_cpu_features(void);
+
+void *share_malloc(size_t size);
+void share_free(void *ptr);
+void share_zeroize(void *ptr, size_t len);
+
+/**
+ * The prototype of a function that multiplies rows of bytes by constants in
+ * GF(2^8) and sums the products.
+ * r = m[0].rows[0] + m[1].rows[1] + ... + m[n-1].rows[n-1]
+ *
+ * @param [in] rows    The rows of bytes.
+ * @param [in] stride  The number of bytes from the start of one row to the
+ *                     next.
+ * @param [in] n       The number of rows.
+ * @param [in] m       The constants to multiply each row by.
+ * @param [in] r       The sum of products.
+ * @param [in] len     The number of bytes in each row and in r.
+ */
+typedef void (SHARE_GF8_MUL_SUM_FUNC)(const uint8_t *rows, uint32_t stride,
+    uint8_t n, const uint8_t *m, uint8_t *r, uint32_t len);
+
+/** The data structure of an implementation method of GF(2^8) operations. */
+typedef struct share_gf8_meth_st
+{
+    /** The name of the implementation method. */
+    char *name;
+    /** The CPU features required by the implementation. */
+    uint32_t cpu;
+    /** Multiplies rows by constants and sums the products. */
+    SHARE_GF8_MUL_SUM_FUNC *mul_sum;
+} SHARE_GF8_METH;
+
+SHARE_ERR share_gf8_meths_get(SHARE_GF8_METH **meth);
+
+/** Declares the split and join functions of an implementation that are
+ * specialized for a number of parts. */
+#define SHARE_METH_PARTS_DECL(impl, p)                                    \
+SHARE_ERR impl##_split_##p(void *prime, uint16_t parts, void **a,          \
+    void *x, void *y);                                                     \
+SHARE_ERR impl##_join_##p(void *prime, uint16_t parts, void **x,           \
+    void **y, void *secret, void *scratch);                                \
+SHARE_ERR impl##_join_vt_##p(void *prime, uint16_t parts, void **x,        \
+    void **y, void *secret, void *scratch);
+/** Declares the functions of an implementation that are specialized for each
+ * number of parts that split and join are generated for. */
+#define SHARE_METH_ALL_PARTS_DECL(impl)                                   \
+    SHARE_METH_PARTS_DECL(impl, 2)                                        \
+    SHARE_METH_PARTS_DECL(impl, 3)                                        \
+    SHARE_METH_PARTS_DECL(impl, 5)                                        \
+    SHARE_METH_PARTS_DECL(impl, 8)                                        \
+    SHARE_METH_PARTS_DECL(impl, 16)
+
+/* The 60-bit secret prime optimized implementation. */
+SHARE_ERR share_p60_num_new(uint16_t len, void **num);
+void share_p60_num_free(void *num);
+SHARE_ERR share_p60_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p60_num_from_bin(const uint8_t *data, uint16_t len, void *num);
+SHARE_ERR share_p60_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p60_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p60_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p60_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p60_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p60_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p60_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p60_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p60)
 
 /* The 126-bit secret prime optimized implementation. */
 SHARE_ERR share_p126_num_new(uint16_t len, void **num);
 void share_p126_num_free(void *num);
+SHARE_ERR share_p126_num_init(uint16_t len, void *num, size_t *size);
 SHARE_ERR share_p126_num_from_bin(const uint8_t *data, uint16_t len, void *num);
 SHARE_ERR share_p126_num_to_bin(void *num, uint8_t *data, uint16_t len);
-SHARE_ERR share_p126_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_p126_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p126_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p126_split(void *prime, uint16_t parts, void **a, void *x,
     void *y);
-SHARE_ERR share_p126_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret);
+SHARE_ERR share_p126_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p126_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p126_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p126_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p126)
 
 /* The 128-bit secret prime optimized implementation. */
 SHARE_ERR share_p128_num_new(uint16_t len, void **num);
 void share_p128_num_free(void *num);
+SHARE_ERR share_p128_num_init(uint16_t len, void *num, size_t *size);
 SHARE_ERR share_p128_num_from_bin(const uint8_t *data, uint16_t len, void *num);
 SHARE_ERR share_p128_num_to_bin(void *num, uint8_t *data, uint16_t len);
-SHARE_ERR share_p128_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_p128_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p128_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p128_split(void *prime, uint16_t parts, void **a, void *x,
     void *y);
-SHARE_ERR share_p128_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret);
+SHARE_ERR share_p128_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p128_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p128_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p128_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p128)
 
 /* The 192-bit secret prime optimized implementation. */
 SHARE_ERR share_p192_num_new(uint16_t len, void **num);
 void share_p192_num_free(void *num);
+SHARE_ERR share_p192_num_init(uint16_t len, void *num, size_t *size);
 SHARE_ERR share_p192_num_from_bin(const uint8_t *data, uint16_t len, void *num);
 SHARE_ERR share_p192_num_to_bin(void *num, uint8_t *data, uint16_t len);
-SHARE_ERR share_p192_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_p192_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p192_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p192_split(void *prime, uint16_t parts, void **a, void *x,
     void *y);
-SHARE_ERR share_p192_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret);
+SHARE_ERR share_p192_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p192_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p192_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p192_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p192)
 
 /* The 256-bit secret prime optimized implementation. */
 SHARE_ERR share_p256_num_new(uint16_t len, void **num);
 void share_p256_num_free(void *num);
+SHARE_ERR share_p256_num_init(uint16_t len, void *num, size_t *size);
 SHARE_ERR share_p256_num_from_bin(const uint8_t *data, uint16_t len, void *num);
 SHARE_ERR share_p256_num_to_bin(void *num, uint8_t *data, uint16_t len);
-SHARE_ERR share_p256_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_p256_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p256_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p256_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p256_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p256_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p256_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p256_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p256)
+
+/* The 254-bit secret prime, 2^255-19, implementation with 51-bit limbs. */
+SHARE_ERR share_p254_r51_num_new(uint16_t len, void **num);
+void share_p254_r51_num_free(void *num);
+SHARE_ERR share_p254_r51_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p254_r51_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p254_r51_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p254_r51_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p254_r51_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p254_r51_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p254_r51_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p254_r51_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p254_r51_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p254_r51_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p254_r51)
+
+/* The 384-bit secret prime optimized implementation. */
+SHARE_ERR share_p384_num_new(uint16_t len, void **num);
+void share_p384_num_free(void *num);
+SHARE_ERR share_p384_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p384_num_from_bin(const uint8_t *data, uint16_t len, void *num);
+SHARE_ERR share_p384_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p384_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p384_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p384_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p384_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p384_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p384_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p384_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p384)
+
+/* The 520-bit secret prime optimized implementation. */
+SHARE_ERR share_p520_num_new(uint16_t len, void **num);
+void share_p520_num_free(void *num);
+SHARE_ERR share_p520_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p520_num_from_bin(const uint8_t *data, uint16_t len, void *num);
+SHARE_ERR share_p520_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p520_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p520_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p520_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p520_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p520_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p520_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p520_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p520)
+
+#ifdef CPU_X86_64
+/* The 126-bit secret prime AVX2 implementation. */
+SHARE_ERR share_p126_avx2_num_new(uint16_t len, void **num);
+void share_p126_avx2_num_free(void *num);
+SHARE_ERR share_p126_avx2_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p126_avx2_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p126_avx2_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p126_avx2_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p126_avx2_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p126_avx2_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p126_avx2_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p126_avx2_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p126_avx2_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p126_avx2_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p126_avx2_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p126_avx2)
+
+/* The 128-bit secret prime AVX2 implementation. */
+SHARE_ERR share_p128_avx2_num_new(uint16_t len, void **num);
+void share_p128_avx2_num_free(void *num);
+SHARE_ERR share_p128_avx2_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p128_avx2_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p128_avx2_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p128_avx2_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p128_avx2_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p128_avx2_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p128_avx2_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p128_avx2_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p128_avx2_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p128_avx2_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p128_avx2_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p128_avx2)
+
+/* The 192-bit secret prime AVX2 implementation. */
+SHARE_ERR share_p192_avx2_num_new(uint16_t len, void **num);
+void share_p192_avx2_num_free(void *num);
+SHARE_ERR share_p192_avx2_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p192_avx2_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p192_avx2_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p192_avx2_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p192_avx2_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p192_avx2_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p192_avx2_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p192_avx2_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p192_avx2_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p192_avx2_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p192_avx2_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p192_avx2)
+
+/* The 256-bit secret prime AVX2 implementation. */
+SHARE_ERR share_p256_avx2_num_new(uint16_t len, void **num);
+void share_p256_avx2_num_free(void *num);
+SHARE_ERR share_p256_avx2_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p256_avx2_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p256_avx2_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p256_avx2_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p256_avx2_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p256_avx2_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p256_avx2_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p256_avx2_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p256_avx2_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p256_avx2_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p256_avx2_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p256_avx2)
+
+/* The 192-bit secret prime AVX-512 IFMA implementation. */
+SHARE_ERR share_p192_ifma_num_new(uint16_t len, void **num);
+void share_p192_ifma_num_free(void *num);
+SHARE_ERR share_p192_ifma_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p192_ifma_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p192_ifma_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p192_ifma_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p192_ifma_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p192_ifma_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p192_ifma_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p192_ifma_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p192_ifma_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p192_ifma_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p192_ifma_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p192_ifma)
+
+/* The 256-bit secret prime AVX-512 IFMA implementation. */
+SHARE_ERR share_p256_ifma_num_new(uint16_t len, void **num);
+void share_p256_ifma_num_free(void *num);
+SHARE_ERR share_p256_ifma_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p256_ifma_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p256_ifma_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p256_ifma_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p256_ifma_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p256_ifma_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p256_ifma_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p256_ifma_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p256_ifma_split_lanes(void *prime, uint16_t parts, void **a,
+    void **x, void **y);
+SHARE_ERR share_p256_ifma_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p256_ifma_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p256_ifma)
+
+/* The 126-bit secret prime BMI2 and ADX implementation. */
+SHARE_ERR share_p126_adx_num_new(uint16_t len, void **num);
+void share_p126_adx_num_free(void *num);
+SHARE_ERR share_p126_adx_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p126_adx_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p126_adx_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p126_adx_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p126_adx_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p126_adx_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p126_adx_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p126_adx_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p126_adx_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p126_adx_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p126_adx)
+
+/* The 128-bit secret prime BMI2 and ADX implementation. */
+SHARE_ERR share_p128_adx_num_new(uint16_t len, void **num);
+void share_p128_adx_num_free(void *num);
+SHARE_ERR share_p128_adx_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p128_adx_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p128_adx_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p128_adx_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p128_adx_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p128_adx_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p128_adx_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p128_adx_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p128_adx_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p128_adx_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p128_adx)
+
+/* The 192-bit secret prime BMI2 and ADX implementation. */
+SHARE_ERR share_p192_adx_num_new(uint16_t len, void **num);
+void share_p192_adx_num_free(void *num);
+SHARE_ERR share_p192_adx_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p192_adx_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p192_adx_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p192_adx_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p192_adx_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p192_adx_split(void *prime, uint16_t parts, void **a, void *x,
     void *y);
-SHARE_ERR share_p256_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret);
+SHARE_ERR share_p192_adx_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p192_adx_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p192_adx_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p192_adx_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p192_adx)
+
+/* The 256-bit secret prime BMI2 and ADX implementation. */
+SHARE_ERR share_p256_adx_num_new(uint16_t len, void **num);
+void share_p256_adx_num_free(void *num);
+SHARE_ERR share_p256_adx_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p256_adx_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p256_adx_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p256_adx_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p256_adx_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p256_adx_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p256_adx_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p256_adx_join_vt(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p256_adx_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p256_adx_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_METH_ALL_PARTS_DECL(share_p256_adx)
+#endif
+
+/* The generic Montgomery implementation. */
+SHARE_ERR share_mont_num_new(uint16_t len, void **num);
+void share_mont_num_free(void *num);
+SHARE_ERR share_mont_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_mont_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_mont_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_mont_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_mont_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_mont_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_mont_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_mont_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_mont_scratch(void *prime, uint16_t parts, size_t *size);
+
+/* The 2^64-2^32+1 prime implementation with a number-theoretic transform. */
+SHARE_ERR share_p64_ntt_num_new(uint16_t len, void **num);
+void share_p64_ntt_num_free(void *num);
+SHARE_ERR share_p64_ntt_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_p64_ntt_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_p64_ntt_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_p64_ntt_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_p64_ntt_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_p64_ntt_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_p64_ntt_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_p64_ntt_join_quad(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p64_ntt_join_fast(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_p64_ntt_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_p64_ntt_scratch(void *prime, uint16_t parts, size_t *size);
+SHARE_ERR share_p64_ntt_split_all(void *prime, uint16_t parts, void **a,
+    uint32_t first, uint16_t num, uint8_t *data, uint16_t len, void *scratch);
+
+/* The n-of-n implementation that XORs the splits. */
+SHARE_ERR share_xor_num_new(uint16_t len, void **num);
+void share_xor_num_free(void *num);
+SHARE_ERR share_xor_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_xor_num_from_bin(const uint8_t *data, uint16_t len, void *num);
+SHARE_ERR share_xor_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_xor_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_xor_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_xor_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_xor_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_xor_split_all(void *prime, uint16_t parts, void **a,
+    uint32_t first, uint16_t num, uint8_t *data, uint16_t len, void *scratch);
+SHARE_ERR share_xor_scratch(void *prime, uint16_t parts, size_t *size);
+void share_xor_bytes(uint8_t *r, const uint8_t *a, size_t n);
+
+/* The GF(2^128) implementations. */
+SHARE_ERR share_gf128_num_new(uint16_t len, void **num);
+void share_gf128_num_free(void *num);
+SHARE_ERR share_gf128_num_init(uint16_t len, void *num, size_t *size);
+SHARE_ERR share_gf128_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num);
+SHARE_ERR share_gf128_num_to_bin(void *num, uint8_t *data, uint16_t len);
+SHARE_ERR share_gf128_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_gf128_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_gf128_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y);
+SHARE_ERR share_gf128_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_gf128_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_gf128_scratch(void *prime, uint16_t parts, size_t *size);
+#ifdef CPU_X86_64
+SHARE_ERR share_gf128_clmul_split(void *prime, uint16_t parts, void **a,
+    void *x, void *y);
+SHARE_ERR share_gf128_clmul_join(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch);
+SHARE_ERR share_gf128_clmul_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_gf128_clmul_scratch(void *prime, uint16_t parts, size_t *size);
+#endif
 
 #ifdef SHARE_USE_OPENSSL
 /* The generic implementation that uses OpenSSL. */
@@ -169,9 +795,25 @@ void share_openssl_num_free(void *num);
 SHARE_ERR share_openssl_num_from_bin(const uint8_t *data, uint16_t len,
     void *num);
 SHARE_ERR share_openssl_num_to_bin(void *num, uint8_t *data, uint16_t len);
-SHARE_ERR share_openssl_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_openssl_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt);
+SHARE_ERR share_openssl_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step);
+SHARE_ERR share_openssl_split(void *prime, uint16_t parts, void **a, void *x,
     void *y);
-SHARE_ERR share_openssl_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret);
+SHARE_ERR share_openssl_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch);
+SHARE_ERR share_openssl_num_inv(void *prime, void *a, void *r);
+SHARE_ERR share_openssl_scratch(void *prime, uint16_t parts, size_t *size);
 #endif
 
+/* The GF(2^8) implementations. */
+uint8_t share_gf8_mul(uint8_t a, uint8_t b);
+void share_gf8_c_mul_sum(const uint8_t *rows, uint32_t stride, uint8_t n,
+    const uint8_t *m, uint8_t *r, uint32_t len);
+#ifdef CPU_X86_64
+void share_gf8_ssse3_mul_sum(const uint8_t *rows, uint32_t stride, uint8_t n,
+    const uint8_t *m, uint8_t *r, uint32_t len);
+void share_gf8_avx2_mul_sum(const uint8_t *rows, uint32_t stride, uint8_t n,
+    const uint8_t *m, uint8_t *r, uint32_t len);
+#endif
@@ -0,0 +1,942 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+/** The maximum number of words in a number: 4096 bits. */
+#define MONT_WORDS_MAX	64
+
+#define U128(w)		((__uint128_t)w)
+
+/** The Montgomery constants of a prime. */
+typedef struct share_mont_ctx_st
+{
+    /** -1 / p mod 2^64 */
+    uint64_t n0;
+    /** R^2 mod p where R = 2^(64.words). */
+    uint64_t r2[MONT_WORDS_MAX];
+    /** R^3 mod p - converts the plain inverse of a Montgomery form number. */
+    uint64_t r3[MONT_WORDS_MAX];
+    /** R mod p - one in Montgomery form. */
+    uint64_t one[MONT_WORDS_MAX];
+    /** p - 2: the exponent that inverts modulo the prime p. */
+    uint64_t e[MONT_WORDS_MAX];
+} SHARE_MONT_CTX;
+
+/** The number object: a fixed number of words. */
+typedef struct share_mont_num_st
+{
+    /** The number of words in the number. */
+    uint16_t words;
+    /** The Montgomery constants when the number is the prime. Calculated on
+     * first use. */
+    SHARE_MONT_CTX *ctx;
+    /** The words of the number - least significant first. */
+    uint64_t d[];
+} SHARE_MONT_NUM;
+
+/**
+ * Multiply a by b in Montgomery form and put the result in r.
+ * r = a.b / R mod p
+ * Coarsely integrated operand scanning (CIOS) with a final subtraction in
+ * constant time.
+ *
+ * @param [in] r   The result of the multiplication.
+ * @param [in] a   The first operand.
+ * @param [in] b   The second operand.
+ * @param [in] p   The prime.
+ * @param [in] n0  -1 / p mod 2^64
+ * @param [in] n   The number of words in the numbers.
+ */
+static void mont_mul(uint64_t *r, uint64_t *a, uint64_t *b, uint64_t *p,
+    uint64_t n0, uint16_t n)
+{
+    uint64_t t[MONT_WORDS_MAX + 2];
+    uint64_t s[MONT_WORDS_MAX];
+    __uint128_t c;
+    uint64_t m, mask;
+    uint16_t i, j;
+
+    memset(t, 0, (n + 2) * sizeof(*t));
+    for (i=0; i<n; i++)
+    {
+        /* t += a.b[i] */
+        c = 0;
+        for (j=0; j<n; j++)
+        {
+            c += U128(a[j]) * b[i] + t[j];
+            t[j] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[n];
+        t[n] = (uint64_t)c;
+        t[n+1] = c >> 64;
+
+        /* t = (t + m.p) / 2^64 */
+        m = t[0] * n0;
+        c = U128(m) * p[0] + t[0];
+        c >>= 64;
+        for (j=1; j<n; j++)
+        {
+            c += U128(m) * p[j] + t[j];
+            t[j-1] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += t[n];
+        t[n-1] = (uint64_t)c;
+        t[n] = t[n+1] + (uint64_t)(c >> 64);
+    }
+
+    /* s = t - p and use s when t >= p. */
+    c = 0;
+    for (j=0; j<n; j++)
+    {
+        c = U128(t[j]) - p[j] - (uint64_t)(c >> 64 ? 1 : 0);
+        s[j] = (uint64_t)c;
+    }
+    mask = 0 - ((uint64_t)(c >> 64 ? 1 : 0) & (t[n] ^ 1));
+    for (j=0; j<n; j++)
+        r[j] = (t[j] & mask) | (s[j] & ~mask);
+}
+
+/**
+ * Square a in Montgomery form and put the result in r.
+ * r = a.a / R mod p
+ * The products of different words are calculated once and doubled. The square
+ * is then reduced a word at a time with a final subtraction in constant time.
+ *
+ * @param [in] r   The result of the squaring.
+ * @param [in] a   The number to square.
+ * @param [in] p   The prime.
+ * @param [in] n0  -1 / p mod 2^64
+ * @param [in] n   The number of words in the numbers.
+ */
+static void mont_sqr(uint64_t *r, uint64_t *a, uint64_t *p, uint64_t n0,
+    uint16_t n)
+{
+    uint64_t t[2 * MONT_WORDS_MAX];
+    uint64_t s[MONT_WORDS_MAX];
+    __uint128_t c, sq;
+    uint64_t m, cc, mask;
+    uint16_t i, j;
+
+    /* t = sum of a[i].a[j].2^(64(i+j)) where i < j */
+    memset(t, 0, 2 * n * sizeof(*t));
+    for (i=0; i<n; i++)
+    {
+        c = 0;
+        for (j=i+1; j<n; j++)
+        {
+            c += U128(a[i]) * a[j] + t[i+j];
+            t[i+j] = (uint64_t)c;
+            c >>= 64;
+        }
+        t[i+n] = (uint64_t)c;
+    }
+    /* t = 2.t + sum of a[i]^2.2^(128i) */
+    for (i=2*n-1; i>0; i--)
+        t[i] = (t[i] << 1) | (t[i-1] >> 63);
+    t[0] <<= 1;
+    c = 0;
+    for (i=0; i<n; i++)
+    {
+        sq = U128(a[i]) * a[i];
+        c += U128(t[2*i]) + (uint64_t)sq;
+        t[2*i] = (uint64_t)c;
+        c >>= 64;
+        c += U128(t[2*i+1]) + (uint64_t)(sq >> 64);
+        t[2*i+1] = (uint64_t)c;
+        c >>= 64;
+    }
+
+    /* t = (t + m.p) / 2^64 for each word. */
+    cc = 0;
+    for (i=0; i<n; i++)
+    {
+        m = t[i] * n0;
+        c = 0;
+        for (j=0; j<n; j++)
+        {
+            c += U128(m) * p[j] + t[i+j];
+            t[i+j] = (uint64_t)c;
+            c >>= 64;
+        }
+        c += U128(t[i+n]) + cc;
+        t[i+n] = (uint64_t)c;
+        cc = (uint64_t)(c >> 64);
+    }
+
+    /* s = t - p and use s when t >= p. */
+    c = 0;
+    for (j=0; j<n; j++)
+    {
+        c = U128(t[n+j]) - p[j] - (uint64_t)(c >> 64 ? 1 : 0);
+        s[j] = (uint64_t)c;
+    }
+    mask = 0 - ((uint64_t)(c >> 64 ? 1 : 0) & (cc ^ 1));
+    for (j=0; j<n; j++)
+        r[j] = (t[n+j] & mask) | (s[j] & ~mask);
+}
+
+/**
+ * Add b to a modulo the prime and put the result in r.
+ * Constant time.
+ *
+ * @param [in] r  The result of the addition.
+ * @param [in] a  The first operand.
+ * @param [in] b  The second operand.
+ * @param [in] p  The prime.
+ * @param [in] n  The number of words in the numbers.
+ */
+static void mont_add(uint64_t *r, uint64_t *a, uint64_t *b, uint64_t *p,
+    uint16_t n)
+{
+    uint64_t t[MONT_WORDS_MAX];
+    uint64_t s[MONT_WORDS_MAX];
+    __uint128_t c = 0, bw = 0;
+    uint64_t mask;
+    uint16_t j;
+
+    for (j=0; j<n; j++)
+    {
+        c += U128(a[j]) + b[j];
+        t[j] = (uint64_t)c;
+        c >>= 64;
+    }
+    for (j=0; j<n; j++)
+    {
+        bw = U128(t[j]) - p[j] - (uint64_t)(bw >> 64 ? 1 : 0);
+        s[j] = (uint64_t)bw;
+    }
+    /* Use the sum when there was no carry out and subtracting borrowed. */
+    mask = 0 - ((uint64_t)(bw >> 64 ? 1 : 0) & ((uint64_t)c ^ 1));
+    for (j=0; j<n; j++)
+        r[j] = (t[j] & mask) | (s[j] & ~mask);
+}
+
+/**
+ * Subtract b from a modulo the prime and put the result in r.
+ * Constant time.
+ *
+ * @param [in] r  The result of the subtraction.
+ * @param [in] a  The number to subtract from.
+ * @param [in] b  The number to subtract.
+ * @param [in] p  The prime.
+ * @param [in] n  The number of words in the numbers.
+ */
+static void mont_sub(uint64_t *r, uint64_t *a, uint64_t *b, uint64_t *p,
+    uint16_t n)
+{
+    __uint128_t c = 0;
+    uint64_t mask;
+    uint16_t j;
+
+    for (j=0; j<n; j++)
+    {
+        c = U128(a[j]) - b[j] - (uint64_t)(c >> 64 ? 1 : 0);
+        r[j] = (uint64_t)c;
+    }
+    /* Add the prime back when subtracting borrowed. */
+    mask = 0 - (uint64_t)(c >> 64 ? 1 : 0);
+    c = 0;
+    for (j=0; j<n; j++)
+    {
+        c += U128(r[j]) + (p[j] & mask);
+        r[j] = (uint64_t)c;
+        c >>= 64;
+    }
+}
+
+/**
+ * Calculate the inverse of a in Montgomery form and put the result in r.
+ * r = a^(p-2) - Fermat's little theorem. Four bits of the exponent at a time.
+ * Constant time as the exponent is public.
+ *
+ * @param [in] r    The result of the inversion.
+ * @param [in] a    The number to invert.
+ * @param [in] p    The prime.
+ * @param [in] ctx  The Montgomery constants of the prime.
+ * @param [in] n    The number of words in the numbers.
+ */
+static void mont_inv(uint64_t *r, uint64_t *a, uint64_t *p,
+    SHARE_MONT_CTX *ctx, uint16_t n)
+{
+    uint64_t w[16][MONT_WORDS_MAX];
+    uint64_t t[MONT_WORDS_MAX];
+    int i, j, b;
+
+    /* w[i] = a^i */
+    memcpy(w[0], ctx->one, n * sizeof(*t));
+    memcpy(w[1], a, n * sizeof(*t));
+    for (i=2; i<16; i++)
+        mont_mul(w[i], w[i-1], a, p, ctx->n0, n);
+
+    /* Skip the leading zero windows of the exponent. */
+    for (i=n*16-1; i>0; i--)
+    {
+        if (((ctx->e[i >> 4] >> ((i & 15) * 4)) & 0xf) != 0)
+            break;
+    }
+    b = (ctx->e[i >> 4] >> ((i & 15) * 4)) & 0xf;
+    memcpy(t, w[b], n * sizeof(*t));
+    for (i--; i>=0; i--)
+    {
+        for (j=0; j<4; j++)
+            mont_sqr(t, t, p, ctx->n0, n);
+        b = (ctx->e[i >> 4] >> ((i & 15) * 4)) & 0xf;
+        mont_mul(t, t, w[b], p, ctx->n0, n);
+    }
+    memcpy(r, t, n * sizeof(*t));
+}
+
+/**
+ * Shift a right by one bit with the top bit, c, shifted in.
+ *
+ * @param [in] a  The number to shift.
+ * @param [in] c  The bit to shift in at the top.
+ * @param [in] n  The number of words in the number.
+ */
+static void mont_rshift1(uint64_t *a, uint64_t c, uint16_t n)
+{
+    uint16_t j;
+
+    for (j=0; j<n-1; j++)
+        a[j] = (a[j] >> 1) | (a[j+1] << 63);
+    a[n-1] = (a[n-1] >> 1) | (c << 63);
+}
+
+/**
+ * Halve a modulo the prime: add the prime when odd and shift.
+ * Variable time.
+ *
+ * @param [in] a  The number to halve.
+ * @param [in] p  The prime.
+ * @param [in] n  The number of words in the numbers.
+ */
+static void mont_half_vt(uint64_t *a, uint64_t *p, uint16_t n)
+{
+    __uint128_t c = 0;
+    uint16_t j;
+
+    if (a[0] & 1)
+    {
+        for (j=0; j<n; j++)
+        {
+            c += U128(a[j]) + p[j];
+            a[j] = (uint64_t)c;
+            c >>= 64;
+        }
+    }
+    mont_rshift1(a, (uint64_t)c, n);
+}
+
+/**
+ * Compare two numbers.
+ * Variable time.
+ *
+ * @param [in] a  The first number.
+ * @param [in] b  The second number.
+ * @param [in] n  The number of words in the numbers.
+ * @return  1 when a is greater than b, -1 when less and 0 when equal.
+ */
+static int mont_cmp_vt(uint64_t *a, uint64_t *b, uint16_t n)
+{
+    int i;
+
+    for (i=n-1; i>=0; i--)
+    {
+        if (a[i] != b[i])
+            return (a[i] > b[i]) ? 1 : -1;
+    }
+    return 0;
+}
+
+/**
+ * Check whether the number is one.
+ * Variable time.
+ *
+ * @param [in] a  The number.
+ * @param [in] n  The number of words in the number.
+ * @return  1 when one and 0 otherwise.
+ */
+static int mont_is_one_vt(uint64_t *a, uint16_t n)
+{
+    uint16_t j;
+
+    if (a[0] != 1)
+        return 0;
+    for (j=1; j<n; j++)
+    {
+        if (a[j] != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Calculate the inverse of a in Montgomery form and put the result in r.
+ * Binary extended Euclidean algorithm on the plain value of a,
+ * (1 / aR) = 1 / (a.R) and then multiplying by R^3 gives the inverse in
+ * Montgomery form. Variable time - only for public values.
+ * The inverse of zero is zero.
+ *
+ * @param [in] r    The result of the inversion.
+ * @param [in] a    The number to invert.
+ * @param [in] p    The prime.
+ * @param [in] ctx  The Montgomery constants of the prime.
+ * @param [in] n    The number of words in the numbers.
+ */
+static void mont_inv_vt(uint64_t *r, uint64_t *a, uint64_t *p,
+    SHARE_MONT_CTX *ctx, uint16_t n)
+{
+    uint64_t u[MONT_WORDS_MAX], v[MONT_WORDS_MAX];
+    uint64_t x1[MONT_WORDS_MAX], x2[MONT_WORDS_MAX];
+    uint16_t j;
+
+    memcpy(u, a, n * sizeof(*u));
+    memcpy(v, p, n * sizeof(*v));
+    memset(x1, 0, n * sizeof(*x1));
+    memset(x2, 0, n * sizeof(*x2));
+    x1[0] = 1;
+
+    for (j=0; (j<n) && (u[j] == 0); j++)
+        ;
+    if (j == n)
+    {
+        memset(r, 0, n * sizeof(*r));
+        return;
+    }
+
+    /* Invariants: u = a.x1 mod p and v = a.x2 mod p */
+    while (!mont_is_one_vt(u, n) && !mont_is_one_vt(v, n))
+    {
+        while ((u[0] & 1) == 0)
+        {
+            mont_rshift1(u, 0, n);
+            mont_half_vt(x1, p, n);
+        }
+        while ((v[0] & 1) == 0)
+        {
+            mont_rshift1(v, 0, n);
+            mont_half_vt(x2, p, n);
+        }
+        if (mont_cmp_vt(u, v, n) >= 0)
+        {
+            mont_sub(u, u, v, p, n);
+            mont_sub(x1, x1, x2, p, n);
+        }
+        else
+        {
+            mont_sub(v, v, u, p, n);
+            mont_sub(x2, x2, x1, p, n);
+        }
+    }
+
+    if (mont_is_one_vt(u, n))
+        mont_mul(r, x1, ctx->r3, p, ctx->n0, n);
+    else
+        mont_mul(r, x2, ctx->r3, p, ctx->n0, n);
+}
+
+/**
+ * Get the Montgomery constants of the prime, calculating them on first use.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [out] ctx    The Montgomery constants.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+static SHARE_ERR mont_ctx_get(SHARE_MONT_NUM *prime, SHARE_MONT_CTX **ctx)
+{
+    SHARE_ERR err = NONE;
+    SHARE_MONT_CTX *c = prime->ctx;
+    uint64_t *p = prime->d;
+    uint16_t n = prime->words;
+    uint64_t inv;
+    __uint128_t bw;
+    int i;
+
+    if (c != NULL)
+        goto end;
+
+    c = share_malloc(sizeof(*c));
+    if (c == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    memset(c, 0, sizeof(*c));
+
+    /* inv = 1 / p[0] mod 2^64 - Newton's method doubles the bits each step.
+     */
+    inv = p[0];
+    for (i=0; i<5; i++)
+        inv *= 2 - p[0] * inv;
+    c->n0 = 0 - inv;
+
+    /* R^2 mod p by doubling 1 modulo p 2.64.n times. */
+    c->r2[0] = 1;
+    for (i=0; i<2*64*n; i++)
+        mont_add(c->r2, c->r2, c->r2, p, n);
+    mont_mul(c->r3, c->r2, c->r2, p, c->n0, n);
+    memset(c->e, 0, n * sizeof(*c->e));
+    c->e[0] = 1;
+    mont_mul(c->one, c->e, c->r2, p, c->n0, n);
+
+    /* e = p - 2 */
+    bw = 2;
+    for (i=0; i<n; i++)
+    {
+        bw = U128(p[i]) - (uint64_t)bw;
+        c->e[i] = (uint64_t)bw;
+        bw = (bw >> 64) ? 1 : 0;
+    }
+
+    prime->ctx = c;
+end:
+    *ctx = c;
+    return err;
+}
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the prime in bytes.
+ * @param [out] num  The new number object.
+ * @return  PARAM_BAD_LEN when the length is more than 4096 bits.<br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+    SHARE_MONT_NUM *a;
+    uint16_t words = (len + 7) / 8;
+
+    if ((words == 0) || (words > MONT_WORDS_MAX))
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    a = share_malloc(sizeof(*a) + words * sizeof(uint64_t));
+    if (a == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    a->words = words;
+    a->ctx = NULL;
+    *num = a;
+end:
+    return err;
+}
+
+/**
+ * Free the dynamic memory associated with the number object.
+ *
+ * @param [in] num  The number object.
+ */
+void share_mont_num_free(void *num)
+{
+    SHARE_MONT_NUM *a = num;
+
+    if (a != NULL)
+    {
+        if (a->ctx != NULL) share_free(a->ctx);
+        share_free(a);
+    }
+}
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num)
+{
+    SHARE_ERR err = NONE;
+    SHARE_MONT_NUM *a = num;
+    uint16_t i;
+
+    if (len > a->words * 8)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    memset(a->d, 0, a->words * sizeof(*a->d));
+    for (i=0; i<len; i++)
+        a->d[i / 8] |= (uint64_t)data[len - 1 - i] << ((i % 8) * 8);
+
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_mont_num_from_bin(data + i * step, len, num[i]);
+
+    return err;
+}
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+    SHARE_MONT_NUM *a = num;
+    uint64_t o = 0;
+    uint16_t i;
+
+    /* Longer data is padded on the left with zeros. */
+    for (i=0; i<len; i++)
+    {
+        if (i < a->words * 8)
+            data[len - 1 - i] = a->d[i / 8] >> ((i % 8) * 8);
+        else
+            data[len - 1 - i] = 0;
+    }
+    /* The bytes that don't fit must be zero. */
+    for (; i<a->words*8; i++)
+        o |= (a->d[i / 8] >> ((i % 8) * 8)) & 0xff;
+    if (o != 0)
+        err = PARAM_BAD_LEN;
+
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_mont_num_to_bin(num[i], data + i * step, len);
+
+    return err;
+}
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ * x is converted to Montgomery form so that multiplying by it leaves y in
+ * normal form.
+ *
+ * @param [in] prime  The prime as a number object. 
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    SHARE_ERR err;
+    SHARE_MONT_CTX *ctx;
+    SHARE_MONT_NUM *pn = prime;
+    SHARE_MONT_NUM **an = (SHARE_MONT_NUM **)a;
+    SHARE_MONT_NUM *xn = x;
+    SHARE_MONT_NUM *yn = y;
+    uint64_t *p = pn->d;
+    uint16_t n = pn->words;
+    uint64_t xm[MONT_WORDS_MAX];
+    int16_t i;
+
+    err = mont_ctx_get(pn, &ctx);
+    if (err != NONE) goto end;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    mont_mul(xm, xn->d, ctx->r2, p, ctx->n0, n);
+    memcpy(yn->d, an[parts-1]->d, n * sizeof(*xm));
+    for (i=parts-2; i>=0; i--)
+    {
+        mont_mul(yn->d, yn->d, xm, p, ctx->n0, n);
+        mont_add(yn->d, yn->d, an[i]->d, p, n);
+    }
+
+end:
+    return err;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The denominators are inverted together with one inversion.
+ * The x values in Montgomery form, the products of denominators and the
+ * denominators are kept in the scratch space.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @param [in] vt       Whether to invert in variable time.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+static SHARE_ERR mont_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch, int vt)
+{
+    SHARE_ERR err;
+    SHARE_MONT_CTX *ctx;
+    SHARE_MONT_NUM *pn = prime;
+    SHARE_MONT_NUM **xn = (SHARE_MONT_NUM **)x;
+    SHARE_MONT_NUM **yn = (SHARE_MONT_NUM **)y;
+    SHARE_MONT_NUM *sn = secret;
+    uint64_t *p = pn->d;
+    uint16_t n = pn->words;
+    uint64_t np[MONT_WORDS_MAX], t[MONT_WORDS_MAX], inv[MONT_WORDS_MAX];
+    uint64_t sum[MONT_WORDS_MAX];
+    uint64_t *xr = scratch;
+    uint64_t *cr = xr + n * parts;
+    uint64_t *dr = cr + n * parts;
+    uint64_t *c, *d;
+    uint16_t i, j;
+
+    err = mont_ctx_get(pn, &ctx);
+    if (err != NONE) goto end;
+
+    /* Convert x values to Montgomery form. */
+    for (i=0; i<parts; i++)
+        mont_mul(&xr[i*n], xn[i]->d, ctx->r2, p, ctx->n0, n);
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    memcpy(np, xr, n * sizeof(*np));
+    for (i=1; i<parts; i++)
+        mont_mul(np, np, &xr[i*n], p, ctx->n0, n);
+
+    /* Calculate all the denominators. */
+    for (i=0; i<parts; i++)
+    {
+        /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
+        d = &dr[i*n];
+        memcpy(d, &xr[i*n], n * sizeof(*d));
+        for (j=0; j<parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            mont_sub(t, &xr[j*n], &xr[i*n], p, n);
+            mont_mul(d, d, t, p, ctx->n0, n);
+        }
+    }
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    for (i=0; i<parts; i++)
+    {
+        c = &cr[i*n];
+        d = &dr[i*n];
+        if (i == 0)
+            memcpy(c, d, n * sizeof(*c));
+        else
+            mont_mul(c, c - n, d, p, ctx->n0, n);
+    }
+    /* inv = 1 / c[parts-1] */
+    if (vt)
+        mont_inv_vt(inv, &cr[(parts-1)*n], p, ctx, n);
+    else
+        mont_inv(inv, &cr[(parts-1)*n], p, ctx, n);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     * The y values are in normal form so the sum is too.
+     */
+    memset(sum, 0, n * sizeof(*sum));
+    for (i=parts-1; i>0; i--)
+    {
+        mont_mul(t, inv, &cr[(i-1)*n], p, ctx->n0, n);
+        mont_mul(inv, inv, &dr[i*n], p, ctx->n0, n);
+        mont_mul(t, t, yn[i]->d, p, ctx->n0, n);
+        mont_add(sum, sum, t, p, n);
+    }
+    mont_mul(t, inv, yn[0]->d, p, ctx->n0, n);
+    mont_add(sum, sum, t, p, n);
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    mont_mul(sn->d, np, sum, p, ctx->n0, n);
+
+end:
+    return err;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch)
+{
+    return mont_join(prime, parts, x, y, secret, scratch, 0);
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The x values are public: the denominators are inverted in variable time.
+ *
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_join_vt(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch)
+{
+    return mont_join(prime, parts, x, y, secret, scratch, 1);
+}
+
+/**
+ * Calculate the inverse of a number modulo the prime.
+ *
+ * @param [in] prime  The prime as a number object.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_num_inv(void *prime, void *a, void *r)
+{
+    SHARE_ERR err;
+    SHARE_MONT_CTX *ctx;
+    SHARE_MONT_NUM *pn = prime;
+    SHARE_MONT_NUM *an = a;
+    SHARE_MONT_NUM *rn = r;
+    uint64_t *p = pn->d;
+    uint16_t n = pn->words;
+    uint64_t t[MONT_WORDS_MAX];
+
+    err = mont_ctx_get(pn, &ctx);
+    if (err != NONE) goto end;
+
+    /* Convert to Montgomery form, invert and convert back. */
+    mont_mul(t, an->d, ctx->r2, p, ctx->n0, n);
+    mont_inv(t, t, p, ctx, n);
+    memset(rn->d, 0, n * sizeof(*t));
+    rn->d[0] = 1;
+    mont_mul(rn->d, t, rn->d, p, ctx->n0, n);
+
+end:
+    return err;
+}
+
+/**
+ * Calculate the Montgomery constants of the prime and get the size of the
+ * scratch space that join needs.
+ * The x values in Montgomery form, the products of denominators and the
+ * denominators are kept in the scratch space.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_mont_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    SHARE_ERR err;
+    SHARE_MONT_CTX *ctx;
+    SHARE_MONT_NUM *pn = prime;
+
+    /* Calculate now so that splitting and joining don't allocate. */
+    err = mont_ctx_get(pn, &ctx);
+    if (err != NONE) goto end;
+
+    *size = 3 * pn->words * parts * sizeof(uint64_t);
+
+end:
+    return err;
+}
@@ -25,6 +25,66 @@
 #include "share_meth.h"
 #include "openssl/bn.h"
 
+/** The context of the prime: kept between operations. */
+typedef struct share_openssl_ctx_st
+{
+    /** The temporary numbers of operations. */
+    BN_CTX *bn_ctx;
+    /** The Montgomery constants of the prime. */
+    BN_MONT_CTX *mont;
+} SHARE_OPENSSL_CTX;
+
+/** The number object: an OpenSSL number. */
+typedef struct share_openssl_num_st
+{
+    /** The OpenSSL number. */
+    BIGNUM *bn;
+    /** The context when the number is the prime. Created on first use. */
+    SHARE_OPENSSL_CTX *ctx;
+} SHARE_OPENSSL_NUM;
+
+/**
+ * Get the context of the prime, creating it on first use.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [out] ctx    The context of the prime.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+static SHARE_ERR openssl_ctx_get(SHARE_OPENSSL_NUM *prime,
+    SHARE_OPENSSL_CTX **ctx)
+{
+    SHARE_ERR err = NONE;
+    SHARE_OPENSSL_CTX *c = prime->ctx;
+
+    if (c != NULL)
+        goto end;
+
+    c = share_malloc(sizeof(*c));
+    if (c == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    c->bn_ctx = BN_CTX_new();
+    c->mont = BN_MONT_CTX_new();
+    if ((c->bn_ctx == NULL) || (c->mont == NULL) ||
+        (BN_MONT_CTX_set(c->mont, prime->bn, c->bn_ctx) == 0))
+    {
+        BN_MONT_CTX_free(c->mont);
+        BN_CTX_free(c->bn_ctx);
+        share_free(c);
+        c = NULL;
+        err = ALLOC;
+        goto end;
+    }
+
+    prime->ctx = c;
+end:
+    *ctx = c;
+    return err;
+}
+
 /**
  * Create a new number object.
  *
@@ -36,13 +96,26 @@
 SHARE_ERR share_openssl_num_new(uint16_t len, void **num)
 {
     SHARE_ERR err = NONE;
+    SHARE_OPENSSL_NUM *a;
 
     len = len;
 
-    *num = BN_new();
-    if (*num == NULL)
+    a = share_malloc(sizeof(*a));
+    if (a == NULL)
+    {
         err = ALLOC;
-
+        goto end;
+    }
+    a->bn = BN_new();
+    if (a->bn == NULL)
+    {
+        share_free(a);
+        err = ALLOC;
+        goto end;
+    }
+    a->ctx = NULL;
+    *num = a;
+end:
     return err;
 }
 
@@ -53,7 +126,19 @@ SHARE_ERR share_openssl_num_new(uint16_t len, void **num)
  */
 void share_openssl_num_free(void *num)
 {
-    BN_free(num);
+    SHARE_OPENSSL_NUM *a = num;
+
+    if (a != NULL)
+    {
+        if (a->ctx != NULL)
+        {
+            BN_MONT_CTX_free(a->ctx->mont);
+            BN_CTX_free(a->ctx->bn_ctx);
+            share_free(a->ctx);
+        }
+        BN_free(a->bn);
+        share_free(a);
+    }
 }
 
 /**
@@ -71,7 +156,7 @@ SHARE_ERR share_openssl_num_from_bin(const uint8_t *data, uint16_t len,
 {
     SHARE_ERR err = NONE;
 
-    if (BN_bin2bn(data, len, num) == NULL)
+    if (BN_bin2bn(data, len, ((SHARE_OPENSSL_NUM *)num)->bn) == NULL)
         err = ALLOC;
 
     return err;
@@ -91,12 +176,62 @@ SHARE_ERR share_openssl_num_to_bin(void *num, uint8_t *data, uint16_t len)
 {
     SHARE_ERR err = NONE;
 
-    if (BN_bn2binpad(num, data, len) == -1)
+    if (BN_bn2binpad(((SHARE_OPENSSL_NUM *)num)->bn, data, len) == -1)
         err = PARAM_BAD_LEN;
 
     return err;
 }
 
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_openssl_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_openssl_num_from_bin(data + i * step, len, num[i]);
+
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_openssl_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_openssl_num_to_bin(num[i], data + i * step, len);
+
+    return err;
+}
+
 /**
  * Calculate the y value of a split.
  * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
@@ -110,45 +245,56 @@ SHARE_ERR share_openssl_num_to_bin(void *num, uint8_t *data, uint16_t len)
  * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
-SHARE_ERR share_openssl_split(void *prime, uint8_t parts, void **a, void *x,
+SHARE_ERR share_openssl_split(void *prime, uint16_t parts, void **a, void *x,
     void *y)
 {
-    SHARE_ERR err = ALLOC;
+    SHARE_ERR err;
     int ret = 1;
     int i;
-    BN_CTX *ctx;
-    BIGNUM *t, *m;
+    SHARE_OPENSSL_NUM *pn = prime;
+    SHARE_OPENSSL_CTX *ctx;
+    BIGNUM *p = pn->bn;
+    BIGNUM *yn = ((SHARE_OPENSSL_NUM *)y)->bn;
+    BIGNUM *t, *m, *xm;
 
-    ctx = BN_CTX_new();
-    t = BN_new();
-    m = BN_new();
-    if ((ctx == NULL) || (t == NULL) || (m == NULL))
+    err = openssl_ctx_get(pn, &ctx);
+    if (err != NONE)
         goto end;
+    err = ALLOC;
+
+    BN_CTX_start(ctx->bn_ctx);
+    t = BN_CTX_get(ctx->bn_ctx);
+    m = BN_CTX_get(ctx->bn_ctx);
+    xm = BN_CTX_get(ctx->bn_ctx);
+    if (xm == NULL)
+        goto end_ctx;
+
+    /* Only x is in Montgomery form so the products with the coefficients are
+     * not. */
+    ret &= BN_to_montgomery(xm, ((SHARE_OPENSSL_NUM *)x)->bn, ctx->mont,
+        ctx->bn_ctx);
 
     /* y = x^0.a[0] + x^1.a[1] - minimum of two parts. */
-    ret &= BN_mod_mul(t, a[1], x, prime, ctx);
-    ret &= BN_add(y, a[0], t);
-    if (BN_cmp(y, prime) >= 0)
-        ret &= BN_sub(y, y, prime);
+    ret &= BN_mod_mul_montgomery(t, ((SHARE_OPENSSL_NUM *)a[1])->bn, xm,
+        ctx->mont, ctx->bn_ctx);
+    ret &= BN_mod_add_quick(yn, ((SHARE_OPENSSL_NUM *)a[0])->bn, t, p);
 
-    ret &= (BN_copy(m, x) != NULL);
+    ret &= (BN_copy(m, xm) != NULL);
     for (i=2; i<parts; i++)
     {
-        /* y += x^i.a[i] (m = x^i) */
-        ret &= BN_mod_mul(m, m, x, prime, ctx);
-        ret &= BN_mod_mul(t, a[i], m, prime, ctx);
-        ret &= BN_add(y, y, t);
-        if (BN_cmp(y, prime) >= 0)
-            ret &= BN_sub(y, y, prime);
+        /* y += x^i.a[i] (m = x^i in Montgomery form) */
+        ret &= BN_mod_mul_montgomery(m, m, xm, ctx->mont, ctx->bn_ctx);
+        ret &= BN_mod_mul_montgomery(t, ((SHARE_OPENSSL_NUM *)a[i])->bn, m,
+            ctx->mont, ctx->bn_ctx);
+        ret &= BN_mod_add_quick(yn, yn, t, p);
     }
 
     /* No error if all operations succeeded. */
     if (ret == 1)
         err = NONE;
+end_ctx:
+    BN_CTX_end(ctx->bn_ctx);
 end:
-    BN_free(m);
-    BN_free(t);
-    BN_CTX_free(ctx);
     return err;
 }
 
@@ -156,115 +302,180 @@ end:
  * Calculate the secret from splits.
  * secret = sum of (i=0..parts-1) y[i] *
  *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * The denominators are inverted together with one inversion.
  *
- * @param [in] prime   The prime as a number object. 
- * @param [in] parts   The number of parts that are required to recalcuate
- *                     secret. 
- * @param [in] x       The array of x values as number objects.
- * @param [in] y       The array of y values as number objects.
- * @param [in] secret  The calculated secret as a number object.
+ * @param [in] prime    The prime as a number object.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used - temporaries are kept by the BN_CTX.
  * @return  ALLOC when dynamic memory allocation fails.<br>
  *          NONE otherwise.
  */
-SHARE_ERR share_openssl_join(void *prime, uint8_t parts, void **x, void **y,
-    void *secret)
+SHARE_ERR share_openssl_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch)
 {
-    SHARE_ERR err = ALLOC;
+    SHARE_ERR err;
     int ret = 1;
     int i, j;
-    BN_CTX *ctx;
-    BIGNUM *np, *t;
-    BIGNUM **n = NULL, **d = NULL;
-
-    ctx = BN_CTX_new();
-    np = BN_new();
-    t = BN_new();
-    if ((ctx == NULL) || (np == NULL) || (t == NULL))
-        goto end;
+    SHARE_OPENSSL_NUM *pn = prime;
+    SHARE_OPENSSL_CTX *ctx;
+    BN_MONT_CTX *mont;
+    BN_CTX *bn_ctx;
+    BIGNUM *p = pn->bn;
+    BIGNUM *np, *t, *inv, *sum;
+    BIGNUM *xm[SHARE_PARTS_MAX] = { NULL };
+    BIGNUM *c[SHARE_PARTS_MAX] = { NULL };
+    BIGNUM *d[SHARE_PARTS_MAX] = { NULL };
+
+    scratch = scratch;
 
-    /* Arrays of numerators and denominators as number objects. */
-    n = malloc(parts * sizeof(*n));
-    d = malloc(parts * sizeof(*d));
-    if ((n == NULL) || (d == NULL))
+    err = openssl_ctx_get(pn, &ctx);
+    if (err != NONE)
         goto end;
+    err = ALLOC;
+    mont = ctx->mont;
+    bn_ctx = ctx->bn_ctx;
+
+    /* The temporaries are kept by the context between calls. */
+    BN_CTX_start(bn_ctx);
+    np = BN_CTX_get(bn_ctx);
+    t = BN_CTX_get(bn_ctx);
+    inv = BN_CTX_get(bn_ctx);
+    sum = BN_CTX_get(bn_ctx);
     for (i=0; i<parts; i++)
     {
-        n[i] = BN_new();
-        d[i] = BN_new();
-        if ((n[i] == NULL) || (d[i] == NULL))
-            goto end;
+        xm[i] = BN_CTX_get(bn_ctx);
+        c[i] = BN_CTX_get(bn_ctx);
+        d[i] = BN_CTX_get(bn_ctx);
     }
+    if (BN_CTX_get(bn_ctx) == NULL)
+        goto end_ctx;
+
+    /* The x values, denominators and products are in Montgomery form.
+     * The y values and sum are not. */
+    for (i=0; i<parts; i++)
+        ret &= BN_to_montgomery(xm[i], ((SHARE_OPENSSL_NUM *)x[i])->bn, mont,
+            bn_ctx);
 
     /* np = x[0] * x[1] * .. * x[parts-1] */
-    ret &= (BN_copy(np, x[0]) != NULL);
+    ret &= (BN_copy(np, xm[0]) != NULL);
     for (i=1; i<parts; i++)
-        ret &= BN_mod_mul(np, np, x[i], prime, ctx);
+        ret &= BN_mod_mul_montgomery(np, np, xm[i], mont, bn_ctx);
 
     /* Calculate all the denominators. */
     for (i=0; i<parts; i++)
     {
         /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
-        ret &= BN_set_word(d[i], 1);
+        ret &= (BN_copy(d[i], xm[i]) != NULL);
         for (j=0; j<parts; j++)
         {
             if (i == j)
                 continue;
 
-            ret &= BN_sub(t, x[j], x[i]);
-            ret &= BN_mod_mul(d[i], d[i], t, prime, ctx);
+            ret &= BN_mod_sub_quick(t, xm[j], xm[i], p);
+            ret &= BN_mod_mul_montgomery(d[i], d[i], t, mont, bn_ctx);
         }
-        /* Ensure positive for inversion. */
-        if (BN_is_negative(d[i]))
-            ret &= BN_add(d[i], d[i], prime);
-        ret &= BN_mod_mul(d[i], d[i], x[i], prime, ctx);
 
-        /* n[i] = y[i].np (as x[i] is multiplied into denominator) */
-        ret &= BN_mod_mul(n[i], np, y[i], prime, ctx);
+        /* c[i] = d[0] * d[1] * .. * d[i] */
+        if (i == 0)
+            ret &= (BN_copy(c[i], d[i]) != NULL);
+        else
+            ret &= BN_mod_mul_montgomery(c[i], c[i-1], d[i], mont, bn_ctx);
     }
 
-    /* Convert numerators to common denominator and sum. */
-    for (i=0; i<parts; i++)
+    /* inv = 1 / c[parts-1] */
+    ret &= BN_from_montgomery(t, c[parts-1], mont, bn_ctx);
+    ret &= (BN_mod_inverse(inv, t, p, bn_ctx) != NULL);
+    ret &= BN_to_montgomery(inv, inv, mont, bn_ctx);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    BN_zero(sum);
+    for (i=parts-1; i>=0; i--)
     {
-        for (j=0; j<parts; j++)
-        {
-            if (i == j)
-                continue;
-            ret &= BN_mod_mul(n[i], n[i], d[j], prime, ctx);
-        }
         if (i > 0)
         {
-            ret &= BN_add(n[0], n[0], n[i]);
-            if (BN_cmp(n[0], prime) >= 0)
-                ret &= BN_sub(n[0], n[0], prime);
+            ret &= BN_mod_mul_montgomery(t, inv, c[i-1], mont, bn_ctx);
+            ret &= BN_mod_mul_montgomery(inv, inv, d[i], mont, bn_ctx);
+            ret &= BN_mod_mul_montgomery(t, t, ((SHARE_OPENSSL_NUM *)y[i])->bn,
+                mont, bn_ctx);
         }
+        else
+            ret &= BN_mod_mul_montgomery(t, inv,
+                ((SHARE_OPENSSL_NUM *)y[i])->bn, mont, bn_ctx);
+        ret &= BN_mod_add_quick(sum, sum, t, p);
     }
-    /* Common denominator is product of all denominators. */
-    for (i=1; i<parts; i++)
-        ret &= BN_mod_mul(d[0], d[0], d[i], prime, ctx);
 
-    /* secret = inverse denominator * sum of numerators. */
-    ret &= (BN_mod_inverse(t, d[0], prime, ctx) != NULL);
-    ret &= BN_mod_mul(secret, t, n[0], prime, ctx);
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    ret &= BN_mod_mul_montgomery(((SHARE_OPENSSL_NUM *)secret)->bn, np, sum,
+        mont, bn_ctx);
 
     /* No error if all operations succeeded. */
     if (ret == 1)
         err = NONE;
+end_ctx:
+    BN_CTX_end(bn_ctx);
 end:
-    if (d != NULL)
-    {
-        for (i=parts-1; i>=0; i--)
-            BN_free(d[i]);
-        free(d);
-    }
-    if (n != NULL)
-    {
-        for (i=parts-1; i>=0; i--)
-            BN_free(n[i]);
-        free(n);
-    }
-    BN_free(t);
-    BN_free(np);
-    BN_CTX_free(ctx);
     return err;
 }
 
+
+/**
+ * Calculate the inverse of a number modulo the prime.
+ *
+ * @param [in] prime  The prime as a number object.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_openssl_num_inv(void *prime, void *a, void *r)
+{
+    SHARE_ERR err;
+    SHARE_OPENSSL_NUM *pn = prime;
+    SHARE_OPENSSL_CTX *ctx;
+
+    err = openssl_ctx_get(pn, &ctx);
+    if (err != NONE)
+        goto end;
+
+    if (BN_mod_inverse(((SHARE_OPENSSL_NUM *)r)->bn,
+            ((SHARE_OPENSSL_NUM *)a)->bn, pn->bn, ctx->bn_ctx) == NULL)
+        err = ALLOC;
+end:
+    return err;
+}
+
+/**
+ * Create the OpenSSL contexts of the prime and get the size of the scratch
+ * space that join needs.
+ * The temporaries of join are kept by the BN_CTX: no scratch space.
+ *
+ * @param [in]  prime  The prime as a number object.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_openssl_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    SHARE_ERR err;
+    SHARE_OPENSSL_CTX *ctx;
+
+    parts = parts;
+
+    /* Create now so that splitting and joining don't create it. */
+    err = openssl_ctx_get(prime, &ctx);
+    if (err != NONE)
+        goto end;
+
+    *size = 0;
+end:
+    return err;
+}
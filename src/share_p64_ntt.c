@@ -0,0 +1,1154 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+#define NUM_BYTES	8
+/** The prime: 2^64 - 2^32 + 1. */
+#define P64		0xffffffff00000001ULL
+/** 2^64 mod p: 2^32 - 1. */
+#define P64_EPS		0xffffffffULL
+/** A primitive 2^32-th root of unity modulo p: 7^((p-1)/2^32). */
+#define P64_ROOT_32	0x185629dcda58878cULL
+/** The number of parts from which the join uses a product tree. */
+#define P64_JOIN_FAST_MIN	768
+/** The log base 2 of the longest block of splits calculated at once. */
+#define P64_BLOCK_BITS		10
+
+/**
+ * Make the number less than the prime.
+ *
+ * @param [in] a  The number to reduce - less than 2^64.
+ * @return  a mod p.
+ */
+static uint64_t p64_norm(uint64_t a)
+{
+    uint64_t m = 0 - (uint64_t)(a >= P64);
+
+    return a - (m & P64);
+}
+
+/**
+ * Add b to a modulo the prime.
+ *
+ * @param [in] a  The first operand. Less than the prime.
+ * @param [in] b  The second operand. Less than the prime.
+ * @return  a + b mod p.
+ */
+static uint64_t p64_add(uint64_t a, uint64_t b)
+{
+    uint64_t r = a + b;
+    uint64_t m = 0 - (uint64_t)(r < a);
+
+    /* 2^64 mod p is added when the sum overflows. */
+    return p64_norm(r + (m & P64_EPS));
+}
+
+/**
+ * Subtract b from a modulo the prime.
+ *
+ * @param [in] a  The first operand. Less than the prime.
+ * @param [in] b  The second operand. Less than the prime.
+ * @return  a - b mod p.
+ */
+static uint64_t p64_sub(uint64_t a, uint64_t b)
+{
+    uint64_t r = a - b;
+    uint64_t m = 0 - (uint64_t)(a < b);
+
+    /* Adding p is subtracting 2^64 mod p when the difference underflows. */
+    return r - (m & P64_EPS);
+}
+
+/**
+ * Multiply a by b modulo the prime.
+ * The product is reduced using: 2^64 = 2^32 - 1 and 2^96 = -1 mod p.
+ *
+ * @param [in] a  The first operand. Less than the prime.
+ * @param [in] b  The second operand. Less than the prime.
+ * @return  a * b mod p.
+ */
+static uint64_t p64_mul(uint64_t a, uint64_t b)
+{
+    __uint128_t t = (__uint128_t)a * b;
+    uint64_t lo = (uint64_t)t;
+    uint64_t hi = (uint64_t)(t >> 64);
+    uint64_t hh = hi >> 32;
+    uint64_t hl = hi & 0xffffffff;
+    uint64_t r, s, m;
+
+    /* r = lo - hh */
+    r = lo - hh;
+    m = 0 - (uint64_t)(lo < hh);
+    r -= m & P64_EPS;
+    /* r += hl * (2^32 - 1) */
+    s = hl * P64_EPS;
+    r += s;
+    m = 0 - (uint64_t)(r < s);
+    r += m & P64_EPS;
+
+    return p64_norm(r);
+}
+
+/**
+ * Raise a to the power of e modulo the prime.
+ * The exponent is public - the operations don't depend on a.
+ *
+ * @param [in] a  The number to exponentiate.
+ * @param [in] e  The exponent.
+ * @return  a^e mod p.
+ */
+static uint64_t p64_pow(uint64_t a, uint64_t e)
+{
+    uint64_t r = 1;
+
+    for (; e != 0; e >>= 1)
+    {
+        if (e & 1)
+            r = p64_mul(r, a);
+        a = p64_mul(a, a);
+    }
+
+    return r;
+}
+
+/**
+ * Calculate the inverse of a modulo the prime: a^(p-2).
+ * The inverse of zero is zero.
+ *
+ * @param [in] a  The number to invert.
+ * @return  1 / a mod p.
+ */
+static uint64_t p64_inv(uint64_t a)
+{
+    return p64_pow(a, P64 - 2);
+}
+
+/**
+ * Reverse the order of the bottom bits of the index.
+ *
+ * @param [in] i     The index.
+ * @param [in] bits  The number of bits in the index.
+ * @return  The index with the bits reversed.
+ */
+static uint32_t p64_bit_rev(uint32_t i, int bits)
+{
+    uint32_t r = 0;
+    int j;
+
+    for (j=0; j<bits; j++)
+    {
+        r = (r << 1) | (i & 1);
+        i >>= 1;
+    }
+
+    return r;
+}
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the secret in bytes.
+ * @param [out] num  The new number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+
+    len = len;
+
+    *num = share_malloc(sizeof(uint64_t));
+    if (*num == NULL)
+        err = ALLOC;
+
+    return err;
+}
+
+/**
+ * Free the dynamic memory associated with the number object.
+ *
+ * @param [in] num  The number object.
+ */
+void share_p64_ntt_num_free(void *num)
+{
+    if (num != NULL) share_free(num);
+}
+
+/**
+ * Initialize a number object in memory provided by the caller.
+ *
+ * @param [in]  len   The length of the secret in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_num_init(uint16_t len, void *num, size_t *size)
+{
+    len = len;
+
+    if (num != NULL)
+        memset(num, 0, sizeof(uint64_t));
+    *size = sizeof(uint64_t);
+
+    return NONE;
+}
+
+/**
+ * Load 8 bytes of big-endian data as a word.
+ *
+ * @param [in] d  The data to load.
+ * @return  The word.
+ */
+static uint64_t p64_load_be64(const uint8_t *d)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    uint64_t w;
+
+    memcpy(&w, d, sizeof(w));
+    return __builtin_bswap64(w);
+#else
+    return ((uint64_t)d[0] << 56) | ((uint64_t)d[1] << 48) |
+           ((uint64_t)d[2] << 40) | ((uint64_t)d[3] << 32) |
+           ((uint64_t)d[4] << 24) | ((uint64_t)d[5] << 16) |
+           ((uint64_t)d[6] <<  8) | ((uint64_t)d[7]      );
+#endif
+}
+
+/**
+ * Store a word as 8 bytes of big-endian data.
+ *
+ * @param [in] d  The data to store into.
+ * @param [in] w  The word to store.
+ */
+static void p64_store_be64(uint8_t *d, uint64_t w)
+{
+#if defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    w = __builtin_bswap64(w);
+    memcpy(d, &w, sizeof(w));
+#else
+    d[0] = w >> 56; d[1] = w >> 48; d[2] = w >> 40; d[3] = w >> 32;
+    d[4] = w >> 24; d[5] = w >> 16; d[6] = w >>  8; d[7] = w;
+#endif
+}
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes. The number is reduced modulo the
+ * prime.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_num_from_bin(const uint8_t *data, uint16_t len,
+    void *num)
+{
+    SHARE_ERR err = NONE;
+    uint8_t b[NUM_BYTES];
+
+    if (len > NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Shorter data is padded on the left with zeros. */
+    if (len < NUM_BYTES)
+    {
+        memset(b, 0, NUM_BYTES - len);
+        memcpy(b + NUM_BYTES - len, data, len);
+        data = b;
+    }
+    *(uint64_t *)num = p64_norm(p64_load_be64(data));
+
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_p64_ntt_num_from_bin(data + i * step, len, num[i]);
+
+    return err;
+}
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    /* Longer data is padded on the left with zeros. */
+    memset(data, 0, len - NUM_BYTES);
+    p64_store_be64(data + len - NUM_BYTES, *(uint64_t *)num);
+
+end:
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_p64_ntt_num_to_bin(num[i], data + i * step, len);
+
+    return err;
+}
+
+/**
+ * Calculate the y value of a split.
+ * y = x^0.a[0] + x^1.a[1] + ... + x^(parts-1).a[parts-1]
+ *
+ * @param [in] prime  The prime as a number object. Not used.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret. 
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    int16_t i;
+    uint64_t **ad = (uint64_t **)a;
+    uint64_t xd = *(uint64_t *)x;
+    uint64_t yd;
+
+    prime = prime;
+
+    /* y = (..(a[parts-1].x + a[parts-2]).x + ..).x + a[0] */
+    yd = *ad[parts-1];
+    for (i=parts-2; i>=0; i--)
+        yd = p64_add(p64_mul(yd, xd), *ad[i]);
+    *(uint64_t *)y = yd;
+
+    return NONE;
+}
+
+/**
+ * Calculate the secret from the denominators.
+ * secret = (x[0] * x[1] * .. * x[parts-1]) *
+ *          sum of (i=0..parts-1) y[i] / d[i]
+ * The denominators are inverted together with one inversion.
+ *
+ * @param [in] parts  The number of parts.
+ * @param [in] xd     The array of x values.
+ * @param [in] yd     The array of y values.
+ * @param [in] d      The denominators: x[i] * product of all x[j] - x[i] where
+ *                    i != j.
+ * @param [in] c      Temporary for the products of denominators. parts words.
+ * @return  The secret.
+ */
+static uint64_t p64_join_sum(uint16_t parts, uint64_t **xd, uint64_t **yd,
+    uint64_t *d, uint64_t *c)
+{
+    uint16_t i;
+    uint64_t np, inv, sum;
+
+    /* np = x[0] * x[1] * .. * x[parts-1] */
+    np = *xd[0];
+    for (i=1; i<parts; i++)
+        np = p64_mul(np, *xd[i]);
+
+    /* c[i] = d[0] * d[1] * .. * d[i] */
+    c[0] = d[0];
+    for (i=1; i<parts; i++)
+        c[i] = p64_mul(c[i-1], d[i]);
+
+    /* inv = 1 / c[parts-1] */
+    inv = p64_inv(c[parts-1]);
+
+    /* sum = y[0] / d[0] + y[1] / d[1] + .. + y[parts-1] / d[parts-1]
+     * Working down from the last part: 1 / d[i] = inv * c[i-1] and then
+     * inv = inv * d[i] = 1 / c[i-1].
+     */
+    sum = 0;
+    for (i=parts-1; i>0; i--)
+    {
+        sum = p64_add(sum, p64_mul(p64_mul(inv, c[i-1]), *yd[i]));
+        inv = p64_mul(inv, d[i]);
+    }
+    sum = p64_add(sum, p64_mul(inv, *yd[0]));
+
+    /* secret = np * sum (as x[i] is multiplied into denominator) */
+    return p64_mul(np, sum);
+}
+
+/**
+ * Calculate the secret from splits by calculating each denominator directly.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * O(parts^2) operations.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used - the denominators are on the stack.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_join_quad(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    uint16_t i, j;
+    uint64_t c[SHARE_PARTS_MAX], d[SHARE_PARTS_MAX];
+    uint64_t **xd = (uint64_t **)x;
+
+    prime = prime;
+    scratch = scratch;
+
+    /* Calculate all the denominators.
+     * d[i] = x[i] * (product of all x[j] - x[i] where i != j).
+     * Four denominators are calculated at a time as the multiplications of
+     * one are dependent. x[i] - x[i] is replaced with 1.
+     */
+    for (i=0; i+4<=parts; i+=4)
+    {
+        uint64_t x0 = *xd[i], x1 = *xd[i+1], x2 = *xd[i+2], x3 = *xd[i+3];
+        uint64_t d0 = x0, d1 = x1, d2 = x2, d3 = x3;
+
+        for (j=0; j<parts; j++)
+        {
+            uint64_t xj = *xd[j];
+
+            d0 = p64_mul(d0, (i   == j) ? 1 : p64_sub(xj, x0));
+            d1 = p64_mul(d1, (i+1 == j) ? 1 : p64_sub(xj, x1));
+            d2 = p64_mul(d2, (i+2 == j) ? 1 : p64_sub(xj, x2));
+            d3 = p64_mul(d3, (i+3 == j) ? 1 : p64_sub(xj, x3));
+        }
+        d[i] = d0; d[i+1] = d1; d[i+2] = d2; d[i+3] = d3;
+    }
+    for (; i<parts; i++)
+    {
+        d[i] = *xd[i];
+        for (j=0; j<parts; j++)
+        {
+            if (i == j)
+                continue;
+
+            d[i] = p64_mul(d[i], p64_sub(*xd[j], *xd[i]));
+        }
+    }
+
+    *(uint64_t *)secret = p64_join_sum(parts, xd, (uint64_t **)y, d, c);
+
+    return NONE;
+}
+
+/** Polynomials with no more coefficients than this are multiplied directly. */
+#define P64_POLY_SMALL	32
+
+/** The data for multiplying polynomials with number-theoretic transforms. */
+typedef struct p64_poly_st
+{
+    /** The longest transform. */
+    uint32_t n;
+    /** Powers of a primitive n-th root of unity. n/2 words. */
+    uint64_t *w;
+    /** Powers of the inverse of the root of unity. n/2 words. */
+    uint64_t *wi;
+    /** The transform of the first operand. n words. */
+    uint64_t *fa;
+    /** The transform of the second operand. n words. */
+    uint64_t *fb;
+} P64_POLY;
+
+/**
+ * Forward transform with decimation in frequency.
+ * The input is in natural order and the output is in bit reversed order.
+ *
+ * @param [in] p  The polynomial multiplication data.
+ * @param [in] r  The numbers to transform.
+ * @param [in] n  The length of the transform - a power of two.
+ */
+static void p64_ntt_fwd(P64_POLY *p, uint64_t *r, uint32_t n)
+{
+    uint32_t h, i, j, s;
+    uint64_t u, t;
+
+    /* The stage with half-length h uses the 2h-th roots of unity. */
+    for (h=n/2, s=p->n/n; h>0; h>>=1, s<<=1)
+    {
+        for (i=0; i<n; i+=2*h)
+        {
+            for (j=0; j<h; j++)
+            {
+                u = r[i+j];
+                t = r[i+j+h];
+                r[i+j] = p64_add(u, t);
+                r[i+j+h] = p64_mul(p64_sub(u, t), p->w[j*s]);
+            }
+        }
+    }
+}
+
+/**
+ * Inverse transform with decimation in time.
+ * The input is in bit reversed order and the output is in natural order.
+ *
+ * @param [in] p  The polynomial multiplication data.
+ * @param [in] r  The numbers to transform.
+ * @param [in] n  The length of the transform - a power of two.
+ */
+static void p64_ntt_inv(P64_POLY *p, uint64_t *r, uint32_t n)
+{
+    uint32_t h, i, j, s;
+    uint64_t u, t, ni;
+
+    for (h=1, s=p->n/2; h<n; h<<=1, s>>=1)
+    {
+        for (i=0; i<n; i+=2*h)
+        {
+            for (j=0; j<h; j++)
+            {
+                u = r[i+j];
+                t = p64_mul(r[i+j+h], p->wi[j*s]);
+                r[i+j] = p64_add(u, t);
+                r[i+j+h] = p64_sub(u, t);
+            }
+        }
+    }
+
+    /* 1 / n = p - (p - 1) / n */
+    ni = P64 - (P64 - 1) / n;
+    for (i=0; i<n; i++)
+        r[i] = p64_mul(r[i], ni);
+}
+
+/**
+ * Cyclic convolution of a and b of length n.
+ * The result is left in the first transform buffer.
+ *
+ * @param [in] p   The polynomial multiplication data.
+ * @param [in] a   The coefficients of the first polynomial.
+ * @param [in] an  The number of coefficients in a. At most n.
+ * @param [in] b   The coefficients of the second polynomial.
+ * @param [in] bn  The number of coefficients in b. At most n.
+ * @param [in] n   The length of the convolution - a power of two.
+ * @param [in] rb  Whether b is to be used in reverse order.
+ */
+static void p64_poly_cyc(P64_POLY *p, uint64_t *a, uint32_t an, uint64_t *b,
+    uint32_t bn, uint32_t n, int rb)
+{
+    uint32_t i;
+
+    memcpy(p->fa, a, an * sizeof(*a));
+    memset(p->fa + an, 0, (n - an) * sizeof(*a));
+    for (i=0; i<bn; i++)
+        p->fb[i] = rb ? b[bn - 1 - i] : b[i];
+    memset(p->fb + bn, 0, (n - bn) * sizeof(*b));
+
+    p64_ntt_fwd(p, p->fa, n);
+    p64_ntt_fwd(p, p->fb, n);
+    for (i=0; i<n; i++)
+        p->fa[i] = p64_mul(p->fa[i], p->fb[i]);
+    p64_ntt_inv(p, p->fa, n);
+}
+
+/**
+ * Multiply two polynomials.
+ *
+ * @param [in] p   The polynomial multiplication data.
+ * @param [in] r   The coefficients of the product. an+bn-1 words.
+ * @param [in] a   The coefficients of the first polynomial.
+ * @param [in] an  The number of coefficients in a.
+ * @param [in] b   The coefficients of the second polynomial.
+ * @param [in] bn  The number of coefficients in b.
+ */
+static void p64_poly_mul(P64_POLY *p, uint64_t *r, uint64_t *a, uint32_t an,
+    uint64_t *b, uint32_t bn)
+{
+    uint32_t i, j, n;
+
+    if ((an <= P64_POLY_SMALL) || (bn <= P64_POLY_SMALL))
+    {
+        memset(r, 0, (an + bn - 1) * sizeof(*r));
+        for (i=0; i<an; i++)
+            for (j=0; j<bn; j++)
+                r[i+j] = p64_add(r[i+j], p64_mul(a[i], b[j]));
+        return;
+    }
+
+    for (n=1; n<an+bn-1; n<<=1)
+        ;
+    p64_poly_cyc(p, a, an, b, bn, n, 0);
+    memcpy(r, p->fa, (an + bn - 1) * sizeof(*r));
+}
+
+/**
+ * Multiply two monic polynomials.
+ * When the degree of the product is a power of two, the convolution wraps the
+ * leading coefficient of one onto the constant coefficient.
+ *
+ * @param [in] p   The polynomial multiplication data.
+ * @param [in] r   The coefficients of the product. ad+bd+1 words.
+ * @param [in] a   The coefficients of the first polynomial.
+ * @param [in] ad  The degree of a.
+ * @param [in] b   The coefficients of the second polynomial.
+ * @param [in] bd  The degree of b.
+ */
+static void p64_poly_mul_monic(P64_POLY *p, uint64_t *r, uint64_t *a,
+    uint32_t ad, uint64_t *b, uint32_t bd)
+{
+    uint32_t n;
+
+    if ((ad < P64_POLY_SMALL) || (bd < P64_POLY_SMALL))
+    {
+        p64_poly_mul(p, r, a, ad + 1, b, bd + 1);
+        return;
+    }
+
+    for (n=1; n<ad+bd; n<<=1)
+        ;
+    p64_poly_cyc(p, a, ad + 1, b, bd + 1, n, 0);
+    memcpy(r, p->fa, (ad + bd) * sizeof(*r));
+    if (n == ad + bd)
+        r[0] = p64_sub(r[0], 1);
+    r[ad + bd] = 1;
+}
+
+/**
+ * Calculate the middle product: r[t] = sum of (l=0..bn-1) b[l] * a[t+l].
+ * The transposition of multiplying by b.
+ *
+ * @param [in] p   The polynomial multiplication data.
+ * @param [in] r   The middle product. rn words.
+ * @param [in] a   The numbers to multiply. rn+bn-1 words.
+ * @param [in] b   The coefficients of the polynomial.
+ * @param [in] bn  The number of coefficients in b.
+ * @param [in] rn  The number of numbers in the result.
+ */
+static void p64_poly_mid(P64_POLY *p, uint64_t *r, uint64_t *a, uint64_t *b,
+    uint32_t bn, uint32_t rn)
+{
+    uint32_t an = rn + bn - 1;
+    uint32_t l, t, n;
+
+    if ((rn <= P64_POLY_SMALL) || (bn <= P64_POLY_SMALL))
+    {
+        for (t=0; t<rn; t++)
+        {
+            r[t] = 0;
+            for (l=0; l<bn; l++)
+                r[t] = p64_add(r[t], p64_mul(b[l], a[t+l]));
+        }
+        return;
+    }
+
+    /* The wrapped products only reach below index bn-1. */
+    for (n=1; n<an; n<<=1)
+        ;
+    p64_poly_cyc(p, a, an, b, bn, n, 1);
+    memcpy(r, p->fa + bn - 1, rn * sizeof(*r));
+}
+
+/**
+ * Build the product tree of the x values: the polynomial of a node is
+ * (z - x[lo]) * (z - x[lo+1]) * .. * (z - x[hi-1]).
+ * The polynomial of a node at depth lvl is at tree[lvl] + 2 * lo.
+ *
+ * @param [in] p     The polynomial multiplication data.
+ * @param [in] tree  The levels of the tree.
+ * @param [in] lvl   The depth of the node.
+ * @param [in] x     The array of x values.
+ * @param [in] lo    The index of the first x value of the node.
+ * @param [in] hi    The index after the last x value of the node.
+ */
+static void p64_tree_build(P64_POLY *p, uint64_t **tree, int lvl,
+    uint64_t **x, uint32_t lo, uint32_t hi)
+{
+    uint64_t *m = tree[lvl] + 2 * lo;
+    uint32_t mid;
+
+    if (hi - lo == 1)
+    {
+        m[0] = p64_sub(0, *x[lo]);
+        m[1] = 1;
+        return;
+    }
+
+    mid = lo + (hi - lo) / 2;
+    p64_tree_build(p, tree, lvl + 1, x, lo, mid);
+    p64_tree_build(p, tree, lvl + 1, x, mid, hi);
+    p64_poly_mul_monic(p, m, tree[lvl + 1] + 2 * lo, mid - lo,
+        tree[lvl + 1] + 2 * mid, hi - mid);
+}
+
+/**
+ * Evaluate a polynomial at the x values of the nodes below this node.
+ * The node's numbers are: v[t] = sum of (i=lo..hi-1) e[i].x[i]^t.P(x[i])
+ * where e[i] = 1 / product of (j=lo..hi-1) x[i] - x[j] with j != i.
+ * A child's numbers are the middle product of the node's numbers and the
+ * polynomial of the other child. At a leaf, v[0] = P(x[lo]).
+ *
+ * @param [in] p     The polynomial multiplication data.
+ * @param [in] tree  The levels of the product tree.
+ * @param [in] vt    The levels of numbers. The numbers of a node at depth lvl
+ *                   are at vt[lvl] + lo.
+ * @param [in] lvl   The depth of the node.
+ * @param [in] lo    The index of the first x value of the node.
+ * @param [in] hi    The index after the last x value of the node.
+ * @param [in] r     The values of the polynomial at the x values.
+ */
+static void p64_tree_eval(P64_POLY *p, uint64_t **tree, uint64_t **vt,
+    int lvl, uint32_t lo, uint32_t hi, uint64_t *r)
+{
+    uint64_t *v = vt[lvl] + lo;
+    uint32_t mid;
+
+    if (hi - lo == 1)
+    {
+        r[lo] = v[0];
+        return;
+    }
+
+    mid = lo + (hi - lo) / 2;
+    p64_poly_mid(p, vt[lvl + 1] + lo, v, tree[lvl + 1] + 2 * mid,
+        hi - mid + 1, mid - lo);
+    p64_poly_mid(p, vt[lvl + 1] + mid, v, tree[lvl + 1] + 2 * lo,
+        mid - lo + 1, hi - mid);
+    p64_tree_eval(p, tree, vt, lvl + 1, lo, mid, r);
+    p64_tree_eval(p, tree, vt, lvl + 1, mid, hi, r);
+}
+
+/**
+ * Calculate the power sums of the roots of a monic polynomial:
+ * s[t] = sum of (i=0..n-1) x[i]^t for t=0..n-1
+ * with M(z) = (z - x[0]) * .. * (z - x[n-1]) and G(y) = y^n.M(1 / y):
+ * sum of (t>=0) s[t].y^t = n - y.G'(y) / G(y)
+ * The inverse of G is calculated with Newton iteration.
+ *
+ * @param [in] p  The polynomial multiplication data.
+ * @param [in] m  The coefficients of the monic polynomial. n+1 words.
+ * @param [in] n  The degree of the polynomial.
+ * @param [in] s  The power sums. n words.
+ * @param [in] t  Temporary. 6.n words.
+ */
+static void p64_power_sums(P64_POLY *p, uint64_t *m, uint32_t n, uint64_t *s,
+    uint64_t *t)
+{
+    uint64_t *g = t, *gi = t + n, *e = t + 2 * n, *f = t + 4 * n;
+    uint32_t i, k, k2;
+
+    /* G is M with the coefficients reversed - G[0] = 1. */
+    for (i=0; i<n; i++)
+        g[i] = m[n - i];
+
+    /* 1/G mod y^2k = gi.(2 - G.gi) = gi - gi.(G.gi - 1)
+     * G.gi = 1 mod y^k and only the next k coefficients are needed. */
+    gi[0] = 1;
+    for (k=1; k<n; k=k2)
+    {
+        k2 = (2 * k < n) ? 2 * k : n;
+        p64_poly_mul(p, e, g, k2, gi, k);
+        p64_poly_mul(p, f, gi, k2 - k, e + k, k2 - k);
+        for (i=k; i<k2; i++)
+            gi[i] = p64_sub(0, f[i - k]);
+    }
+
+    /* y.G'(y) has coefficients i.G[i] */
+    for (i=0; i<n; i++)
+        g[i] = p64_mul(i, g[i]);
+    p64_poly_mul(p, e, g, n, gi, n);
+    s[0] = n;
+    for (i=1; i<n; i++)
+        s[i] = p64_sub(0, e[i]);
+}
+
+/**
+ * Get the number of words of scratch space that the join with a product tree
+ * needs.
+ * The transforms need 3.n words where n is the longest transform. The
+ * denominators, their products, the temporaries of the power sums and each
+ * level of the tree and its transpose need parts words each.
+ *
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] n      The longest transform. May be NULL.
+ * @param [out] lvls   The depth of the tree. May be NULL.
+ * @return  The number of words of scratch space.
+ */
+static size_t p64_join_fast_words(uint16_t parts, uint32_t *n, int *lvls)
+{
+    uint32_t pn;
+    int l;
+
+    /* The tree's depth and the longest transform: products of length
+     * 2.parts - 1. */
+    for (l=1; ((uint32_t)1 << (l - 1)) < parts; l++)
+        ;
+    for (pn=1; pn<2*(uint32_t)parts-1; pn<<=1)
+        ;
+
+    if (n != NULL) *n = pn;
+    if (lvls != NULL) *lvls = l;
+    return (size_t)3 * pn + (size_t)(3 * l + 9) * parts;
+}
+
+/**
+ * Calculate the secret from splits with a product tree.
+ * secret = sum of (i=0..parts-1) y[i] *
+ *          product of (j=0..parts-1) x[j] / (x[j] - x[i]) where j != i
+ * With M(z) = product of (i=0..parts-1) (z - x[i]), the product of all
+ * x[j] - x[i] where j != i is (-1)^(parts-1).M'(x[i]). M' is evaluated at all
+ * the x values at once by transposing the remainder tree. The only remainder
+ * needed is at the root: the power sums of the x values.
+ * O(parts.log(parts)^2) operations.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_join_fast(void *prime, uint16_t parts, void **x,
+    void **y, void *secret, void *scratch)
+{
+    P64_POLY p;
+    uint64_t *tree[18], *vt[18];
+    uint64_t **xd = (uint64_t **)x;
+    uint64_t *d, *c, *t, v;
+    uint32_t i;
+    int lvl, lvls;
+
+    prime = prime;
+
+    if (parts == 1)
+    {
+        *(uint64_t *)secret = *(uint64_t *)y[0];
+        goto end;
+    }
+
+    p64_join_fast_words(parts, &p.n, &lvls);
+    p.w = scratch;
+    p.wi = p.w + p.n / 2;
+    p.fa = p.wi + p.n / 2;
+    p.fb = p.fa + p.n;
+    d = p.fb + p.n;
+    c = d + parts;
+    t = c + parts;
+    for (lvl=0; lvl<lvls; lvl++)
+    {
+        tree[lvl] = t + 6 * parts + (size_t)lvl * 3 * parts;
+        vt[lvl] = tree[lvl] + 2 * parts;
+    }
+
+    /* w[j] = v^j and wi[j] = v^-j for a primitive n-th root of unity v. */
+    v = p64_pow(P64_ROOT_32, ((uint64_t)1 << 32) / p.n);
+    p.w[0] = p.wi[0] = 1;
+    for (i=1; i<p.n/2; i++)
+    {
+        p.w[i] = p64_mul(p.w[i-1], v);
+        p.wi[p.n/2 - i] = p64_sub(0, p.w[i]);
+    }
+
+    p64_tree_build(&p, tree, 0, xd, 0, parts);
+    p64_power_sums(&p, tree[0], parts, vt[0], t);
+    /* d[i] = M'(x[i]) */
+    p64_tree_eval(&p, tree, vt, 0, 0, parts, d);
+
+    /* d[i] = x[i] * (product of all x[j] - x[i] where i != j). */
+    for (i=0; i<parts; i++)
+    {
+        d[i] = p64_mul(d[i], *xd[i]);
+        if ((parts & 1) == 0)
+            d[i] = p64_sub(0, d[i]);
+    }
+
+    *(uint64_t *)secret = p64_join_sum(parts, xd, (uint64_t **)y, d, c);
+
+end:
+    return NONE;
+}
+
+/**
+ * Calculate the secret from splits.
+ * The product tree is used when there are enough parts to be faster.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch)
+{
+    if (parts >= P64_JOIN_FAST_MIN)
+        return share_p64_ntt_join_fast(prime, parts, x, y, secret, scratch);
+    return share_p64_ntt_join_quad(prime, parts, x, y, secret, scratch);
+}
+
+/**
+ * Calculate the inverse of a number modulo the prime.
+ *
+ * @param [in] prime  The prime as a number object. Not used.
+ * @param [in] a      The number object to invert.
+ * @param [in] r      The inverse as a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_num_inv(void *prime, void *a, void *r)
+{
+    prime = prime;
+
+    *(uint64_t *)r = p64_inv(*(uint64_t *)a);
+
+    return NONE;
+}
+
+/**
+ * Evaluate the polynomial at a block of the x values of splits.
+ * The x value of split i is w^bitrev(i) where w is a primitive 2^32-th root of
+ * unity. The block starts at a multiple of its length, n, so the x values are
+ * c.v^bitrev(j) where c = w^bitrev(first) and v is a primitive n-th root of
+ * unity. The coefficients are multiplied by powers of c and folded modulo
+ * x^n - c^n, and then a decimation in frequency transform evaluates the folded
+ * polynomial at all the n-th roots of unity with the results in bit reversed
+ * order.
+ *
+ * @param [in] a      The array of coefficients.
+ * @param [in] parts  The number of coefficients.
+ * @param [in] first  The index of the first split in the block.
+ * @param [in] bits   The log base 2 of the number of splits in the block.
+ * @param [in] b      Temporary for the twiddle factors. n words.
+ * @param [in] r      The y values followed by the x values of the block.
+ *                    2.n words.
+ */
+static void p64_ntt_block(uint64_t **a, uint16_t parts, uint32_t first,
+    int bits, uint64_t *b, uint64_t *r)
+{
+    uint32_t n = (uint32_t)1 << bits;
+    uint32_t h, i, j, s;
+    uint64_t c, cm, v, u, t;
+
+    c = p64_pow(P64_ROOT_32, p64_bit_rev(first, 32));
+
+    /* r[m mod n] += a[m].c^m */
+    memset(r, 0, n * sizeof(*r));
+    cm = 1;
+    for (i=0; i<parts; i++)
+    {
+        r[i & (n - 1)] = p64_add(r[i & (n - 1)], p64_mul(*a[i], cm));
+        cm = p64_mul(cm, c);
+    }
+
+    /* b[j] = v^j - the twiddle factors. */
+    v = p64_pow(P64_ROOT_32, (uint64_t)1 << (32 - bits));
+    b[0] = 1;
+    for (j=1; j<n; j++)
+        b[j] = p64_mul(b[j-1], v);
+
+    /* Decimation in frequency: the stage with half-length h uses the 2h-th
+     * roots of unity - every (n / 2h)-th twiddle factor. */
+    for (h=n/2, s=1; h>0; h>>=1, s<<=1)
+    {
+        for (i=0; i<n; i+=2*h)
+        {
+            for (j=0; j<h; j++)
+            {
+                u = r[i+j];
+                t = r[i+j+h];
+                r[i+j] = p64_add(u, t);
+                r[i+j+h] = p64_mul(p64_sub(u, t), b[j*s]);
+            }
+        }
+    }
+
+    /* x values in the order of the results: c.v^bitrev(j) */
+    for (j=0; j<n; j++)
+    {
+        r[n + j] = p64_mul(c, b[p64_bit_rev(j, bits)]);
+    }
+}
+
+/**
+ * Calculate the x and y values of many splits at once.
+ * The x value of split i is w^bitrev(i) where w is a primitive 2^32-th root of
+ * unity: the x values of the first 2^k splits are the 2^k-th roots of unity and
+ * never repeat. The splits are split into blocks whose lengths are powers of
+ * two, that start at a multiple of their length and that are no longer than
+ * 2^P64_BLOCK_BITS splits. Each block is evaluated with a number-theoretic
+ * transform - O(n.log(n)) for n splits.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] a        The array of coefficients.
+ * @param [in] first    The index of the first split to calculate.
+ * @param [in] num      The number of splits to calculate.
+ * @param [in] data     The encoded x and y values of the splits.
+ * @param [in] len      The number of bytes in the encoding of an x or a y.
+ * @param [in] scratch  Scratch space of the size from the scratch function.
+ * @return  FAILED when there are no more unique x values.<br>
+ *          PARAM_BAD_LEN when len is too short for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_p64_ntt_split_all(void *prime, uint16_t parts, void **a,
+    uint32_t first, uint16_t num, uint8_t *data, uint16_t len, void *scratch)
+{
+    SHARE_ERR err = NONE;
+    uint64_t *b = scratch;
+    uint64_t *r = b + ((size_t)1 << P64_BLOCK_BITS);
+    uint32_t n, i;
+    int bits, max_bits;
+
+    prime = prime;
+
+    if (len < NUM_BYTES)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+    /* Counts of splits are signed 32-bit integers. */
+    if (first > 0x7fffffff - (uint32_t)num)
+    {
+        err = FAILED;
+        goto end;
+    }
+
+    /* No block is longer than the number of splits rounded down to a power of
+     * two. */
+    for (max_bits=0; ((uint32_t)2 << max_bits) <= num; max_bits++)
+        ;
+    if (max_bits > P64_BLOCK_BITS)
+        max_bits = P64_BLOCK_BITS;
+
+    while (num > 0)
+    {
+        /* Largest block that is aligned at first and not longer than num
+         * splits. */
+        for (bits=max_bits; ((uint32_t)1 << bits) > num; bits--)
+            ;
+        while ((bits > 0) && ((first & (((uint32_t)1 << bits) - 1)) != 0))
+            bits--;
+        n = (uint32_t)1 << bits;
+
+        p64_ntt_block((uint64_t **)a, parts, first, bits, b, r);
+
+        for (i=0; i<n; i++)
+        {
+            memset(data, 0, 2 * len);
+            p64_store_be64(data + len - NUM_BYTES, r[n + i]);
+            p64_store_be64(data + 2 * len - NUM_BYTES, r[i]);
+            data += 2 * len;
+        }
+
+        first += n;
+        num -= n;
+    }
+
+end:
+    return err;
+}
+
+/**
+ * Get the size of the scratch space that join and split_all need.
+ * split_all needs a block's twiddle factors, y values and x values. The join
+ * with a product tree needs the transforms and the tree.
+ *
+ * @param [in]  prime  The prime as a number object. Not used.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space.
+ * @return  NONE.
+ */
+SHARE_ERR share_p64_ntt_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    size_t words = (size_t)3 << P64_BLOCK_BITS;
+    size_t fast;
+
+    prime = prime;
+
+    if (parts >= P64_JOIN_FAST_MIN)
+    {
+        fast = p64_join_fast_words(parts, NULL, NULL);
+        if (fast > words)
+            words = fast;
+    }
+    *size = words * sizeof(uint64_t);
+
+    return NONE;
+}
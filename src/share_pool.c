@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <pthread.h>
+#include "share_lcl.h"
+
+/** The maximum number of configurations that are pooled. */
+#define POOL_MAX	64
+/** The number of free objects a thread keeps for a configuration before
+ * returning them to the shared list. */
+#define POOL_MAG_SIZE	8
+
+/** The pool of free objects for a configuration. */
+typedef struct share_pool_st
+{
+    /** The configuration: length in bits, parts and flags. Unused: 0. */
+    uint64_t key;
+    /** The list of free objects shared by all threads. */
+    SHARE *depot;
+} SHARE_POOL;
+
+/** The pools - one for each configuration. Claimed in order. */
+static SHARE_POOL share_pools[POOL_MAX];
+
+/** The free objects of each pool kept by this thread: a magazine. */
+static __thread SHARE *pool_mag[POOL_MAX];
+/** The number of objects in each magazine of this thread. */
+static __thread uint16_t pool_mag_cnt[POOL_MAX];
+
+/** The key whose destructor empties the magazines of an exiting thread. */
+static pthread_key_t pool_thread_key;
+/** Creates the thread key once. */
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Push a list of objects onto the shared list of a pool.
+ * Only pushing uses compare-and-swap - popping takes the whole list - so a
+ * recycled head can't corrupt the list.
+ *
+ * @param [in] pool  The pool object.
+ * @param [in] head  The first object of the list.
+ * @param [in] tail  The last object of the list.
+ */
+static void pool_depot_push(SHARE_POOL *pool, SHARE *head, SHARE *tail)
+{
+    SHARE *top = __atomic_load_n(&pool->depot, __ATOMIC_RELAXED);
+
+    do
+        tail->next = top;
+    while (!__atomic_compare_exchange_n(&pool->depot, &top, head, 1,
+        __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/**
+ * Move the objects of a magazine of this thread to the shared list.
+ *
+ * @param [in] i  The index of the pool.
+ */
+static void pool_mag_flush(int i)
+{
+    SHARE *tail;
+
+    if (pool_mag[i] == NULL)
+        return;
+
+    for (tail = pool_mag[i]; tail->next != NULL; tail = tail->next)
+        ;
+    pool_depot_push(&share_pools[i], pool_mag[i], tail);
+    pool_mag[i] = NULL;
+    pool_mag_cnt[i] = 0;
+}
+
+/**
+ * Empty the magazines of an exiting thread into the shared lists.
+ *
+ * @param [in] arg  The thread specific value. Not used.
+ */
+static void pool_thread_exit(void *arg)
+{
+    int i;
+
+    (void)arg;
+
+    for (i=0; i<POOL_MAX; i++)
+        pool_mag_flush(i);
+}
+
+/**
+ * Create the key that empties magazines on thread exit.
+ */
+static void pool_key_create(void)
+{
+    pthread_key_create(&pool_thread_key, pool_thread_exit);
+}
+
+/**
+ * Register to have the magazines of this thread emptied when it exits.
+ * Called before a magazine is filled.
+ */
+static void pool_thread_register(void)
+{
+    pthread_once(&pool_once, pool_key_create);
+    if (pthread_getspecific(pool_thread_key) == NULL)
+        pthread_setspecific(pool_thread_key, share_pools);
+}
+
+/**
+ * Find the pool of a configuration.
+ *
+ * @param [in] key    The configuration.
+ * @param [in] claim  Whether to claim an unused pool when none.
+ * @return  The index of the pool or POOL_MAX when not found.
+ */
+static int pool_find(uint64_t key, int claim)
+{
+    uint64_t k;
+    int i;
+
+    for (i=0; i<POOL_MAX; i++)
+    {
+        k = __atomic_load_n(&share_pools[i].key, __ATOMIC_ACQUIRE);
+        if (k == 0)
+        {
+            if (!claim)
+                return POOL_MAX;
+            /* Another thread may claim the pool for any configuration. */
+            if (__atomic_compare_exchange_n(&share_pools[i].key, &k, key, 0,
+                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                break;
+        }
+        if (k == key)
+            break;
+    }
+
+    return i;
+}
+
+/**
+ * Get an object that is used to split and join secrets from the pool of the
+ * configuration. A free object of this thread is reused before one returned
+ * by any thread. A new object is created when there are no free objects.
+ * Return the object with SHARE_pool_put().
+ *
+ * @param [in]  len    The length of the secret in bits.
+ * @param [in]  parts  The number of parts required to recreate secret.
+ * @param [in]  flags  Required features of the implementation.
+ * @param [out] share  The share operation object.
+ * @return  PARAM_NULL when share is NULL.
+ *          PARAM_BAD_VALUE when parts and/or length are invalid.<br>
+ *          NOT_FOUND when no prime or implementation supports the requirements.
+ *          <br>
+ *          ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR SHARE_pool_get(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE **share)
+{
+    SHARE_ERR err = NONE;
+    SHARE *s;
+    uint64_t key;
+    uint16_t cnt = 0;
+    int i;
+
+    if (share == NULL)
+    {
+        err = PARAM_NULL;
+        goto end;
+    }
+
+    key = ((uint64_t)flags << 32) | ((uint32_t)parts << 16) | len;
+    i = pool_find(key, 0);
+    if ((i < POOL_MAX) && (pool_mag[i] == NULL))
+    {
+        /* Take all the objects returned to the shared list. */
+        pool_thread_register();
+        pool_mag[i] = __atomic_exchange_n(&share_pools[i].depot, NULL,
+            __ATOMIC_ACQUIRE);
+        for (s = pool_mag[i]; s != NULL; s = s->next)
+            cnt++;
+        pool_mag_cnt[i] = cnt;
+    }
+    if ((i < POOL_MAX) && (pool_mag[i] != NULL))
+    {
+        s = pool_mag[i];
+        pool_mag[i] = s->next;
+        pool_mag_cnt[i]--;
+        s->next = NULL;
+        *share = s;
+        goto end;
+    }
+
+    /* Claim a pool once the configuration is known to be valid. Not pooled
+     * when all pools are used. */
+    err = SHARE_new(len, parts, flags, share);
+    if ((err == NONE) && (i == POOL_MAX))
+        i = pool_find(key, 1);
+    if ((err == NONE) && (i < POOL_MAX))
+        (*share)->pool = &share_pools[i];
+end:
+    return err;
+}
+
+/**
+ * Return an object to its pool. The secret state of the object is scrubbed.
+ * Objects not from a pool are freed.
+ *
+ * @param [in] share  The share operation object.
+ */
+void SHARE_pool_put(SHARE *share)
+{
+    int i;
+
+    if (share == NULL)
+        return;
+    if ((share->pool == NULL) || (share_scrub(share) != NONE))
+    {
+        SHARE_free(share);
+        return;
+    }
+
+    pool_thread_register();
+
+    i = (int)((SHARE_POOL *)share->pool - share_pools);
+    share->next = pool_mag[i];
+    pool_mag[i] = share;
+    if (++pool_mag_cnt[i] > POOL_MAG_SIZE)
+        pool_mag_flush(i);
+}
+
+/**
+ * Free the free objects of all pools: the shared lists and the magazines of
+ * this thread. Objects in the magazines of other running threads are kept.
+ * Call when no other thread is getting or putting objects.
+ */
+void SHARE_pool_clear(void)
+{
+    SHARE *s, *next;
+    int i;
+
+    for (i=0; i<POOL_MAX; i++)
+    {
+        pool_mag_flush(i);
+        s = __atomic_exchange_n(&share_pools[i].depot, NULL, __ATOMIC_ACQUIRE);
+        for (; s != NULL; s = next)
+        {
+            next = s->next;
+            SHARE_free(s);
+        }
+    }
+}
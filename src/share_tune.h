@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* The kernel variants of the C implementations of the primes.
+ * Generated on the build host with: make autotune
+ * The variants are listed in the order: mul, sqr, word.
+ *   mul  - ps: product scanning, os: operand scanning.
+ *   sqr  - ps: dedicated squaring, mul: multiply the number by itself.
+ *   word - shift: multiply by the prime's last word with shifts and adds,
+ *          mul: multiply by the prime's last word with a multiply.
+ */
+
+/** The kernel variants of the 60-bit prime C implementation. */
+#define SHARE_P60_TUNE	"ps,ps,shift"
+/** The kernel variants of the 126-bit prime C implementation. */
+#define SHARE_P126_TUNE	"ps,ps,shift"
+/** The kernel variants of the 128-bit prime C implementation. */
+#define SHARE_P128_TUNE	"ps,ps,shift"
+/** The kernel variants of the 192-bit prime C implementation. */
+#define SHARE_P192_TUNE	"ps,ps,mul"
+/** The kernel variants of the 256-bit prime C implementation. */
+#define SHARE_P256_TUNE	"ps,ps,mul"
+/** The kernel variants of the 384-bit prime C implementation. */
+#define SHARE_P384_TUNE	"ps,ps,mul"
+/** The kernel variants of the 520-bit prime C implementation. */
+#define SHARE_P520_TUNE	"ps,ps,shift"
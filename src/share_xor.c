@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "share_meth.h"
+
+#ifdef CPU_X86_64
+#include <emmintrin.h>
+#endif
+
+/*
+ * A number object is an array of words. The first word is the number of words
+ * of data that follow. The data is the big-endian bytes of the number aligned
+ * to the end of the words.
+ */
+
+/** The number of words of data in the number object. */
+#define NUM_WORDS(n)	((size_t)((uint64_t *)(n))[0])
+/** The bytes of data in the number object. */
+#define NUM_BYTES(n)	((uint8_t *)&((uint64_t *)(n))[1])
+
+/**
+ * XOR the bytes of a into r.
+ * Blocks of 16 bytes are XORed with SSE2, four at a time, and the remainder
+ * as 64-bit words and then bytes. The numbers are only 8 byte aligned.
+ *
+ * @param [in] r  The bytes to XOR into.
+ * @param [in] a  The bytes to XOR.
+ * @param [in] n  The number of bytes.
+ */
+void share_xor_bytes(uint8_t *r, const uint8_t *a, size_t n)
+{
+    size_t i = 0;
+    uint64_t w, v;
+#ifdef CPU_X86_64
+    __m128i r0, r1, r2, r3;
+
+    for (; i + 64 <= n; i += 64)
+    {
+        r0 = _mm_loadu_si128((const __m128i *)(r + i) + 0);
+        r1 = _mm_loadu_si128((const __m128i *)(r + i) + 1);
+        r2 = _mm_loadu_si128((const __m128i *)(r + i) + 2);
+        r3 = _mm_loadu_si128((const __m128i *)(r + i) + 3);
+        r0 = _mm_xor_si128(r0, _mm_loadu_si128((const __m128i *)(a + i) + 0));
+        r1 = _mm_xor_si128(r1, _mm_loadu_si128((const __m128i *)(a + i) + 1));
+        r2 = _mm_xor_si128(r2, _mm_loadu_si128((const __m128i *)(a + i) + 2));
+        r3 = _mm_xor_si128(r3, _mm_loadu_si128((const __m128i *)(a + i) + 3));
+        _mm_storeu_si128((__m128i *)(r + i) + 0, r0);
+        _mm_storeu_si128((__m128i *)(r + i) + 1, r1);
+        _mm_storeu_si128((__m128i *)(r + i) + 2, r2);
+        _mm_storeu_si128((__m128i *)(r + i) + 3, r3);
+    }
+    for (; i + 16 <= n; i += 16)
+    {
+        r0 = _mm_loadu_si128((const __m128i *)(r + i));
+        r0 = _mm_xor_si128(r0, _mm_loadu_si128((const __m128i *)(a + i)));
+        _mm_storeu_si128((__m128i *)(r + i), r0);
+    }
+#endif
+    /* Copies compile to unaligned loads and stores of words. */
+    for (; i + 8 <= n; i += 8)
+    {
+        memcpy(&w, r + i, sizeof(w));
+        memcpy(&v, a + i, sizeof(v));
+        w ^= v;
+        memcpy(r + i, &w, sizeof(w));
+    }
+    for (; i < n; i++)
+        r[i] ^= a[i];
+}
+
+/**
+ * Create a new number object.
+ *
+ * @param [in]  len  The length of the secret in bytes.
+ * @param [out] num  The new number object.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_num_new(uint16_t len, void **num)
+{
+    SHARE_ERR err = NONE;
+    size_t words = ((size_t)len + 7) / 8;
+    uint64_t *n;
+
+    n = share_malloc((words + 1) * sizeof(*n));
+    if (n == NULL)
+    {
+        err = ALLOC;
+        goto end;
+    }
+    memset(n, 0, (words + 1) * sizeof(*n));
+    n[0] = words;
+
+    *num = n;
+end:
+    return err;
+}
+
+/**
+ * Free the dynamic memory associated with the number object.
+ * The data is zeroized as it may be a split of the secret.
+ *
+ * @param [in] num  The number object.
+ */
+void share_xor_num_free(void *num)
+{
+    if (num != NULL)
+    {
+        share_zeroize(NUM_BYTES(num), NUM_WORDS(num) * 8);
+        share_free(num);
+    }
+}
+
+/**
+ * Initialize a number object in memory provided by the caller.
+ *
+ * @param [in]  len   The length of the secret in bytes.
+ * @param [in]  num   The memory to initialize as a number object. May be NULL.
+ * @param [out] size  The number of bytes of a number object.
+ * @return  NONE.
+ */
+SHARE_ERR share_xor_num_init(uint16_t len, void *num, size_t *size)
+{
+    size_t words = ((size_t)len + 7) / 8;
+    uint64_t *n = num;
+
+    if (n != NULL)
+    {
+        memset(n, 0, (words + 1) * sizeof(*n));
+        n[0] = words;
+    }
+    *size = (words + 1) * sizeof(*n);
+
+    return NONE;
+}
+
+/**
+ * Decode the data into a number object.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in data.
+ * @param [in] num   The number object.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_num_from_bin(const uint8_t *data, uint16_t len, void *num)
+{
+    SHARE_ERR err = NONE;
+    size_t bytes = NUM_WORDS(num) * 8;
+
+    if (len > bytes)
+    {
+        err = PARAM_BAD_LEN;
+        goto end;
+    }
+
+    memset(NUM_BYTES(num), 0, bytes - len);
+    memcpy(NUM_BYTES(num) + bytes - len, data, len);
+end:
+    return err;
+}
+
+/**
+ * Encode the number object into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The number object.
+ * @param [in] data  The data to hold the encoding.
+ * @param [in] len   The number of bytes that data can hold.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_num_to_bin(void *num, uint8_t *data, uint16_t len)
+{
+    SHARE_ERR err = NONE;
+    size_t bytes = NUM_WORDS(num) * 8;
+    size_t i;
+
+    if (len >= bytes)
+    {
+        /* Longer data is padded on the left with zeros. */
+        memset(data, 0, len - bytes);
+        memcpy(data + len - bytes, NUM_BYTES(num), bytes);
+        goto end;
+    }
+
+    /* The bytes of the padding of the words must be zero. */
+    for (i=0; i<bytes-len; i++)
+    {
+        if (NUM_BYTES(num)[i] != 0)
+        {
+            err = PARAM_BAD_LEN;
+            goto end;
+        }
+    }
+    memcpy(data, NUM_BYTES(num) + bytes - len, len);
+end:
+    return err;
+}
+
+/**
+ * Decode many items of data into number objects.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] data  The data to decode.
+ * @param [in] len   The number of bytes in each item of data.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of items of data and number objects.
+ * @return  PARAM_BAD_LEN when data is too long for a number.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_num_from_bin_n(const uint8_t *data, uint16_t len,
+    uint16_t step, void **num, uint16_t cnt)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_xor_num_from_bin(data + (size_t)i * step, len, num[i]);
+
+    return err;
+}
+
+/**
+ * Encode many number objects into data.
+ * The data is assumed to be big-endian bytes.
+ *
+ * @param [in] num   The array of number objects.
+ * @param [in] cnt   The number of number objects and items of data.
+ * @param [in] data  The data to hold the encodings.
+ * @param [in] len   The number of bytes that each item of data can hold.
+ * @param [in] step  The number of bytes from the start of one item of data to
+ *                   the next.
+ * @return  PARAM_BAD_LEN when encoding is too long for data.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_num_to_bin_n(void **num, uint16_t cnt, uint8_t *data,
+    uint16_t len, uint16_t step)
+{
+    SHARE_ERR err = NONE;
+    uint16_t i;
+
+    for (i=0; (err == NONE) && (i<cnt); i++)
+        err = share_xor_num_to_bin(num[i], data + (size_t)i * step, len);
+
+    return err;
+}
+
+/**
+ * Get the index of a split from the x value.
+ *
+ * @param [in] x  The x value as a number object.
+ * @return  The index of the split. Indices that don't fit in 32 bits are
+ *          returned as 0 - not a valid index.
+ */
+static uint32_t xor_index(void *x)
+{
+    size_t bytes = NUM_WORDS(x) * 8;
+    uint8_t *b = NUM_BYTES(x);
+    uint32_t idx = 0;
+    size_t i;
+
+    for (i=0; i+4<bytes; i++)
+    {
+        if (b[i] != 0)
+            return 0;
+    }
+    for (; i<bytes; i++)
+        idx = (idx << 8) | b[i];
+
+    return idx;
+}
+
+/**
+ * Calculate the y value of a split.
+ * The x value is the index of the split: 1..parts.
+ * The first parts-1 splits are the random coefficients and the last split is
+ * the XOR of the secret and the random coefficients:
+ *   y = a[x]                                 when x < parts
+ *   y = a[0] ^ a[1] ^ .. ^ a[parts-1]        when x = parts
+ *
+ * @param [in] prime  The prime as a number object. Not used.
+ * @param [in] parts  The number of parts that are required to recalcuate
+ *                    secret.
+ * @param [in] a      The array of coefficients.
+ * @param [in] x      The x value as a number object.
+ * @param [in] y      The y value as a number object.
+ * @return  PARAM_BAD_VALUE when x is not the index of a split.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_split(void *prime, uint16_t parts, void **a, void *x,
+    void *y)
+{
+    SHARE_ERR err = NONE;
+    uint32_t idx = xor_index(x);
+    size_t words = NUM_WORDS(y);
+    uint16_t i;
+
+    prime = prime;
+
+    if ((idx == 0) || (idx > parts))
+    {
+        err = PARAM_BAD_VALUE;
+        goto end;
+    }
+
+    if (idx < parts)
+    {
+        memcpy(NUM_BYTES(y), NUM_BYTES(a[idx]), words * 8);
+        goto end;
+    }
+
+    memcpy(NUM_BYTES(y), NUM_BYTES(a[0]), words * 8);
+    for (i=1; i<parts; i++)
+        share_xor_bytes(NUM_BYTES(y), NUM_BYTES(a[i]), words * 8);
+end:
+    return err;
+}
+
+/**
+ * Calculate the secret from splits.
+ * secret = y[0] ^ y[1] ^ .. ^ y[parts-1]
+ * Each index from 1 to parts must be in the x values exactly once.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] x        The array of x values as number objects.
+ * @param [in] y        The array of y values as number objects.
+ * @param [in] secret   The calculated secret as a number object.
+ * @param [in] scratch  Not used.
+ * @return  INVALID_DATA when an index is invalid or repeated.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_join(void *prime, uint16_t parts, void **x, void **y,
+    void *secret, void *scratch)
+{
+    SHARE_ERR err = NONE;
+    uint8_t seen[(SHARE_PARTS_MAX + 8) / 8];
+    size_t words = NUM_WORDS(secret);
+    uint32_t idx;
+    uint16_t i;
+
+    prime = prime;
+    scratch = scratch;
+
+    memset(seen, 0, sizeof(seen));
+    for (i=0; i<parts; i++)
+    {
+        idx = xor_index(x[i]);
+        if ((idx == 0) || (idx > parts) || (seen[idx / 8] & (1 << (idx & 7))))
+        {
+            err = INVALID_DATA;
+            goto end;
+        }
+        seen[idx / 8] |= 1 << (idx & 7);
+    }
+
+    memcpy(NUM_BYTES(secret), NUM_BYTES(y[0]), words * 8);
+    for (i=1; i<parts; i++)
+        share_xor_bytes(NUM_BYTES(secret), NUM_BYTES(y[i]), words * 8);
+end:
+    return err;
+}
+
+/**
+ * Calculate the x and y values of many splits at once.
+ * The x value of a split is its index, starting at 1. There are only parts
+ * splits.
+ *
+ * @param [in] prime    The prime as a number object. Not used.
+ * @param [in] parts    The number of parts that are required to recalcuate
+ *                      secret.
+ * @param [in] a        The array of coefficients.
+ * @param [in] first    The index of the first split to calculate, from 0.
+ * @param [in] num      The number of splits to calculate.
+ * @param [in] data     The encoded x and y values of the splits.
+ * @param [in] len      The number of bytes in the encoding of an x or a y.
+ * @param [in] scratch  Not used.
+ * @return  FAILED when there are no more splits or the index doesn't fit in
+ *          the encoding of an x.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR share_xor_split_all(void *prime, uint16_t parts, void **a,
+    uint32_t first, uint16_t num, uint8_t *data, uint16_t len, void *scratch)
+{
+    SHARE_ERR err = NONE;
+    size_t words = NUM_WORDS(a[0]);
+    uint32_t idx, i;
+    uint16_t j;
+
+    prime = prime;
+    scratch = scratch;
+
+    if ((first > parts) || (num > parts - first) ||
+        ((len < 4) && (first + num >= ((uint32_t)1 << (8 * len)))))
+    {
+        err = FAILED;
+        goto end;
+    }
+
+    for (i=0; i<num; i++)
+    {
+        idx = first + i + 1;
+
+        /* X - the index in big-endian bytes. */
+        memset(data, 0, len);
+        for (j=0; (j<len) && (j<4); j++)
+            data[len - 1 - j] = (uint8_t)(idx >> (8 * j));
+        data += len;
+
+        /* Y - the last split is the XOR of all coefficients. */
+        err = share_xor_num_to_bin(a[(idx < parts) ? idx : 0], data, len);
+        if (err != NONE) goto end;
+        if (idx == parts)
+        {
+            for (j=1; j<parts; j++)
+                share_xor_bytes(data, NUM_BYTES(a[j]) + words * 8 - len, len);
+        }
+        data += len;
+    }
+
+end:
+    return err;
+}
+
+/**
+ * Get the size of the scratch space that join and split_all need.
+ *
+ * @param [in]  prime  The prime as a number object. Not used.
+ * @param [in]  parts  The number of parts that are required to recalcuate
+ *                     secret.
+ * @param [out] size   The number of bytes of scratch space. Always 0.
+ * @return  NONE.
+ */
+SHARE_ERR share_xor_scratch(void *prime, uint16_t parts, size_t *size)
+{
+    prime = prime;
+    parts = parts;
+
+    *size = 0;
+
+    return NONE;
+}
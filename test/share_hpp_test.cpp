@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016 Sean Parkinson (sparkinson@iprimus.com.au)
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include "share.hpp"
+
+/* The split lengths are known at compile time. */
+static_assert(share::Share<60, 2>::split_len == 16, "P60 split length");
+static_assert(share::Share<254, 2>::split_len == 66, "Default prime split");
+static_assert(share::Share<254, 2, SHARE_METHS_FLAG_P254>::split_len == 64,
+    "P254 split length");
+static_assert(share::Share<128, 2, SHARE_METHS_FLAG_BINARY>::split_len == 32,
+    "GF(2^128) split length");
+
+/*
+ * Test splitting and joining a secret with a compile time length and number
+ * of parts. The splits are joined with the first and the last parts splits.
+ *
+ * @tparam Bits   The length of the secret in bits.
+ * @tparam Parts  The number of parts required to recreate secret.
+ * @tparam Flags  The extra requirements on the methods to choose.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+template <std::uint16_t Bits, std::uint16_t Parts, std::uint32_t Flags = 0>
+int test_share()
+{
+    using S = share::Share<Bits, Parts, Flags>;
+    /* Large with many parts - not on the stack. */
+    static S s;
+    typename S::Secret secret{}, joined{};
+    typename S::template Splits<Parts + 2> splits;
+    SHARE *c = nullptr;
+    SHARE_ERR err;
+    std::uint16_t len = 0;
+    std::size_t i;
+    int ret = 1;
+
+    std::fprintf(stderr, "hpp %d/%d/%d: %d", Bits, Parts, Flags, s.error());
+    if (s.error() != NONE)
+        goto end;
+
+    /* The C API has the same length of split. */
+    err = SHARE_new(Bits, Parts, Flags, &c);
+    if (err == NONE)
+        err = SHARE_get_len(c, &len);
+    SHARE_free(c);
+    std::fprintf(stderr, ", len: %d", len);
+    if ((err != NONE) || (len != S::split_len))
+        goto end;
+
+    for (i=0; i<secret.size(); i++)
+        secret[i] = (std::uint8_t)(i * 7 + 1);
+    if (Bits % 8)
+        secret[0] &= (1 << (Bits % 8)) - 1;
+
+    err = s.split(secret, splits);
+    std::fprintf(stderr, ", split: %d", err);
+    if (err != NONE)
+        goto end;
+    err = s.join(splits, joined);
+    std::fprintf(stderr, ", join: %d", err);
+    if ((err != NONE) || (joined != secret))
+        goto end;
+#if __cplusplus >= 202002L
+    joined = {};
+    err = s.join(std::span<const typename S::Split>(splits.data() + 2, Parts),
+        joined);
+    std::fprintf(stderr, ", join span: %d", err);
+    if ((err != NONE) || (joined != secret))
+        goto end;
+#endif
+
+    ret = 0;
+end:
+    std::fprintf(stderr, " (%s)%s\n", s.impl_name(),
+        (ret == 0) ? "" : " failed");
+    return ret;
+}
+
+/*
+ * The main entry point of program.
+ *
+ * @return  1 on test failure.<br>
+ *          0 otherwise.
+ */
+int main()
+{
+    int ret = 0;
+
+    ret |= test_share<8, 2>();
+    ret |= test_share<60, 2>();
+    ret |= test_share<61, 3>();
+    ret |= test_share<128, 5>();
+    ret |= test_share<128, 5, SHARE_METHS_FLAG_BINARY>();
+    ret |= test_share<192, 8>();
+    ret |= test_share<254, 3>();
+    ret |= test_share<254, 3, SHARE_METHS_FLAG_P254>();
+    ret |= test_share<255, 5, SHARE_METHS_FLAG_PUBLIC_X>();
+    ret |= test_share<256, 9>();
+    ret |= test_share<384, 11>();
+    ret |= test_share<520, 3>();
+    ret |= test_share<256, SHARE_PARTS_MAX_DIRECT>();
+
+    return ret;
+}
@@ -26,8 +26,9 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <string.h>
+#include <pthread.h>
 
-#include "share.h"
+#include "share_lcl.h"
 #include "random.h"
 
 /* The printf format of a 64-bit number */
@@ -39,13 +40,34 @@
 
 
 /* Valid length values for test. */
-static uint16_t valid[] = {126, 128, 192, 256};
+static uint16_t valid[] = {60, 126, 128, 192, 254, 256, 384, 520};
 /* The number of valid values for test. */
 #define VALID_NUM    (int)(sizeof(valid)/sizeof(*valid))
 
 /* Number of cycles/sec. */
 uint64_t cps = 0;
 
+/* Number of dynamic memory allocations. Volatile as the compiler assumes
+ * malloc doesn't change global variables. */
+volatile uint64_t alloc_cnt = 0;
+
+#ifdef SHARE_TEST_ALLOC_COUNT
+void *__real_malloc(size_t size);
+
+/*
+ * Count the dynamic memory allocations of the test and the library.
+ * The linker replaces calls to malloc with calls to this function.
+ *
+ * @param [in] size  The number of bytes to allocate.
+ * @return  The allocated memory or NULL on failure.
+ */
+void *__wrap_malloc(size_t size)
+{
+    alloc_cnt++;
+    return __real_malloc(size);
+}
+#endif
+
 /*
  * Get the current cycle count from the CPU.
  *
@@ -80,7 +102,7 @@ void calc_cps()
  * @param [in] secret  The secret to split.
  * @param [in] split   Array of split values as byte arrays.
  */
-void speed_split(SHARE *share, uint8_t parts, uint8_t num, uint8_t *secret,
+void speed_split(SHARE *share, uint16_t parts, uint16_t num, uint8_t *secret,
     uint8_t **split)
 {
     uint32_t i, j;
@@ -128,6 +150,51 @@ void speed_split(SHARE *share, uint8_t parts, uint8_t num, uint8_t *secret,
         diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
 }
 
+/*
+ * Calcuate the number of cycles and splits per second of splitting many at
+ * once. Implementations with lanes calculate a split in each lane at once.
+ *
+ * @param [in] share   The share object to split with.
+ * @param [in] num     The number of splits to create.
+ * @param [in] secret  The secret to split.
+ * @param [in] split   Buffer to hold num splits.
+ */
+void speed_split_n(SHARE *share, uint16_t num, uint8_t *secret,
+    uint8_t *split)
+{
+    uint32_t i;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+
+    SHARE_get_impl_name(share, &name);
+    SHARE_split_init(share, secret);
+
+    /* Prime the caches, etc */
+    for (i=0; i<10000; i++)
+        SHARE_split_n(share, split, num);
+
+    /* Approximate number of ops in a second. */
+    start = get_cycles();
+    for (i=0; i<1000; i++)
+        SHARE_split_n(share, split, num);
+    end = get_cycles();
+    num_ops = cps/((end-start)/1000);
+
+    /* Perform about 1 seconds worth of operations. */
+    start = get_cycles();
+    for (i=0; i<num_ops; i++)
+        SHARE_split_n(share, split, num);
+    end = get_cycles();
+
+    /* Report per split - one lane of work. */
+    diff = end - start;
+    num_ops *= num;
+
+    printf(" lane: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", num_ops,
+        diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+}
+
 /*
  * Calcuate the number of cycles and operations per second of joining.
  *
@@ -136,7 +203,8 @@ void speed_split(SHARE *share, uint8_t parts, uint8_t num, uint8_t *secret,
  * @param [in] split   Array of split values as byte arrays.
  * @param [in] secret  Array to hold secret.
  */
-void speed_join(SHARE *share, uint8_t parts, uint8_t **split, uint8_t *secret)
+void speed_join(SHARE *share, uint16_t parts, uint8_t **split,
+    uint8_t *secret)
 {
     uint32_t i, j;
     uint32_t num_ops;
@@ -183,19 +251,73 @@ void speed_join(SHARE *share, uint8_t parts, uint8_t **split, uint8_t *secret)
         diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
 }
 
+/*
+ * Calcuate the number of cycles and operations per second of inverting a
+ * number modulo the prime of the implementation.
+ *
+ * @param [in] share   The share object with the implementation to use.
+ * @param [in] secret  The secret to use as the number to invert.
+ */
+void speed_inv(SHARE *share, uint8_t *secret)
+{
+    uint32_t i;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+    SHARE_METH *meth = share->meth;
+    void *a = NULL, *r = NULL;
+
+    /* Not all implementations expose inversion. */
+    if (meth->num_inv == NULL)
+        return;
+
+    SHARE_get_impl_name(share, &name);
+    if (meth->num_new(share->prime_len, &a) != NONE) goto end;
+    if (meth->num_new(share->prime_len, &r) != NONE) goto end;
+    if (meth->num_from_bin(secret, share->len, a) != NONE) goto end;
+
+    /* Prime the caches, etc */
+    for (i=0; i<1000; i++)
+        meth->num_inv(share->prime, a, r);
+
+    /* Approximate number of ops in a second. */
+    start = get_cycles();
+    for (i=0; i<1000; i++)
+        meth->num_inv(share->prime, a, r);
+    end = get_cycles();
+    num_ops = cps/((end-start)/1000);
+
+    /* Perform about 1 seconds worth of operations. */
+    start = get_cycles();
+    for (i=0; i<num_ops; i++)
+        meth->num_inv(share->prime, a, r);
+    end = get_cycles();
+
+    diff = end - start;
+
+    printf("  inv: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", num_ops,
+        diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+end:
+    if (r != NULL) meth->num_free(r);
+    if (a != NULL) meth->num_free(a);
+}
+
 /*
  * Test an implementation of secret splitting.
  *
- * @param [in] length  The length of the secret in bits.
- * @param [in] parts   The number of parts required to recreate secret.
- * @param [in] flags   The extra requirements on the methods to choose.
- * @param [in] num     The number of splits to create.
- * @param [in] speed   Indicates whether to calculate speed of operations.
+ * @param [in] length     The length of the secret in bits.
+ * @param [in] prime      The prime supplied by the caller. NULL to use the
+ *                        built-in prime.
+ * @param [in] prime_len  The length of the prime in bytes.
+ * @param [in] parts      The number of parts required to recreate secret.
+ * @param [in] flags      The extra requirements on the methods to choose.
+ * @param [in] num        The number of splits to create.
+ * @param [in] speed      Indicates whether to calculate speed of operations.
  * @return  0 on successful testing.<br>
  *          1 otherwise.
  */
-int test_share(uint16_t length, uint8_t parts, uint32_t flags, uint8_t num,
-    uint8_t speed)
+int test_share(uint16_t length, const uint8_t *prime, uint16_t prime_len,
+    uint16_t parts, uint32_t flags, uint16_t num, uint8_t speed)
 {
     int ret = 1;
     SHARE_ERR err;
@@ -203,12 +325,18 @@ int test_share(uint16_t length, uint8_t parts, uint32_t flags, uint8_t num,
     uint8_t *secret = NULL;
     uint8_t *sec = NULL;
     uint8_t **split = NULL;
+    uint8_t *all = NULL;
     uint32_t i, j;
     uint16_t len;
     uint16_t l = (length + 7) / 8;
+    uint64_t allocs;
 
     /* Create share object for joing and splitting. */
-    err = SHARE_new(length, parts, flags, &share);
+    if (prime == NULL)
+        err = SHARE_new(length, parts, flags, &share);
+    else
+        err = SHARE_new_with_prime(length, prime, prime_len, parts, flags,
+            &share);
     fprintf(stderr, "new: %d", err);
     if (err != NONE) goto end;
 
@@ -234,7 +362,8 @@ int test_share(uint16_t length, uint8_t parts, uint32_t flags, uint8_t num,
         if (split[i] == NULL) goto end;
     }
 
-    /* Split */
+    /* Split - no dynamic memory is allocated splitting or joining. */
+    allocs = alloc_cnt;
     err = SHARE_split_init(share, secret);
     fprintf(stderr, ", split init: %d", err);
     if (err != NONE) goto end;
@@ -282,14 +411,76 @@ int test_share(uint16_t length, uint8_t parts, uint32_t flags, uint8_t num,
             goto end;
         }
     }
+    if (alloc_cnt != allocs)
+    {
+        fprintf(stderr, ", allocs: %"PRIu64, alloc_cnt - allocs);
+        goto end;
+    }
+
+    /* Split many at once and join with the last ones generated. */
+    all = malloc(num * len);
+    if (all == NULL) goto end;
+    allocs = alloc_cnt;
+    err = SHARE_split_init(share, secret);
+    if (err != NONE) goto end;
+    err = SHARE_split_n(share, all, num);
+    fprintf(stderr, ", split n: %d", err);
+    if (err != NONE) goto end;
+    err = SHARE_join_init(share);
+    if (err != NONE) goto end;
+    for (i=0; i<parts; i++)
+    {
+        err = SHARE_join_update(share, &all[(num - 1 - i) * len]);
+        if (err != NONE) goto end;
+    }
+    err = SHARE_join_final(share, sec);
+    fprintf(stderr, ", final: %d", err);
+    if (err != NONE) goto end;
+    for (i=0; i<l; i++)
+    {
+        if (sec[i] != secret[i])
+        {
+            fprintf(stderr, " %02x/%02x (%d)", sec[i], secret[i], i);
+            goto end;
+        }
+    }
+
+    /* Join the first ones generated all at once. */
+    err = SHARE_join_init(share);
+    if (err != NONE) goto end;
+    err = SHARE_join_update_n(share, all, num);
+    fprintf(stderr, ", update n: %d", err);
+    if (err != NONE) goto end;
+    err = SHARE_join_final(share, sec);
+    fprintf(stderr, ", final: %d", err);
+    if (err != NONE) goto end;
+    for (i=0; i<l; i++)
+    {
+        if (sec[i] != secret[i])
+        {
+            fprintf(stderr, " %02x/%02x (%d)", sec[i], secret[i], i);
+            goto end;
+        }
+    }
+    if (alloc_cnt != allocs)
+    {
+        fprintf(stderr, ", allocs: %"PRIu64, alloc_cnt - allocs);
+        goto end;
+    }
     fprintf(stderr, "\n");
 
     if (speed)
     {
         printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs", "c/op",
             "ops/s", "Impl");
+        allocs = alloc_cnt;
         speed_split(share, parts, num, secret, split);
+        speed_split_n(share, num, secret, all);
         speed_join(share, parts, split, secret);
+        /* The benchmarked operations must not allocate. */
+        printf("allocs: %"PRIu64"\n", alloc_cnt - allocs);
+        if (alloc_cnt != allocs) goto end;
+        speed_inv(share, secret);
     }
     else
     {
@@ -316,6 +507,7 @@ end:
             if (split[i] != NULL) free(split[i]);
         free(split);
     }
+    if (all != NULL) free(all);
     if (secret != NULL) free(secret);
     if (sec != NULL) free(sec);
     SHARE_free(share);
@@ -323,89 +515,2354 @@ end:
 }
 
 /*
- * The main entry point of program.
+ * Calcuate the number of cycles and the rate of splitting and joining a secret
+ * of any length in GF(2^8).
  *
- * @param [in] argc  The count of command line arguments.
- * @param [in] argv  The command line arguments.
- * @return  1 on test failure.<br>
- *          0 otherwise.
+ * @param [in] share   The share object to split and join with.
+ * @param [in] parts   The number of parts required to recreate secret.
+ * @param [in] num     The number of splits to create.
+ * @param [in] secret  The secret to split.
+ * @param [in] split   Array of split values as byte arrays.
+ * @param [in] sec     Array to hold secret.
+ * @param [in] op      The operation to calculate speed of: 0 split, 1 join.
  */
-int main(int argc, char *argv[])
+void speed_gf8(SHARE_GF8 *share, uint8_t parts, uint8_t num, uint8_t *secret,
+    uint8_t **split, uint8_t *sec, int op)
 {
-    int ret = 0;
-    uint8_t i;
-    uint16_t s;
-    uint8_t parts = 2;
-    uint8_t num = 3;
-    uint16_t which = 0;
-    uint8_t speed = 0;
-    uint32_t flags = 0;
+    uint32_t i, j, len;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
 
-    while (--argc)
-    {
-        argv++;
+    SHARE_GF8_get_impl_name(share, &name);
+    SHARE_GF8_get_len(share, &len);
+    len--;
 
-        if (strcmp(*argv, "-speed") == 0)
-            speed = 1;
-        else if (strcmp(*argv, "-parts") == 0)
+    /* Approximate number of ops in a second. */
+    start = get_cycles();
+    for (i=0; i<10; i++)
+    {
+        if (op == 0)
         {
-            if (--argc == 0)
-            {
-                fprintf(stderr, "Number of parts missing from command line\n");
-                ret = 1;
-                goto end;
-            }
-            parts = atoi(*(++argv));
-            if ((parts < 2) || (parts > SHARE_PARTS_MAX))
-            {
-                fprintf(stderr, "Parts invalid: 2 <= %d <= %d\n", parts,
-                    SHARE_PARTS_MAX);
-                ret = 1;
-                goto end;
-            }
-            num = parts + 1;
+            SHARE_GF8_split_init(share, secret);
+            for (j=0; j<num; j++)
+                SHARE_GF8_split(share, split[j % parts]);
         }
-        else if (strcmp(*argv, "-num") == 0)
+        else
         {
-            if (--argc == 0)
-            {
-                fprintf(stderr, "Number of splits missing from command line\n");
-                ret = 1;
-                goto end;
-            }
-            num = atoi(*(++argv));
-            if (num <= parts)
-            {
-                fprintf(stderr, "Num invalid: %d < %d <= %d\n", parts, num,
-                    255);
-                ret = 1;
-                goto end;
-            }
+            SHARE_GF8_join_init(share);
+            for (j=0; j<parts; j++)
+                SHARE_GF8_join_update(share, split[j]);
+            SHARE_GF8_join_final(share, sec);
+        }
+    }
+    end = get_cycles();
+    num_ops = cps/((end-start)/10 + 1) + 1;
+
+    /* Perform about 1 seconds worth of operations. */
+    start = get_cycles();
+    for (i=0; i<num_ops; i++)
+    {
+        if (op == 0)
+        {
+            SHARE_GF8_split_init(share, secret);
+            for (j=0; j<num; j++)
+                SHARE_GF8_split(share, split[j % parts]);
         }
-        else if (strcmp(*argv, "-gen") == 0)
-            flags |= SHARE_METHS_FLAG_GENERIC;
         else
         {
-            s = atoi(*argv);
-            /* If strength value is valid then set corresponding bit. */
-            for (i=0; i<VALID_NUM; i++)
-            {
-                if (valid[i] == s)
-                    which |= 1<<i;
-            }
+            SHARE_GF8_join_init(share);
+            for (j=0; j<parts; j++)
+                SHARE_GF8_join_update(share, split[j]);
+            SHARE_GF8_join_final(share, sec);
         }
     }
+    end = get_cycles();
 
-    printf("Parts: %d, Num: %d\n", parts, num);
+    /* Report the rate of secret bytes through the operation. */
+    diff = end - start;
 
-    if (speed)
-        calc_cps();
+    printf("%5s: %7d %2.3f  %7"PRIu64" %7.1f  %s\n", op == 0 ? "split" : "join",
+        num_ops, diff/(cps*1.0), diff/num_ops,
+        (double)len * num_ops / (diff/(cps*1.0)) / 1000000.0, name);
+}
+
+/*
+ * Test the GF(2^8) multiply and sum implementations give the same result as
+ * the C implementation. Only those supported by the CPU are tested.
+ *
+ * @param [in] len  The length of the rows in bytes.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_gf8_mul_sum(uint32_t len)
+{
+    int ret = 1;
+    uint8_t *rows = NULL;
+    uint8_t *r = NULL;
+    uint8_t *e = NULL;
+    uint8_t m[16];
+    uint32_t cpu = share_cpu_features();
 
-    /* Test all prime lengths requested. */
-    for (i=0; i<VALID_NUM; i++)
+    rows = malloc(16 * len);
+    if (rows == NULL) goto end;
+    r = malloc(len);
+    if (r == NULL) goto end;
+    e = malloc(len);
+    if (e == NULL) goto end;
+    pseudo_random(rows, 16 * len);
+    pseudo_random(m, sizeof(m));
+
+    share_gf8_c_mul_sum(rows, len, 16, m, e, len);
+#ifdef CPU_X86_64
+    if ((cpu & SHARE_CPU_SSSE3) != 0)
     {
-        if ((which == 0) || ((which & (1<<i)) != 0))
-            ret |= test_share(valid[i], parts, flags, num, speed);
+        share_gf8_ssse3_mul_sum(rows, len, 16, m, r, len);
+        fprintf(stderr, ", ssse3: %d", memcmp(r, e, len) != 0);
+        if (memcmp(r, e, len) != 0) goto end;
+    }
+    if ((cpu & SHARE_CPU_AVX2) != 0)
+    {
+        share_gf8_avx2_mul_sum(rows, len, 16, m, r, len);
+        fprintf(stderr, ", avx2: %d", memcmp(r, e, len) != 0);
+        if (memcmp(r, e, len) != 0) goto end;
+    }
+#else
+    (void)cpu;
+#endif
+
+    ret = 0;
+end:
+    if (rows != NULL) free(rows);
+    if (r != NULL) free(r);
+    if (e != NULL) free(e);
+    return ret;
+}
+
+/* The NIST P-256 prime: 2^256 - 2^224 + 2^192 + 2^96 - 1 */
+static const uint8_t p256_nist[] =
+{
+    0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/*
+ * Test secret splitting with primes supplied by the caller.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @param [in] num    The number of splits to create.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_share_prime(uint16_t parts, uint32_t flags, uint16_t num,
+    uint8_t speed)
+{
+    int ret = 0;
+    SHARE *share = NULL;
+    /* The Mersenne prime 2^3217 - 1 */
+    uint8_t m3217[403];
+#ifdef SHARE_USE_OPENSSL
+    /* The Mersenne prime 2^4423 - 1 - longer than the Montgomery generic. */
+    uint8_t m4423[553];
+#endif
+
+    ret |= test_share(255, p256_nist, sizeof(p256_nist), parts, flags, num,
+        speed);
+
+    /* Joining with a large prime is too slow to time. */
+    if (!speed)
+    {
+        memset(m3217, 0xff, sizeof(m3217));
+        m3217[0] = 0x01;
+        ret |= test_share(3216, m3217, sizeof(m3217), parts, flags, num, 0);
+#ifdef SHARE_USE_OPENSSL
+        memset(m4423, 0xff, sizeof(m4423));
+        m4423[0] = 0x7f;
+        ret |= test_share(4422, m4423, sizeof(m4423), parts, flags, num, 0);
+#endif
+    }
+
+    /* An even prime and a secret as long as the prime are invalid. */
+    if (SHARE_new_with_prime(255, p256_nist, sizeof(p256_nist) - 1, parts,
+        flags, &share) != PARAM_BAD_VALUE)
+    {
+        ret = 1;
+    }
+    if (SHARE_new_with_prime(256, p256_nist, sizeof(p256_nist), parts, flags,
+        &share) != PARAM_BAD_VALUE)
+    {
+        ret = 1;
+    }
+
+    return ret;
+}
+
+/* A 254-bit secret and three splits of it made with the default prime,
+ * 2^257-0x5d, before the prime 2^255-19 was added. Join takes the splits as
+ * modifiable data. */
+static const uint8_t compat_254_secret[32] =
+{
+    0x25, 0x36, 0x47, 0x58, 0x69, 0x7a, 0x8b, 0x9c,
+    0xad, 0xbe, 0xcf, 0xe0, 0xf1, 0x02, 0x13, 0x24,
+    0x35, 0x46, 0x57, 0x68, 0x79, 0x8a, 0x9b, 0xac,
+    0xbd, 0xce, 0xdf, 0xf0, 0x01, 0x12, 0x23, 0x34
+};
+static uint8_t compat_254_split[3][66] =
+{
+    {
+        0x00, 0x2c, 0x3a, 0xbf, 0xc1, 0x3f, 0x1e, 0x73,
+        0x7c, 0x9e, 0x74, 0xff, 0x4d, 0xf8, 0xc5, 0x15,
+        0x4c, 0x3e, 0x54, 0x47, 0x99, 0xb1, 0x8e, 0x43,
+        0x08, 0xe0, 0xa9, 0x8d, 0x78, 0x89, 0x66, 0x38,
+        0x5f, 0x00, 0xd9, 0x33, 0x52, 0x4e, 0xf3, 0x8a,
+        0x75, 0x41, 0x57, 0x28, 0x7b, 0xf9, 0xef, 0xf1,
+        0x6e, 0x5e, 0x35, 0x2f, 0x57, 0xfb, 0x66, 0x64,
+        0x44, 0xee, 0x5f, 0x40, 0x72, 0x2d, 0xd8, 0x97,
+        0x84, 0x6f
+    },
+    {
+        0x00, 0x0d, 0x5d, 0x37, 0x9c, 0xc8, 0x68, 0x69,
+        0x2d, 0x79, 0x00, 0xcd, 0x28, 0x41, 0x6d, 0x8f,
+        0x7b, 0x54, 0x32, 0x68, 0xd9, 0x71, 0x47, 0x8b,
+        0x8a, 0xd5, 0xad, 0x4a, 0xa4, 0x3e, 0x18, 0xed,
+        0x4a, 0x01, 0xcf, 0x1b, 0x63, 0x5e, 0x68, 0xa0,
+        0x53, 0x26, 0x2b, 0x57, 0xa7, 0x79, 0x38, 0xee,
+        0x4c, 0x06, 0xfa, 0x6d, 0x50, 0x4d, 0xf9, 0xf7,
+        0x49, 0x7e, 0x1a, 0xb7, 0xb5, 0x74, 0x49, 0xfb,
+        0xd1, 0x1a
+    },
+    {
+        0x00, 0x20, 0x50, 0x83, 0xa8, 0x98, 0x37, 0x8a,
+        0xc9, 0x8c, 0x3b, 0x3f, 0xdc, 0xbf, 0x11, 0xa4,
+        0x93, 0x61, 0xb3, 0x49, 0x7b, 0x62, 0x05, 0x6e,
+        0xea, 0x24, 0x48, 0x48, 0x5f, 0xe1, 0xe2, 0x38,
+        0x22, 0x01, 0xbc, 0xab, 0x22, 0x4c, 0x9f, 0x5d,
+        0xe6, 0xe7, 0x92, 0x71, 0x56, 0x6c, 0xeb, 0x5f,
+        0xb6, 0x4c, 0x9f, 0x87, 0x29, 0x9a, 0x3b, 0x0b,
+        0x69, 0xc4, 0x2b, 0x46, 0x6d, 0xd1, 0x08, 0x21,
+        0xce, 0x9c
+    }
+};
+
+/*
+ * Test that splits of a 254-bit secret made with the default prime still join
+ * and that the prime 2^255-19 is only used when required.
+ *
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_compat_254(uint32_t flags)
+{
+    int ret = 1;
+    SHARE_ERR err;
+    SHARE *share = NULL;
+    uint8_t sec[32];
+    uint16_t len = 0;
+
+    fprintf(stderr, "compat 254: ");
+    err = SHARE_new(254, 3, flags, &share);
+    if (err != NONE) goto end;
+    err = SHARE_get_len(share, &len);
+    fprintf(stderr, "len: %d", len);
+    if ((err != NONE) || (len != sizeof(*compat_254_split))) goto end;
+    err = SHARE_join_init(share);
+    if (err != NONE) goto end;
+    err = SHARE_join_update_n(share, compat_254_split[0], 3);
+    if (err != NONE) goto end;
+    err = SHARE_join_final(share, sec);
+    fprintf(stderr, ", final: %d", err);
+    if ((err != NONE) ||
+        (memcmp(sec, compat_254_secret, sizeof(sec)) != 0))
+    {
+        goto end;
+    }
+    SHARE_free(share);
+    share = NULL;
+
+    /* The prime 2^255-19 has 32-byte numbers. */
+    err = SHARE_new(254, 3, flags | SHARE_METHS_FLAG_P254, &share);
+    if (err != NONE) goto end;
+    err = SHARE_get_len(share, &len);
+    fprintf(stderr, ", p254 len: %d", len);
+    if ((err != NONE) || (len != 64)) goto end;
+    SHARE_free(share);
+    share = NULL;
+    /* Secrets longer than 254 bits are not supported by 2^255-19. */
+    err = SHARE_new(255, 3, flags | SHARE_METHS_FLAG_P254, &share);
+    fprintf(stderr, ", p254 255: %d", err);
+    if (err != NOT_FOUND) goto end;
+    err = NONE;
+
+    ret = 0;
+end:
+    fprintf(stderr, "\n");
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    SHARE_free(share);
+    return ret;
+}
+
+/*
+ * Test the GF(2^128) implementations give the same splits and inverses.
+ * Only those supported by the CPU are tested.
+ *
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_gf128_impls(void)
+{
+    int ret = 1;
+    uint8_t d[3][16];
+    uint64_t a0[2], a1[2], x[2], y[2], e[2];
+    void *a[2] = { a0, a1 };
+    uint32_t cpu = share_cpu_features();
+    int i;
+
+    for (i=0; i<100; i++)
+    {
+        pseudo_random(d[0], sizeof(d));
+        share_gf128_num_from_bin(d[0], 16, a0);
+        share_gf128_num_from_bin(d[1], 16, a1);
+        share_gf128_num_from_bin(d[2], 16, x);
+
+        /* e = a0 + a1.x */
+        share_gf128_split(NULL, 2, a, x, e);
+#ifdef CPU_X86_64
+        if ((cpu & SHARE_CPU_PCLMUL) != 0)
+        {
+            share_gf128_clmul_split(NULL, 2, a, x, y);
+            if ((y[0] != e[0]) || (y[1] != e[1]))
+            {
+                fprintf(stderr, "gf128 clmul: %d\n", i);
+                goto end;
+            }
+        }
+#else
+        (void)cpu;
+#endif
+
+        /* 0 + (1/x).x = 1 */
+        memset(a0, 0, sizeof(a0));
+        share_gf128_num_inv(NULL, x, a1);
+        share_gf128_split(NULL, 2, a, x, y);
+        if ((y[0] != 1) || (y[1] != 0))
+        {
+            fprintf(stderr, "gf128 inv: %d\n", i);
+            goto end;
+        }
+#ifdef CPU_X86_64
+        if ((cpu & SHARE_CPU_PCLMUL) != 0)
+        {
+            share_gf128_clmul_num_inv(NULL, x, y);
+            if ((y[0] != a1[0]) || (y[1] != a1[1]))
+            {
+                fprintf(stderr, "gf128 clmul inv: %d\n", i);
+                goto end;
+            }
+        }
+#endif
+    }
+
+    ret = 0;
+end:
+    return ret;
+}
+
+/*
+ * Split with one object and join with another, checking the secret.
+ * The splits are made one at a time and then many at once, and joined one at
+ * a time and then many at once.
+ *
+ * @param [in] s       The share object to split with.
+ * @param [in] j       The share object to join with.
+ * @param [in] parts   The number of parts required to recreate secret.
+ * @param [in] num     The number of splits to create.
+ * @param [in] len     The length of an encoded split in bytes.
+ * @param [in] l       The length of the secret in bytes.
+ * @param [in] secret  The secret to split.
+ * @param [in] sec     Buffer to hold the joined secret.
+ * @param [in] all     Buffer to hold num splits.
+ * @return  The error of the first operation to fail.<br>
+ *          INVALID_DATA when the joined secret is different.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR split_join_with(SHARE *s, SHARE *j, uint16_t parts, uint16_t num,
+    uint16_t len, uint16_t l, uint8_t *secret, uint8_t *sec, uint8_t *all)
+{
+    SHARE_ERR err;
+    uint16_t i;
+
+    err = SHARE_split_init(s, secret);
+    if (err != NONE) goto end;
+    for (i=0; i<num; i++)
+    {
+        err = SHARE_split(s, all + i * len);
+        if (err != NONE) goto end;
+    }
+    err = SHARE_join_init(j);
+    if (err != NONE) goto end;
+    for (i=0; i<parts; i++)
+    {
+        err = SHARE_join_update(j, all + (num - 1 - i) * len);
+        if (err != NONE) goto end;
+    }
+    err = SHARE_join_final(j, sec);
+    if (err != NONE) goto end;
+    if (memcmp(sec, secret, l) != 0)
+    {
+        err = INVALID_DATA;
+        goto end;
+    }
+
+    err = SHARE_split_init(s, secret);
+    if (err != NONE) goto end;
+    err = SHARE_split_n(s, all, num);
+    if (err != NONE) goto end;
+    err = SHARE_join_init(j);
+    if (err != NONE) goto end;
+    err = SHARE_join_update_n(j, all + (num - parts) * len, parts);
+    if (err != NONE) goto end;
+    err = SHARE_join_final(j, sec);
+    if (err != NONE) goto end;
+    if (memcmp(sec, secret, l) != 0)
+        err = INVALID_DATA;
+end:
+    return err;
+}
+
+/*
+ * Test every implementation method that the CPU supports, not just the one
+ * that is chosen. Splits made with each method are joined by the chosen
+ * method, and the other way, so that all methods of a field agree.
+ * Generic methods use the default prime and agree with its implementation.
+ *
+ * @param [in] parts  The number of parts required to recreate secret, unless
+ *                    the method is specialized for a number of parts.
+ * @param [in] num    The number of splits to create.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_meths(uint16_t parts, uint16_t num)
+{
+    int ret = 1;
+    SHARE_ERR err = NONE;
+    SHARE_METH *meth;
+    SHARE *share = NULL;
+    SHARE *ref = NULL;
+    uint8_t secret[66], sec[66];
+    uint8_t *all = NULL;
+    uint32_t cpu = share_cpu_features();
+    uint32_t flags;
+    uint16_t len, bits, p, n;
+    int16_t i;
+    int k;
+
+    for (i=0; share_meths_get_idx(i, &meth) == NONE; i++)
+    {
+        fprintf(stderr, "meth %s: ", meth->name);
+        if ((meth->cpu & cpu) != meth->cpu)
+        {
+            fprintf(stderr, "skipped\n");
+            continue;
+        }
+
+        /* The field and secret length of the method. */
+        flags = meth->flags & (SHARE_METHS_FLAG_BINARY | SHARE_METHS_FLAG_NTT |
+            SHARE_METHS_FLAG_XOR | SHARE_METHS_FLAG_P254);
+        bits = meth->len;
+        if ((meth->flags & (SHARE_METHS_FLAG_GENERIC | SHARE_METHS_FLAG_XOR)) ||
+            (bits == 0))
+        {
+            bits = 256;
+        }
+        p = (meth->parts != 0) ? meth->parts : parts;
+        if (p > SHARE_PARTS_MAX_FLAGS(meth->flags))
+        {
+            fprintf(stderr, "skipped\n");
+            continue;
+        }
+        /* XOR has only parts splits. */
+        n = (flags & SHARE_METHS_FLAG_XOR) ? p : ((num > p) ? num : p + 1);
+
+        for (k=0; k<2; k++)
+        {
+            /* Constant time and variable time joins. */
+            err = share_new_meth(bits, p, flags |
+                ((k == 0) ? 0 : SHARE_METHS_FLAG_PUBLIC_X), meth, &share);
+            if (err != NONE) goto end;
+            err = SHARE_new(bits, p, flags, &ref);
+            if (err != NONE) goto end;
+            err = SHARE_get_len(share, &len);
+            if (err != NONE) goto end;
+
+            all = malloc(n * len);
+            if (all == NULL) goto end;
+            pseudo_random(secret, (bits + 7) / 8);
+            if (bits & 7)
+                secret[0] >>= 8 - (bits & 7);
+
+            err = split_join_with(share, share, p, n, len, (bits + 7) / 8,
+                secret, sec, all);
+            fprintf(stderr, "%sfinal: %d", (k == 0) ? "" : ", ", err);
+            if (err != NONE) goto end;
+            err = split_join_with(share, ref, p, n, len, (bits + 7) / 8,
+                secret, sec, all);
+            fprintf(stderr, ", ref join: %d", err);
+            if (err != NONE) goto end;
+            err = split_join_with(ref, share, p, n, len, (bits + 7) / 8,
+                secret, sec, all);
+            fprintf(stderr, ", ref split: %d", err);
+            if (err != NONE) goto end;
+
+            free(all);
+            all = NULL;
+            SHARE_free(ref);
+            ref = NULL;
+            SHARE_free(share);
+            share = NULL;
+        }
+        fprintf(stderr, "\n");
+    }
+
+    ret = 0;
+end:
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    SHARE_free(share);
+    SHARE_free(ref);
+    if (all != NULL) free(all);
+    return ret;
+}
+
+/*
+ * Calcuate the number of cycles and operations per second of dealing many
+ * splits of a secret in one call.
+ *
+ * @param [in] share   The share object to split with.
+ * @param [in] num     The number of splits to deal.
+ * @param [in] secret  The secret to split.
+ * @param [in] split   Buffer to hold num splits.
+ */
+void speed_deal(SHARE *share, uint16_t num, uint8_t *secret, uint8_t *split)
+{
+    uint32_t i;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+
+    SHARE_get_impl_name(share, &name);
+
+    /* Prime the caches, etc */
+    for (i=0; i<10; i++)
+    {
+        SHARE_split_init(share, secret);
+        SHARE_split_n(share, split, num);
+    }
+
+    /* Approximate number of ops in a second. */
+    start = get_cycles();
+    for (i=0; i<10; i++)
+    {
+        SHARE_split_init(share, secret);
+        SHARE_split_n(share, split, num);
+    }
+    end = get_cycles();
+    num_ops = cps/((end-start)/10);
+
+    /* Perform about 1 seconds worth of operations. */
+    start = get_cycles();
+    for (i=0; i<num_ops; i++)
+    {
+        SHARE_split_init(share, secret);
+        SHARE_split_n(share, split, num);
+    }
+    end = get_cycles();
+
+    diff = end - start;
+
+    printf(" deal: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", num_ops,
+        diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+}
+
+/*
+ * Compare two x values of splits for sorting.
+ *
+ * @param [in] a  The first x value.
+ * @param [in] b  The second x value.
+ * @return  Negative, zero or positive as a is less than, equal to or greater
+ *          than b.
+ */
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* The number of splits dealt in the number-theoretic transform test. */
+#define NTT_DEAL	4100
+
+/*
+ * Test dealing many splits at once with the number-theoretic transform.
+ * Dealing in one call and in many calls must give the same splits, all the x
+ * values must be different and any parts number of splits must join.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_ntt(uint16_t parts, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err;
+    SHARE *share = NULL;
+    SHARE *other = NULL;
+    uint8_t secret[8], sec[8];
+    uint8_t *all = NULL, *part = NULL;
+    uint64_t *x = NULL;
+    uint16_t len;
+    uint32_t i, j, o;
+    static const uint16_t chunks[] = { 1, 2, 5, 8, 100, 1000, 2984 };
+
+    err = SHARE_new(63, parts, SHARE_METHS_FLAG_NTT, &share);
+    if (err != NONE) goto end;
+    err = SHARE_get_len(share, &len);
+    if (err != NONE) goto end;
+
+    all = malloc(NTT_DEAL * len);
+    part = malloc(NTT_DEAL * len);
+    x = malloc(NTT_DEAL * sizeof(*x));
+    if ((all == NULL) || (part == NULL) || (x == NULL)) goto end;
+
+    pseudo_random(secret, sizeof(secret));
+    secret[0] &= 0x7f;
+
+    /* Deal all at once and then again in chunks. */
+    err = SHARE_split_init(share, secret);
+    if (err != NONE) goto end;
+    err = SHARE_split_n(share, all, NTT_DEAL);
+    if (err != NONE) goto end;
+    share->cnt = 0;
+    for (i=0, o=0; i<sizeof(chunks)/sizeof(*chunks); o+=chunks[i++])
+    {
+        err = SHARE_split_n(share, part + o * len, chunks[i]);
+        if (err != NONE) goto end;
+    }
+    if (memcmp(all, part, NTT_DEAL * len) != 0)
+    {
+        fprintf(stderr, "ntt: chunked deal differs\n");
+        goto end;
+    }
+
+    /* All x values are different. */
+    for (i=0; i<NTT_DEAL; i++)
+    {
+        x[i] = 0;
+        for (j=0; j<len/2; j++)
+            x[i] = (x[i] << 8) | all[i * len + j];
+    }
+    qsort(x, NTT_DEAL, sizeof(*x), cmp_u64);
+    for (i=1; i<NTT_DEAL; i++)
+    {
+        if (x[i-1] == x[i])
+        {
+            fprintf(stderr, "ntt: repeated x\n");
+            goto end;
+        }
+    }
+
+    /* Join splits spread across those dealt. */
+    for (o=0; o<NTT_DEAL; o+=1023)
+    {
+        err = SHARE_join_init(share);
+        if (err != NONE) goto end;
+        for (i=0; i<parts; i++)
+        {
+            err = SHARE_join_update(share, all + ((o + i * 997) % NTT_DEAL) *
+                len);
+            if (err != NONE) goto end;
+        }
+        err = SHARE_join_final(share, sec);
+        if ((err != NONE) || (memcmp(sec, secret, sizeof(sec)) != 0))
+        {
+            fprintf(stderr, "ntt: join %d failed\n", o);
+            goto end;
+        }
+    }
+
+    if (speed)
+    {
+        printf("Deal: %d\n", NTT_DEAL);
+        printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs", "c/op",
+            "ops/s", "Impl");
+        speed_deal(share, NTT_DEAL, secret, all);
+        /* Compare with splitting at random x values. */
+        if (parts <= SHARE_PARTS_MAX_DIRECT)
+        {
+            err = SHARE_new(60, parts, 0, &other);
+            if (err != NONE) goto end;
+            speed_deal(other, NTT_DEAL, secret, all);
+        }
+    }
+
+    ret = 0;
+end:
+    fprintf(stderr, "ntt: %d\n", ret);
+    SHARE_free(other);
+    if (x != NULL) free(x);
+    if (part != NULL) free(part);
+    if (all != NULL) free(all);
+    SHARE_free(share);
+    return ret;
+}
+
+/* The numbers of parts that the two joins of the number-theoretic transform
+ * prime are compared with. */
+static const uint16_t ntt_join_parts[] = {
+    2, 3, 32, 33, 64, 65, 100, 256, 257, 1000, 1024
+};
+
+/*
+ * Test the product tree join gives the same secret as the direct join of the
+ * number-theoretic transform prime.
+ *
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_ntt_join(void)
+{
+    int ret = 1;
+    uint64_t *xv = NULL, *yv = NULL;
+    void **x = NULL, **y = NULL;
+    void *scratch = NULL;
+    size_t scratch_len;
+    uint64_t e, r;
+    uint16_t parts;
+    uint32_t i, k;
+
+    xv = malloc(SHARE_PARTS_MAX * sizeof(*xv));
+    yv = malloc(SHARE_PARTS_MAX * sizeof(*yv));
+    x = malloc(SHARE_PARTS_MAX * sizeof(*x));
+    y = malloc(SHARE_PARTS_MAX * sizeof(*y));
+    if ((xv == NULL) || (yv == NULL) || (x == NULL) || (y == NULL)) goto end;
+    /* Scratch space for the most parts is enough for fewer parts. */
+    share_p64_ntt_scratch(NULL, SHARE_PARTS_MAX, &scratch_len);
+    scratch = malloc(scratch_len);
+    if (scratch == NULL) goto end;
+
+    for (k=0; k<sizeof(ntt_join_parts)/sizeof(*ntt_join_parts); k++)
+    {
+        parts = ntt_join_parts[k];
+        if (parts > SHARE_PARTS_MAX)
+            continue;
+
+        /* Random values less than the prime. */
+        pseudo_random((uint8_t *)xv, parts * sizeof(*xv));
+        pseudo_random((uint8_t *)yv, parts * sizeof(*yv));
+        for (i=0; i<parts; i++)
+        {
+            xv[i] >>= 1;
+            yv[i] >>= 1;
+            x[i] = &xv[i];
+            y[i] = &yv[i];
+        }
+
+        share_p64_ntt_join_quad(NULL, parts, x, y, &e, scratch);
+        if (share_p64_ntt_join_fast(NULL, parts, x, y, &r, scratch) != NONE)
+            goto end;
+        if (r != e)
+        {
+            fprintf(stderr, "ntt join: %d\n", parts);
+            goto end;
+        }
+    }
+
+    ret = 0;
+end:
+    if (scratch != NULL) free(scratch);
+    if (y != NULL) free(y);
+    if (x != NULL) free(x);
+    if (yv != NULL) free(yv);
+    if (xv != NULL) free(xv);
+    return ret;
+}
+
+/* The lengths in bits of the secrets of the fields only joined directly that
+ * are swept. */
+static const uint16_t sweep_bits[] = { 60, 128, 256 };
+/* The number of fields only joined directly that are swept. */
+#define SWEEP_NUM	(sizeof(sweep_bits) / sizeof(*sweep_bits))
+
+/*
+ * Create the numbers and scratch space of a direct join of SHARE_PARTS_MAX
+ * parts with the implementation of an object.
+ * Objects only support SHARE_PARTS_MAX_DIRECT parts but the join is called
+ * directly so that it is compared at all numbers of parts. The
+ * implementation must support any number of parts.
+ *
+ * @param [in]  share    The share object with the prime and implementation.
+ * @param [out] x        The x values.
+ * @param [out] y        The y values.
+ * @param [out] scratch  The scratch space of the join. None: NULL.
+ * @return  ALLOC when dynamic memory allocation fails.<br>
+ *          NONE otherwise.
+ */
+SHARE_ERR sweep_nums_new(SHARE *share, void ***x, void ***y, void **scratch)
+{
+    SHARE_ERR err = NONE;
+    SHARE_METH *meth = share->meth;
+    uint8_t data[SHARE_PRIME_LEN(256, 0)];
+    size_t len = 0;
+    uint32_t i;
+
+    *x = calloc(SHARE_PARTS_MAX, sizeof(**x));
+    *y = calloc(SHARE_PARTS_MAX, sizeof(**y));
+    if ((*x == NULL) || (*y == NULL))
+    {
+        err = ALLOC;
+        goto end;
+    }
+    if (meth->scratch != NULL)
+    {
+        err = meth->scratch(share->prime, SHARE_PARTS_MAX, &len);
+        if (err != NONE) goto end;
+    }
+    if (len > 0)
+    {
+        *scratch = malloc(len);
+        if (*scratch == NULL)
+        {
+            err = ALLOC;
+            goto end;
+        }
+    }
+
+    for (i=0; i<SHARE_PARTS_MAX; i++)
+    {
+        err = meth->num_new(share->prime_len, &(*x)[i]);
+        if (err != NONE) goto end;
+        err = meth->num_new(share->prime_len, &(*y)[i]);
+        if (err != NONE) goto end;
+        /* Random values less than the prime. */
+        pseudo_random(data, share->prime_len);
+        data[0] = 0;
+        err = meth->num_from_bin(data, share->prime_len, (*x)[i]);
+        if (err != NONE) goto end;
+        pseudo_random(data, share->prime_len);
+        data[0] = 0;
+        err = meth->num_from_bin(data, share->prime_len, (*y)[i]);
+        if (err != NONE) goto end;
+    }
+end:
+    return err;
+}
+
+/*
+ * Free the numbers and scratch space created by sweep_nums_new().
+ *
+ * @param [in] share    The share object the numbers were created with.
+ * @param [in] x        The x values.
+ * @param [in] y        The y values.
+ * @param [in] scratch  The scratch space of the join.
+ */
+void sweep_nums_free(SHARE *share, void **x, void **y, void *scratch)
+{
+    uint32_t i;
+
+    for (i=0; i<SHARE_PARTS_MAX; i++)
+    {
+        if ((x != NULL) && (x[i] != NULL))
+            share->meth->num_free(x[i]);
+        if ((y != NULL) && (y[i] != NULL))
+            share->meth->num_free(y[i]);
+    }
+    if (scratch != NULL) free(scratch);
+    if (y != NULL) free(y);
+    if (x != NULL) free(x);
+}
+
+/*
+ * Calculate the number of cycles of a join for numbers of parts from 2 to
+ * SHARE_PARTS_MAX: the direct joins of the 60, 128 and 256-bit primes and the
+ * direct and product tree joins of the number-theoretic transform prime.
+ * Only the number-theoretic transform prime has a product tree join: the
+ * other fields are limited to SHARE_PARTS_MAX_DIRECT parts.
+ *
+ * @return  0 on successful benchmarking.<br>
+ *          1 otherwise.
+ */
+int speed_join_sweep(void)
+{
+    int ret = 1;
+    SHARE_ERR err;
+    SHARE *share[SWEEP_NUM] = { NULL };
+    SHARE_METH *meth;
+    void **fx[SWEEP_NUM] = { NULL }, **fy[SWEEP_NUM] = { NULL };
+    void *fscratch[SWEEP_NUM] = { NULL };
+    uint64_t *xv = NULL, *yv = NULL;
+    void **x = NULL, **y = NULL;
+    void *scratch = NULL;
+    size_t scratch_len;
+    uint64_t r, start, end, c[SWEEP_NUM + 2];
+    uint32_t parts, i, n, k;
+
+    xv = malloc(SHARE_PARTS_MAX * sizeof(*xv));
+    yv = malloc(SHARE_PARTS_MAX * sizeof(*yv));
+    x = malloc(SHARE_PARTS_MAX * sizeof(*x));
+    y = malloc(SHARE_PARTS_MAX * sizeof(*y));
+    if ((xv == NULL) || (yv == NULL) || (x == NULL) || (y == NULL)) goto end;
+    share_p64_ntt_scratch(NULL, SHARE_PARTS_MAX, &scratch_len);
+    scratch = malloc(scratch_len);
+    if (scratch == NULL) goto end;
+
+    pseudo_random((uint8_t *)xv, SHARE_PARTS_MAX * sizeof(*xv));
+    pseudo_random((uint8_t *)yv, SHARE_PARTS_MAX * sizeof(*yv));
+    for (i=0; i<SHARE_PARTS_MAX; i++)
+    {
+        xv[i] >>= 4;
+        yv[i] >>= 4;
+        x[i] = &xv[i];
+        y[i] = &yv[i];
+    }
+
+    for (k=0; k<SWEEP_NUM; k++)
+    {
+        /* The implementation for any number of parts. */
+        err = share_meths_get(sweep_bits[k], SHARE_PARTS_MAX, 0, &meth);
+        if (err != NONE) goto end;
+        err = share_new_meth(sweep_bits[k], SHARE_PARTS_MAX_DIRECT, 0, meth,
+            &share[k]);
+        if (err != NONE) goto end;
+        err = sweep_nums_new(share[k], &fx[k], &fy[k], &fscratch[k]);
+        if (err != NONE) goto end;
+    }
+
+    printf("%5s  %10s %10s %10s %10s %10s\n", "Parts", "P60", "P128", "P256",
+        "P64 NTT", "P64 tree");
+    for (parts=2; parts<=SHARE_PARTS_MAX; parts*=2)
+    {
+        /* Keep the number of multiplications about the same. */
+        n = 1 + 1000000 / (parts * parts);
+        for (k=0; k<SWEEP_NUM+2; k++)
+        {
+            start = get_cycles();
+            for (i=0; i<n; i++)
+            {
+                if (k < SWEEP_NUM)
+                {
+                    share[k]->join(share[k]->prime, parts, fx[k], fy[k],
+                        share[k]->res, fscratch[k]);
+                }
+                else if (k == SWEEP_NUM)
+                    share_p64_ntt_join_quad(NULL, parts, x, y, &r, scratch);
+                else
+                    share_p64_ntt_join_fast(NULL, parts, x, y, &r, scratch);
+            }
+            end = get_cycles();
+            c[k] = (end - start) / n;
+        }
+        printf("%5d  %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64
+            " %10"PRIu64"\n", parts, c[0], c[1], c[2], c[3], c[4]);
+    }
+
+    ret = 0;
+end:
+    for (k=0; k<SWEEP_NUM; k++)
+    {
+        if (share[k] != NULL)
+            sweep_nums_free(share[k], fx[k], fy[k], fscratch[k]);
+        SHARE_free(share[k]);
+    }
+    if (scratch != NULL) free(scratch);
+    if (y != NULL) free(y);
+    if (x != NULL) free(x);
+    if (yv != NULL) free(yv);
+    if (xv != NULL) free(xv);
+    return ret;
+}
+
+/* The lengths in bits of the secrets to split with XOR. */
+static const uint16_t xor_lens[] = { 1, 8, 60, 256, 1000, 65535 };
+
+/*
+ * XOR the bytes of a into r one byte at a time: the reference for
+ * share_xor_bytes().
+ *
+ * @param [in] r  The bytes to XOR into.
+ * @param [in] a  The bytes to XOR.
+ * @param [in] n  The number of bytes.
+ */
+void xor_bytes_ref(uint8_t *r, const uint8_t *a, size_t n)
+{
+    size_t i;
+
+    for (i=0; i<n; i++)
+        r[i] ^= a[i];
+}
+
+/*
+ * Calcuate the number of cycles and the rate of XORing bytes into bytes one
+ * at a time and with share_xor_bytes().
+ *
+ * @param [in] r    The bytes to XOR into.
+ * @param [in] a    The bytes to XOR.
+ * @param [in] len  The number of bytes.
+ * @param [in] op   The implementation to calculate speed of: 0 bytes,
+ *                  1 share_xor_bytes().
+ */
+void speed_xor_bytes(uint8_t *r, const uint8_t *a, size_t len, int op)
+{
+    uint32_t i;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    void (*xor_func)(uint8_t *r, const uint8_t *a, size_t n);
+
+    xor_func = (op == 0) ? xor_bytes_ref : share_xor_bytes;
+
+    /* Approximate number of ops in a second. */
+    start = get_cycles();
+    for (i=0; i<1000; i++)
+        xor_func(r, a, len);
+    end = get_cycles();
+    num_ops = cps/((end-start)/1000 + 1) + 1;
+
+    /* Perform about 1 seconds worth of operations. */
+    start = get_cycles();
+    for (i=0; i<num_ops; i++)
+        xor_func(r, a, len);
+    end = get_cycles();
+
+    /* Report the rate of bytes XORed. */
+    diff = end - start;
+
+    printf("%5d: %9d %2.3f  %7"PRIu64" %8.1f  %s\n", (int)len, num_ops,
+        diff/(cps*1.0), diff/num_ops,
+        (double)len * num_ops / (diff/(cps*1.0)) / 1000000.0,
+        op == 0 ? "bytes" : "share_xor_bytes");
+}
+
+/*
+ * Test n-of-n splitting with XOR for secrets of many lengths.
+ * Exactly parts splits are generated, all are needed to join and a repeated
+ * split is detected.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_xor(uint16_t parts, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err = NONE;
+    SHARE *share = NULL;
+    uint8_t *secret = NULL, *sec = NULL, *all = NULL, *extra = NULL;
+    uint8_t **split = NULL;
+    char *name = "";
+    uint16_t len, l;
+    uint32_t i, k;
+    uint8_t xb[3][216];
+
+    split = malloc(parts * sizeof(*split));
+    if (split == NULL) goto end;
+    memset(split, 0, parts * sizeof(*split));
+
+    /* XOR of bytes at any alignment matches the byte at a time reference. */
+    fprintf(stderr, "xor bytes: ");
+    for (len=0; len<=200; len++)
+    {
+        for (i=0; i<16; i++)
+        {
+            pseudo_random(xb[0], sizeof(xb[0]));
+            pseudo_random(xb[2], sizeof(xb[2]));
+            memcpy(xb[1], xb[0], sizeof(xb[0]));
+            xor_bytes_ref(xb[0] + i, xb[2] + 15 - i, len);
+            share_xor_bytes(xb[1] + i, xb[2] + 15 - i, len);
+            if (memcmp(xb[0], xb[1], sizeof(xb[0])) != 0)
+            {
+                fprintf(stderr, "%d/%d", len, i);
+                goto end;
+            }
+        }
+    }
+    fprintf(stderr, "%d\n", err);
+
+    for (k=0; k<sizeof(xor_lens)/sizeof(*xor_lens); k++)
+    {
+        l = (xor_lens[k] + 7) / 8;
+        fprintf(stderr, "xor %d: ", xor_lens[k]);
+
+        err = SHARE_new(xor_lens[k], parts, SHARE_METHS_FLAG_XOR, &share);
+        if (err != NONE) goto end;
+        SHARE_get_impl_name(share, &name);
+        err = SHARE_get_len(share, &len);
+        if ((err != NONE) || (len != 2 * ((l < 2) ? 2 : l)) ||
+            (strcmp(name, "XOR N-of-N") != 0))
+        {
+            goto end;
+        }
+
+        secret = malloc(l);
+        sec = malloc(l);
+        all = malloc(parts * len);
+        extra = malloc(len);
+        if ((secret == NULL) || (sec == NULL) || (all == NULL) ||
+            (extra == NULL))
+        {
+            goto end;
+        }
+        for (i=0; i<parts; i++)
+        {
+            split[i] = malloc(len);
+            if (split[i] == NULL) goto end;
+        }
+        pseudo_random(secret, l);
+        if (xor_lens[k] < l * 8)
+            secret[0] >>= l * 8 - xor_lens[k];
+
+        /* Only parts splits. */
+        err = SHARE_split_init(share, secret);
+        if (err != NONE) goto end;
+        for (i=0; i<parts; i++)
+        {
+            err = SHARE_split(share, split[i]);
+            if (err != NONE) goto end;
+        }
+        err = SHARE_split(share, extra);
+        fprintf(stderr, "extra: %d", err);
+        if (err != FAILED) goto end;
+
+        /* Join in reverse order. */
+        err = SHARE_join_init(share);
+        if (err != NONE) goto end;
+        for (i=0; i<parts; i++)
+        {
+            err = SHARE_join_update(share, split[parts - 1 - i]);
+            if (err != NONE) goto end;
+        }
+        err = SHARE_join_final(share, sec);
+        fprintf(stderr, ", final: %d", err);
+        if ((err != NONE) || (memcmp(sec, secret, l) != 0)) goto end;
+
+        /* Joining with a repeated split must fail. */
+        err = SHARE_join_init(share);
+        if (err != NONE) goto end;
+        for (i=0; i<parts; i++)
+            SHARE_join_update(share, split[0]);
+        err = SHARE_join_final(share, sec);
+        fprintf(stderr, ", repeat: %d", err);
+        if (err != INVALID_DATA) goto end;
+
+        /* Split all at once. */
+        err = SHARE_split_init(share, secret);
+        if (err != NONE) goto end;
+        err = SHARE_split_n(share, all, parts);
+        if (err != NONE) goto end;
+        err = SHARE_join_init(share);
+        if (err != NONE) goto end;
+        err = SHARE_join_update_n(share, all, parts);
+        if (err != NONE) goto end;
+        err = SHARE_join_final(share, sec);
+        fprintf(stderr, ", split n final: %d\n", err);
+        if ((err != NONE) || (memcmp(sec, secret, l) != 0)) goto end;
+
+        if (speed)
+        {
+            printf("Length: %d\n", xor_lens[k]);
+            printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs",
+                "c/op", "ops/s", "Impl");
+            speed_split(share, parts, parts - 1, secret, split);
+            speed_join(share, parts, split, sec);
+        }
+
+        for (i=0; i<parts; i++)
+        {
+            free(split[i]);
+            split[i] = NULL;
+        }
+        free(extra);
+        free(all);
+        free(sec);
+        free(secret);
+        extra = all = sec = secret = NULL;
+        SHARE_free(share);
+        share = NULL;
+    }
+
+    /* The bytes of numbers are 8 byte aligned and a multiple of 8 long. */
+    if (speed)
+    {
+        all = malloc(2 * 8192 + 8);
+        if (all == NULL) goto end;
+        pseudo_random(all, 2 * 8192 + 8);
+        printf("XOR bytes\n");
+        printf("%5s  %9s %5s  %7s %8s  %s\n", "Len", "ops", "secs", "c/op",
+            "MB/s", "Impl");
+        for (len=16; len<=8192; len*=4)
+        {
+            speed_xor_bytes(all + 8, all + 8192 + 8, len, 0);
+            speed_xor_bytes(all + 8, all + 8192 + 8, len, 1);
+        }
+    }
+
+    ret = 0;
+end:
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    if (split != NULL)
+    {
+        for (i=0; i<parts; i++)
+            if (split[i] != NULL) free(split[i]);
+        free(split);
+    }
+    if (extra != NULL) free(extra);
+    if (all != NULL) free(all);
+    if (sec != NULL) free(sec);
+    if (secret != NULL) free(secret);
+    SHARE_free(share);
+    return ret;
+}
+
+/*
+ * Calcuate the number of cycles and operations per second of creating and
+ * freeing an object: dynamically allocated and in caller memory.
+ *
+ * @param [in] len    The length of the secret in bits.
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @param [in] buf    The caller memory to initialize the object in.
+ * @param [in] size   The number of bytes of caller memory.
+ */
+void speed_init(uint16_t len, uint16_t parts, uint32_t flags, void *buf,
+    size_t size)
+{
+    uint32_t i, k;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+    char *op[2] = { "  new", " init" };
+    SHARE *share = NULL;
+
+    for (k=0; k<2; k++)
+    {
+        /* Approximate number of ops in a second. */
+        start = get_cycles();
+        for (i=0; i<1000; i++)
+        {
+            if (k == 0)
+                SHARE_new(len, parts, flags, &share);
+            else
+                SHARE_init(buf, size, len, parts, flags, &share);
+            SHARE_free(share);
+        }
+        end = get_cycles();
+        num_ops = cps/((end-start)/1000);
+
+        /* Perform about 1 seconds worth of operations. */
+        start = get_cycles();
+        for (i=0; i<num_ops; i++)
+        {
+            if (k == 0)
+                SHARE_new(len, parts, flags, &share);
+            else
+                SHARE_init(buf, size, len, parts, flags, &share);
+            SHARE_free(share);
+        }
+        end = get_cycles();
+
+        diff = end - start;
+
+        SHARE_init(buf, size, len, parts, flags, &share);
+        SHARE_get_impl_name(share, &name);
+        printf("%s: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", op[k], num_ops,
+            diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+        SHARE_free(share);
+    }
+}
+
+/* The lengths and flags of the objects to initialize in caller memory. */
+static const struct
+{
+    uint16_t len;
+    uint32_t flags;
+} init_cfgs[] =
+{
+    { 60, 0 }, { 126, 0 }, { 128, 0 }, { 192, 0 }, { 254, 0 }, { 256, 0 },
+    { 384, 0 }, { 520, 0 }, { 128, SHARE_METHS_FLAG_BINARY },
+    { 254, SHARE_METHS_FLAG_P254 },
+    { 63, SHARE_METHS_FLAG_NTT }, { 1000, SHARE_METHS_FLAG_XOR }
+};
+
+/* The flags to check the compile time length of a split with. */
+static const uint32_t split_len_flags[] =
+{
+    0, SHARE_METHS_FLAG_PUBLIC_X, SHARE_METHS_FLAG_BINARY, SHARE_METHS_FLAG_NTT,
+    SHARE_METHS_FLAG_XOR, SHARE_METHS_FLAG_P254
+};
+
+/* The numbers of parts to check the bound of the size of caller memory with.
+ */
+static const uint16_t max_parts[] =
+{
+    2, 3, 4, 5, 8, 9, 15, 16, 17, 31, 100, 255, 256, 767, 768, 1024
+};
+
+/*
+ * Test objects initialized in caller memory split and join like dynamically
+ * allocated objects.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose. Only
+ *                    SHARE_METHS_FLAG_PUBLIC_X is used.
+ * @param [in] num    The number of splits to create.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_init(uint16_t parts, uint32_t flags, uint16_t num, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err = NONE;
+    SHARE *share = NULL, *ref = NULL;
+    uint8_t *buf = NULL, *all = NULL;
+    uint8_t secret[125], sec[125];
+    size_t size;
+    uint16_t len, l, n;
+    uint32_t f, i, k;
+
+    for (k=0; k<sizeof(init_cfgs)/sizeof(*init_cfgs); k++)
+    {
+        /* Each configuration chooses its own kind of implementation. */
+        f = (flags & SHARE_METHS_FLAG_PUBLIC_X) | init_cfgs[k].flags;
+        l = (init_cfgs[k].len + 7) / 8;
+        /* XOR has only parts splits. */
+        n = (f & SHARE_METHS_FLAG_XOR) ? parts : num;
+        fprintf(stderr, "init %d: ", init_cfgs[k].len);
+        if (parts > SHARE_PARTS_MAX_FLAGS(f))
+        {
+            fprintf(stderr, "skipped\n");
+            continue;
+        }
+
+        err = SHARE_size(init_cfgs[k].len, parts, f, &size);
+        fprintf(stderr, "size: %d", err);
+        if (err != NONE) goto end;
+        buf = malloc(size);
+        if (buf == NULL) goto end;
+
+        /* Memory must be aligned and big enough. */
+        err = SHARE_init(buf + 8, size - 8, init_cfgs[k].len, parts, f,
+            &share);
+        if (err != PARAM_BAD_VALUE) goto end;
+        err = SHARE_init(buf, size - 1, init_cfgs[k].len, parts, f, &share);
+        if (err != PARAM_BAD_LEN) goto end;
+        err = SHARE_init(buf, size, init_cfgs[k].len, parts, f, &share);
+        fprintf(stderr, ", init: %d", err);
+        if ((err != NONE) || ((void *)share != (void *)buf)) goto end;
+        err = SHARE_new(init_cfgs[k].len, parts, f, &ref);
+        if (err != NONE) goto end;
+        err = SHARE_get_len(share, &len);
+        if (err != NONE) goto end;
+
+        all = malloc(n * len);
+        if (all == NULL) goto end;
+        pseudo_random(secret, l);
+        if (init_cfgs[k].len < l * 8)
+            secret[0] >>= l * 8 - init_cfgs[k].len;
+
+        /* Split in caller memory and join with both objects. */
+        err = SHARE_split_init(share, secret);
+        if (err != NONE) goto end;
+        err = SHARE_split_n(share, all, n);
+        if (err != NONE) goto end;
+        for (i=0; i<2; i++)
+        {
+            err = SHARE_join_init((i == 0) ? share : ref);
+            if (err != NONE) goto end;
+            err = SHARE_join_update_n((i == 0) ? share : ref,
+                all + (n - parts) * len, parts);
+            if (err != NONE) goto end;
+            err = SHARE_join_final((i == 0) ? share : ref, sec);
+            fprintf(stderr, ", final: %d", err);
+            if ((err != NONE) || (memcmp(sec, secret, l) != 0)) goto end;
+        }
+        fprintf(stderr, "\n");
+
+        /* The memory is zeroized when freed. */
+        SHARE_free(share);
+        share = NULL;
+        for (i=0; i<size; i++)
+        {
+            if (buf[i] != 0)
+                goto end;
+        }
+
+        /* The caller memory is reused by the speed test. */
+        if (speed)
+        {
+            printf("Length: %d\n", init_cfgs[k].len);
+            printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs",
+                "c/op", "ops/s", "Impl");
+            speed_init(init_cfgs[k].len, parts, f, buf, size);
+        }
+        SHARE_free(ref);
+        ref = NULL;
+        free(all);
+        free(buf);
+        all = buf = NULL;
+    }
+
+    /* The compile time bound holds for all lengths and numbers of parts. */
+    fprintf(stderr, "init max: ");
+    for (len=1; len<=520; len++)
+    {
+        for (i=0; i<sizeof(max_parts)/sizeof(*max_parts); i++)
+        {
+            for (k=0; k<3; k++)
+            {
+                f = (k == 0) ? 0 : (k == 1) ? SHARE_METHS_FLAG_BINARY :
+                    SHARE_METHS_FLAG_P254;
+                err = SHARE_size(len, max_parts[i], f, &size);
+                /* Fields only joined directly support fewer parts. */
+                if ((max_parts[i] > SHARE_PARTS_MAX_DIRECT) &&
+                    (err == PARAM_BAD_VALUE))
+                {
+                    continue;
+                }
+                if ((err == NOT_FOUND) && (f != 0))
+                    continue;
+                /* 2^255-19 is used for secrets of any length. */
+                l = (f == SHARE_METHS_FLAG_P254) ? 254 : len;
+                if ((err != NONE) ||
+                    (size > SHARE_SIZE_MAX(l, max_parts[i])))
+                {
+                    fprintf(stderr, "%d/%d/%d: %d ", len, max_parts[i], f,
+                        (int)size);
+                    goto end;
+                }
+            }
+        }
+    }
+    err = NONE;
+    fprintf(stderr, "%d\n", err);
+
+    /* The compile time length of a split is the length of the object's. */
+    fprintf(stderr, "split len: ");
+    for (len=1; len<=520; len++)
+    {
+        for (k=0; k<sizeof(split_len_flags)/sizeof(*split_len_flags); k++)
+        {
+            f = split_len_flags[k];
+            err = SHARE_new(len, 2, f, &share);
+            if (err == NONE)
+                err = SHARE_get_len(share, &l);
+            SHARE_free(share);
+            share = NULL;
+            if (((err == NOT_FOUND) && (SHARE_SPLIT_LEN(len, f) != 0)) ||
+                ((err == NONE) && (l != SHARE_SPLIT_LEN(len, f))) ||
+                ((err != NONE) && (err != NOT_FOUND)))
+            {
+                fprintf(stderr, "%d/%d: %d ", len, f, err);
+                goto end;
+            }
+        }
+    }
+    err = NONE;
+    fprintf(stderr, "%d\n", err);
+
+    /* Generic implementations allocate constants of the prime. */
+    err = SHARE_size(256, (parts > SHARE_PARTS_MAX_DIRECT) ?
+        SHARE_PARTS_MAX_DIRECT : parts, flags | SHARE_METHS_FLAG_GENERIC,
+        &size);
+    fprintf(stderr, "init generic: %d\n", err);
+    if (err != NOT_FOUND) goto end;
+
+    ret = 0;
+end:
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    SHARE_free(share);
+    SHARE_free(ref);
+    if (all != NULL) free(all);
+    if (buf != NULL) free(buf);
+    return ret;
+}
+
+/*
+ * Calculate the speed of creating and freeing an object with dynamic memory
+ * from malloc and from an arena.
+ *
+ * @param [in] len    The length of the secret in bits.
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @param [in] arena  The arena to allocate from.
+ */
+void speed_arena(uint16_t len, uint16_t parts, uint32_t flags,
+    SHARE_ARENA *arena)
+{
+    uint32_t i, k;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+    char *op[2] = { "  new", "arena" };
+    SHARE *share = NULL;
+
+    for (k=0; k<2; k++)
+    {
+        if (k == 1)
+            SHARE_set_allocator(SHARE_ARENA_alloc, SHARE_ARENA_dealloc, arena);
+
+        /* Approximate number of ops in a second. */
+        start = get_cycles();
+        for (i=0; i<1000; i++)
+        {
+            SHARE_new(len, parts, flags, &share);
+            SHARE_free(share);
+        }
+        end = get_cycles();
+        num_ops = cps/((end-start)/1000);
+
+        /* Perform about 1 seconds worth of operations. */
+        start = get_cycles();
+        for (i=0; i<num_ops; i++)
+        {
+            SHARE_new(len, parts, flags, &share);
+            SHARE_free(share);
+        }
+        end = get_cycles();
+
+        diff = end - start;
+
+        SHARE_new(len, parts, flags, &share);
+        SHARE_get_impl_name(share, &name);
+        printf("%s: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", op[k], num_ops,
+            diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+        SHARE_free(share);
+    }
+    SHARE_set_allocator(NULL, NULL, NULL);
+}
+
+/*
+ * Test objects allocated from an arena split and join without calling malloc
+ * and that the arena zeroizes memory when freed.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose. Only
+ *                    SHARE_METHS_FLAG_PUBLIC_X is used.
+ * @param [in] num    The number of splits to create.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_arena(uint16_t parts, uint32_t flags, uint16_t num, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err = NONE;
+    SHARE_ARENA *arena = NULL;
+    SHARE *share = NULL;
+    uint8_t *all = NULL, *p;
+    uint8_t secret[125], sec[125];
+    uint64_t allocs;
+    uint16_t len, l, n;
+    uint32_t f, i, k;
+
+    err = SHARE_ARENA_new(4 << 20, &arena);
+    fprintf(stderr, "arena: %d\n", err);
+    if (err == ALLOC)
+    {
+        /* Locked memory is limited by RLIMIT_MEMLOCK. */
+        fprintf(stderr, "arena: unable to lock memory - skipped\n");
+        return 0;
+    }
+    if (err != NONE) goto end;
+
+    /* Freed blocks are zeroized and reused. */
+    p = SHARE_ARENA_alloc(100, arena);
+    if ((p == NULL) || (((uintptr_t)p & (SHARE_MEM_ALIGN - 1)) != 0))
+        goto end;
+    memset(p, 0xa5, 100);
+    SHARE_ARENA_dealloc(p, arena);
+    for (i=0; i<100; i++)
+    {
+        if (p[i] != 0)
+            goto end;
+    }
+    if (SHARE_ARENA_alloc(128, arena) != p)
+        goto end;
+    SHARE_ARENA_dealloc(p, arena);
+    if (SHARE_ARENA_alloc(8 << 20, arena) != NULL)
+        goto end;
+
+    err = SHARE_set_allocator(SHARE_ARENA_alloc, NULL, arena);
+    if (err != PARAM_NULL) goto end;
+    err = SHARE_set_allocator(SHARE_ARENA_alloc, SHARE_ARENA_dealloc, arena);
+    if (err != NONE) goto end;
+
+    for (k=0; k<sizeof(init_cfgs)/sizeof(*init_cfgs); k++)
+    {
+        f = (flags & SHARE_METHS_FLAG_PUBLIC_X) | init_cfgs[k].flags;
+        l = (init_cfgs[k].len + 7) / 8;
+        /* XOR has only parts splits. */
+        n = (f & SHARE_METHS_FLAG_XOR) ? parts : num;
+        fprintf(stderr, "arena %d: ", init_cfgs[k].len);
+        if (parts > SHARE_PARTS_MAX_FLAGS(f))
+        {
+            fprintf(stderr, "skipped\n");
+            continue;
+        }
+
+        pseudo_random(secret, l);
+        if (init_cfgs[k].len < l * 8)
+            secret[0] >>= l * 8 - init_cfgs[k].len;
+
+        /* All memory of the object comes from the arena. */
+        allocs = alloc_cnt;
+        err = SHARE_new(init_cfgs[k].len, parts, f, &share);
+        fprintf(stderr, "new: %d", err);
+        if (err != NONE) goto end;
+        if (alloc_cnt != allocs)
+        {
+            fprintf(stderr, ", allocs: %"PRIu64, alloc_cnt - allocs);
+            goto end;
+        }
+        err = SHARE_get_len(share, &len);
+        if (err != NONE) goto end;
+        all = malloc(n * len);
+        if (all == NULL) goto end;
+
+        allocs = alloc_cnt;
+        err = SHARE_split_init(share, secret);
+        if (err != NONE) goto end;
+        err = SHARE_split_n(share, all, n);
+        if (err != NONE) goto end;
+        err = SHARE_join_init(share);
+        if (err != NONE) goto end;
+        err = SHARE_join_update_n(share, all + (n - parts) * len, parts);
+        if (err != NONE) goto end;
+        err = SHARE_join_final(share, sec);
+        fprintf(stderr, ", final: %d", err);
+        if ((err != NONE) || (memcmp(sec, secret, l) != 0)) goto end;
+        SHARE_free(share);
+        share = NULL;
+        if (alloc_cnt != allocs)
+        {
+            fprintf(stderr, ", allocs: %"PRIu64, alloc_cnt - allocs);
+            goto end;
+        }
+        fprintf(stderr, "\n");
+
+        if (speed)
+        {
+            SHARE_set_allocator(NULL, NULL, NULL);
+            printf("Length: %d\n", init_cfgs[k].len);
+            printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs",
+                "c/op", "ops/s", "Impl");
+            speed_arena(init_cfgs[k].len, parts, f, arena);
+            SHARE_set_allocator(SHARE_ARENA_alloc, SHARE_ARENA_dealloc, arena);
+        }
+
+        free(all);
+        all = NULL;
+    }
+
+    ret = 0;
+end:
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    SHARE_free(share);
+    SHARE_set_allocator(NULL, NULL, NULL);
+    SHARE_ARENA_free(arena);
+    if (all != NULL) free(all);
+    return ret;
+}
+
+/*
+ * Handle a request: split a random secret and join it, with an object that is
+ * created and freed or taken from and returned to its pool.
+ *
+ * @param [in] len    The length of the secret in bits.
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @param [in] num    The number of splits to create.
+ * @param [in] pool   Whether to use the pool.
+ * @param [in] split  The buffer to hold the splits.
+ * @return  NONE on success.<br>
+ *          FAILED when the joined secret is different.<br>
+ *          Other error codes from the operations.
+ */
+SHARE_ERR pool_request(uint16_t len, uint16_t parts, uint32_t flags,
+    uint16_t num, uint8_t pool, uint8_t *split)
+{
+    SHARE_ERR err;
+    SHARE *share = NULL;
+    uint8_t secret[125], sec[125];
+    uint16_t l = (len + 7) / 8, sl;
+
+    if (pool)
+        err = SHARE_pool_get(len, parts, flags, &share);
+    else
+        err = SHARE_new(len, parts, flags, &share);
+    if (err != NONE) goto end;
+    err = SHARE_get_len(share, &sl);
+    if (err != NONE) goto end;
+
+    pseudo_random(secret, l);
+    if (len < l * 8)
+        secret[0] >>= l * 8 - len;
+    err = SHARE_split_init(share, secret);
+    if (err != NONE) goto end;
+    err = SHARE_split_n(share, split, num);
+    if (err != NONE) goto end;
+    err = SHARE_join_init(share);
+    if (err != NONE) goto end;
+    err = SHARE_join_update_n(share, split + (num - parts) * sl, parts);
+    if (err != NONE) goto end;
+    err = SHARE_join_final(share, sec);
+    if ((err == NONE) && (memcmp(sec, secret, l) != 0))
+        err = FAILED;
+end:
+    if (pool)
+        SHARE_pool_put(share);
+    else
+        SHARE_free(share);
+    return err;
+}
+
+/* The number of threads making pooled requests. */
+#define POOL_THREADS	4
+/* The number of requests each thread makes. */
+#define POOL_REQS	500
+
+/* The parameters of the requests of a thread. */
+typedef struct pool_thread_st
+{
+    /* The number of parts required to recreate secret. */
+    uint16_t parts;
+    /* The number of splits to create. */
+    uint16_t num;
+    /* The first configuration to use. */
+    uint32_t cfg;
+    /* The error of the first failed request. */
+    SHARE_ERR err;
+} POOL_THREAD;
+
+/* The lengths and flags of the pooled objects. */
+static const struct
+{
+    uint16_t len;
+    uint32_t flags;
+} pool_cfgs[] =
+{
+    { 128, 0 }, { 256, 0 }, { 128, SHARE_METHS_FLAG_BINARY },
+    { 63, SHARE_METHS_FLAG_NTT }
+};
+/* The number of pooled configurations. */
+#define POOL_CFGS    (uint32_t)(sizeof(pool_cfgs)/sizeof(*pool_cfgs))
+/* The maximum length of a split of the pooled configurations. */
+#define POOL_SPLIT_LEN	66
+
+/*
+ * Make pooled requests, cycling through the configurations.
+ *
+ * @param [in] arg  The parameters of the requests.
+ * @return  NULL.
+ */
+void *pool_thread(void *arg)
+{
+    POOL_THREAD *t = arg;
+    uint8_t *split;
+    uint32_t i, k;
+
+    split = malloc((size_t)t->num * POOL_SPLIT_LEN);
+    if (split == NULL)
+        t->err = ALLOC;
+    for (i=0; (t->err == NONE) && (i<POOL_REQS); i++)
+    {
+        k = (t->cfg + i) % POOL_CFGS;
+        t->err = pool_request(pool_cfgs[k].len, t->parts, pool_cfgs[k].flags,
+            t->num, 1, split);
+    }
+    if (split != NULL)
+        free(split);
+
+    return NULL;
+}
+
+/* The objects handed between threads that only put or only get. */
+typedef struct pool_hand_st
+{
+    /* The number of parts required to recreate secret. */
+    uint16_t parts;
+    /* The flags of the objects. */
+    uint32_t flags;
+    /* The objects put by the producer. The object got by the consumer. */
+    SHARE *s[2];
+    /* The error of the consumer's get. */
+    SHARE_ERR err;
+} POOL_HAND;
+
+/*
+ * Put the objects into the pool and exit: the objects are returned to the
+ * shared list.
+ *
+ * @param [in] arg  The objects to put.
+ * @return  NULL.
+ */
+void *pool_producer(void *arg)
+{
+    POOL_HAND *h = arg;
+
+    SHARE_pool_put(h->s[0]);
+    SHARE_pool_put(h->s[1]);
+
+    return NULL;
+}
+
+/*
+ * Get an object from the pool and exit without putting any.
+ *
+ * @param [in] arg  The configuration and the object got.
+ * @return  NULL.
+ */
+void *pool_consumer(void *arg)
+{
+    POOL_HAND *h = arg;
+
+    h->err = SHARE_pool_get(256, h->parts, h->flags, &h->s[0]);
+
+    return NULL;
+}
+
+/*
+ * Calculate the throughput of requests with objects that are created and
+ * freed and with pooled objects.
+ *
+ * @param [in] len    The length of the secret in bits.
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose.
+ * @param [in] num    The number of splits to create.
+ * @param [in] split  The buffer to hold the splits.
+ */
+void speed_pool(uint16_t len, uint16_t parts, uint32_t flags, uint16_t num,
+    uint8_t *split)
+{
+    uint32_t i, k;
+    uint32_t num_ops;
+    uint64_t start, end, diff;
+    char *name = "";
+    char *op[2] = { "  new", " pool" };
+    SHARE *share = NULL;
+
+    for (k=0; k<2; k++)
+    {
+        /* Approximate number of ops in a second. */
+        start = get_cycles();
+        for (i=0; i<100; i++)
+            pool_request(len, parts, flags, num, k, split);
+        end = get_cycles();
+        num_ops = cps/((end-start)/100);
+
+        /* Perform about 1 seconds worth of operations. */
+        start = get_cycles();
+        for (i=0; i<num_ops; i++)
+            pool_request(len, parts, flags, num, k, split);
+        end = get_cycles();
+
+        diff = end - start;
+
+        SHARE_new(len, parts, flags, &share);
+        SHARE_get_impl_name(share, &name);
+        printf("%s: %7d %2.3f  %7"PRIu64" %7"PRIu64"  %s\n", op[k], num_ops,
+            diff/(cps*1.0), diff/num_ops, cps/(diff/num_ops), name);
+        SHARE_free(share);
+    }
+}
+
+/*
+ * Test pooled objects are reused, scrubbed when returned and can be shared
+ * by threads.
+ *
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] flags  The extra requirements on the methods to choose. Only
+ *                    SHARE_METHS_FLAG_PUBLIC_X is used.
+ * @param [in] num    The number of splits to create.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_pool(uint16_t parts, uint32_t flags, uint16_t num, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err = NONE;
+    SHARE *a = NULL, *b = NULL, *s;
+    uint8_t *split = NULL;
+    uint8_t data[66];
+    uint64_t allocs;
+    POOL_HAND hand;
+    pthread_t thread[POOL_THREADS];
+    POOL_THREAD t[POOL_THREADS];
+    int created[POOL_THREADS];
+    uint32_t f = flags & SHARE_METHS_FLAG_PUBLIC_X;
+    uint32_t i, k;
+
+    fprintf(stderr, "pool: ");
+    /* The pooled fields are only joined directly. */
+    if (parts > SHARE_PARTS_MAX_DIRECT)
+        parts = SHARE_PARTS_MAX_DIRECT;
+    split = malloc((size_t)num * POOL_SPLIT_LEN);
+    if (split == NULL) goto end;
+
+    /* Objects in use are distinct and a returned object is reused. */
+    err = SHARE_pool_get(256, parts, f, &a);
+    if (err != NONE) goto end;
+    err = SHARE_pool_get(256, parts, f, &b);
+    if ((err != NONE) || (a == b)) goto end;
+    SHARE_pool_put(b);
+    b = NULL;
+    err = SHARE_split_init(a, (uint8_t *)"0123456789abcdef0123456789abcdef");
+    if (err != NONE) goto end;
+    err = SHARE_split(a, split);
+    if (err != NONE) goto end;
+
+    /* The secret state is scrubbed when returned. */
+    SHARE_pool_put(a);
+    for (i=0; i<a->prime_len; i++)
+    {
+        if (a->random[i] != 0)
+            goto end;
+    }
+    for (k=0; k<a->parts; k++)
+    {
+        err = a->meth->num_to_bin(a->num[k], data, a->prime_len);
+        if (err != NONE) goto end;
+        for (i=0; i<a->prime_len; i++)
+        {
+            if (data[i] != 0)
+                goto end;
+        }
+    }
+    err = SHARE_pool_get(256, parts, f, &b);
+    if ((err != NONE) || (b != a)) goto end;
+    SHARE_pool_put(b);
+    a = b = NULL;
+
+    /* Pooled requests don't allocate once the pool has objects. */
+    for (k=0; k<POOL_CFGS; k++)
+    {
+        err = pool_request(pool_cfgs[k].len, parts, f | pool_cfgs[k].flags,
+            num, 1, split);
+        if (err != NONE) goto end;
+    }
+    allocs = alloc_cnt;
+    for (k=0; k<POOL_CFGS; k++)
+    {
+        err = pool_request(pool_cfgs[k].len, parts, f | pool_cfgs[k].flags,
+            num, 1, split);
+        if (err != NONE) goto end;
+    }
+    if (alloc_cnt != allocs)
+    {
+        fprintf(stderr, "allocs: %"PRIu64, alloc_cnt - allocs);
+        goto end;
+    }
+
+    /* Invalid configurations aren't pooled and other objects are freed. */
+    err = SHARE_pool_get(0, parts, f, &a);
+    if (err != PARAM_BAD_VALUE) goto end;
+    err = SHARE_new(128, parts, f, &a);
+    if (err != NONE) goto end;
+    SHARE_pool_put(a);
+    a = NULL;
+
+    /* Threads get and put objects of the pools concurrently. */
+    for (i=0; i<POOL_THREADS; i++)
+    {
+        t[i].parts = parts;
+        t[i].num = num;
+        t[i].cfg = i;
+        t[i].err = NONE;
+        created[i] = pthread_create(&thread[i], NULL, pool_thread, &t[i]) == 0;
+        if (!created[i])
+            t[i].err = FAILED;
+    }
+    for (i=0; i<POOL_THREADS; i++)
+    {
+        if (created[i])
+            pthread_join(thread[i], NULL);
+        if ((err == NONE) && (t[i].err != NONE))
+            err = t[i].err;
+    }
+    fprintf(stderr, "threads: %d", err);
+    if (err != NONE) goto end;
+
+    /* A thread that only gets returns the objects left in its magazine when
+     * it exits. */
+    SHARE_pool_clear();
+    hand.parts = parts;
+    hand.flags = f;
+    hand.err = NONE;
+    err = SHARE_pool_get(256, parts, f, &hand.s[0]);
+    if (err != NONE) goto end;
+    err = SHARE_pool_get(256, parts, f, &hand.s[1]);
+    if (err != NONE)
+    {
+        SHARE_pool_put(hand.s[0]);
+        goto end;
+    }
+    a = hand.s[0];
+    b = hand.s[1];
+    err = FAILED;
+    if (pthread_create(&thread[0], NULL, pool_producer, &hand) != 0)
+    {
+        SHARE_pool_put(a);
+        SHARE_pool_put(b);
+        a = b = NULL;
+        goto end;
+    }
+    pthread_join(thread[0], NULL);
+    if (pthread_create(&thread[0], NULL, pool_consumer, &hand) != 0)
+    {
+        a = b = NULL;
+        goto end;
+    }
+    pthread_join(thread[0], NULL);
+    err = hand.err;
+    if (err != NONE)
+    {
+        a = b = NULL;
+        goto end;
+    }
+    /* The consumer has one object and the other is back in the shared list.
+     */
+    s = (hand.s[0] == a) ? b : a;
+    a = hand.s[0];
+    b = NULL;
+    err = SHARE_pool_get(256, parts, f, &b);
+    if (err != NONE) goto end;
+    err = (b == s) ? NONE : FAILED;
+    fprintf(stderr, ", get only: %d\n", err);
+    if (err != NONE) goto end;
+    SHARE_pool_put(a);
+    SHARE_pool_put(b);
+    a = b = NULL;
+
+    if (speed)
+    {
+        for (k=0; k<POOL_CFGS; k++)
+        {
+            printf("Length: %d\n", pool_cfgs[k].len);
+            printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs",
+                "c/op", "ops/s", "Impl");
+            speed_pool(pool_cfgs[k].len, parts, f | pool_cfgs[k].flags, num,
+                split);
+        }
+    }
+
+    ret = 0;
+end:
+    if (ret != 0)
+        fprintf(stderr, " failed: %d\n", err);
+    SHARE_pool_put(a);
+    SHARE_pool_put(b);
+    SHARE_pool_clear();
+    if (split != NULL) free(split);
+    return ret;
+}
+
+/*
+ * Test secret splitting of any length in GF(2^8).
+ *
+ * @param [in] len    The length of the secret in bytes.
+ * @param [in] parts  The number of parts required to recreate secret.
+ * @param [in] num    The number of splits to create.
+ * @param [in] speed  Indicates whether to calculate speed of operations.
+ * @return  0 on successful testing.<br>
+ *          1 otherwise.
+ */
+int test_gf8(uint32_t len, uint8_t parts, uint8_t num, uint8_t speed)
+{
+    int ret = 1;
+    SHARE_ERR err;
+    SHARE_GF8 *share = NULL;
+    uint8_t *secret = NULL;
+    uint8_t *sec = NULL;
+    uint8_t **split = NULL;
+    uint32_t i, slen;
+    char *name = "";
+
+    /* Create share object for joing and splitting. */
+    err = SHARE_GF8_new(len, parts, &share);
+    fprintf(stderr, "gf8 new: %d", err);
+    if (err != NONE) goto end;
+    SHARE_GF8_get_impl_name(share, &name);
+    fprintf(stderr, " (%s)", name);
+
+    /* Get the length of the encoded data. */
+    err = SHARE_GF8_get_len(share, &slen);
+    if (err != NONE) goto end;
+
+    sec = malloc(len);
+    if (sec == NULL) goto end;
+    secret = malloc(len);
+    if (secret == NULL) goto end;
+    /* Generate random secret. */
+    pseudo_random(secret, len);
+
+    split = malloc(num * sizeof(*split));
+    if (split == NULL) goto end;
+    memset(split, 0, num * sizeof(*split));
+    for (i=0; i<num; i++)
+    {
+        split[i] = malloc(slen);
+        if (split[i] == NULL) goto end;
+    }
+
+    /* Split */
+    err = SHARE_GF8_split_init(share, secret);
+    fprintf(stderr, ", split init: %d", err);
+    if (err != NONE) goto end;
+    for (i=0; i<num; i++)
+    {
+        err = SHARE_GF8_split(share, split[i]);
+        if (err != NONE) break;
+    }
+    fprintf(stderr, ", split: %d", err);
+    if (err != NONE) goto end;
+
+    /* Join with the last ones generated. */
+    err = SHARE_GF8_join_init(share);
+    if (err != NONE) goto end;
+    for (i=0; i<parts; i++)
+    {
+        err = SHARE_GF8_join_update(share, split[num - 1 - i]);
+        if (err != NONE) break;
+    }
+    fprintf(stderr, ", update: %d", err);
+    if (err != NONE) goto end;
+    err = SHARE_GF8_join_final(share, sec);
+    fprintf(stderr, ", final: %d", err);
+    if (err != NONE) goto end;
+    if (memcmp(sec, secret, len) != 0)
+    {
+        fprintf(stderr, " mismatch");
+        goto end;
+    }
+
+    /* Joining with a repeated split must fail. */
+    err = SHARE_GF8_join_init(share);
+    if (err != NONE) goto end;
+    for (i=0; i<parts; i++)
+        SHARE_GF8_join_update(share, split[0]);
+    err = SHARE_GF8_join_final(share, sec);
+    fprintf(stderr, ", repeat: %d", err);
+    if (err != INVALID_DATA) goto end;
+
+    if (test_gf8_mul_sum(len) != 0) goto end;
+    fprintf(stderr, "\n");
+
+    if (speed)
+    {
+        printf("%5s  %7s %5s  %7s %7s  %s\n", "Op", "ops", "secs", "c/op",
+            "MB/s", "Impl");
+        speed_gf8(share, parts, num, secret, split, sec, 0);
+        speed_gf8(share, parts, num, secret, split, sec, 1);
+    }
+
+    ret = 0;
+end:
+    fprintf(stderr, "\n");
+    if (split != NULL)
+    {
+        for (i=0; i<num; i++)
+            if (split[i] != NULL) free(split[i]);
+        free(split);
+    }
+    if (secret != NULL) free(secret);
+    if (sec != NULL) free(sec);
+    SHARE_GF8_free(share);
+    return ret;
+}
+
+/*
+ * The main entry point of program.
+ *
+ * @param [in] argc  The count of command line arguments.
+ * @param [in] argv  The command line arguments.
+ * @return  1 on test failure.<br>
+ *          0 otherwise.
+ */
+int main(int argc, char *argv[])
+{
+    int ret = 0;
+    uint8_t i;
+    uint16_t s;
+    uint16_t parts = 2;
+    uint16_t num = 3;
+    uint16_t which = 0;
+    uint8_t speed = 0;
+    uint8_t sweep = 0;
+    uint32_t flags = 0;
+    uint32_t gf8 = 0;
+
+    while (--argc)
+    {
+        argv++;
+
+        if (strcmp(*argv, "-speed") == 0)
+            speed = 1;
+        else if (strcmp(*argv, "-parts") == 0)
+        {
+            if (--argc == 0)
+            {
+                fprintf(stderr, "Number of parts missing from command line\n");
+                ret = 1;
+                goto end;
+            }
+            parts = atoi(*(++argv));
+            if ((parts < 2) || (parts > SHARE_PARTS_MAX))
+            {
+                fprintf(stderr, "Parts invalid: 2 <= %d <= %d\n", parts,
+                    SHARE_PARTS_MAX);
+                ret = 1;
+                goto end;
+            }
+            num = parts + 1;
+        }
+        else if (strcmp(*argv, "-num") == 0)
+        {
+            if (--argc == 0)
+            {
+                fprintf(stderr, "Number of splits missing from command line\n");
+                ret = 1;
+                goto end;
+            }
+            num = atoi(*(++argv));
+            if (num <= parts)
+            {
+                fprintf(stderr, "Num invalid: %d < %d <= %d\n", parts, num,
+                    65535);
+                ret = 1;
+                goto end;
+            }
+        }
+        else if (strcmp(*argv, "-gen") == 0)
+            flags |= SHARE_METHS_FLAG_GENERIC;
+        else if (strcmp(*argv, "-pubx") == 0)
+            flags |= SHARE_METHS_FLAG_PUBLIC_X;
+        else if (strcmp(*argv, "-bin") == 0)
+            flags |= SHARE_METHS_FLAG_BINARY;
+        else if (strcmp(*argv, "-ntt") == 0)
+            flags |= SHARE_METHS_FLAG_NTT;
+        else if (strcmp(*argv, "-xor") == 0)
+            flags |= SHARE_METHS_FLAG_XOR;
+        else if (strcmp(*argv, "-sweep") == 0)
+            sweep = 1;
+        else if (strcmp(*argv, "-gf8") == 0)
+        {
+            if (--argc == 0)
+            {
+                fprintf(stderr, "Number of bytes missing from command line\n");
+                ret = 1;
+                goto end;
+            }
+            gf8 = atoi(*(++argv));
+            if (gf8 == 0)
+            {
+                fprintf(stderr, "Bytes invalid: 0 < %d\n", gf8);
+                ret = 1;
+                goto end;
+            }
+        }
+        else
+        {
+            s = atoi(*argv);
+            /* If strength value is valid then set corresponding bit. */
+            for (i=0; i<VALID_NUM; i++)
+            {
+                if (valid[i] == s)
+                    which |= 1<<i;
+            }
+        }
+    }
+
+    printf("Parts: %d, Num: %d\n", parts, num);
+
+    if (speed)
+        calc_cps();
+
+    /* Only compare the joins across the numbers of parts. */
+    if (sweep)
+    {
+        ret = speed_join_sweep();
+        goto end;
+    }
+    /* Only test n-of-n splitting with XOR. */
+    if (flags & SHARE_METHS_FLAG_XOR)
+    {
+        ret = test_xor(parts, speed);
+        goto end;
+    }
+
+    /* Test all prime lengths requested.
+     * The binary field supports secrets of up to 128 bits.
+     * The number-theoretic transform prime supports secrets of up to 63 bits.
+     */
+    for (i=0; (gf8 == 0) && (i<VALID_NUM); i++)
+    {
+        if ((flags & SHARE_METHS_FLAG_BINARY) && (valid[i] > 128))
+            continue;
+        if ((flags & SHARE_METHS_FLAG_NTT) && (valid[i] > 63))
+            continue;
+        if (parts > SHARE_PARTS_MAX_FLAGS(flags))
+            continue;
+        if ((which == 0) || ((which & (1<<i)) != 0))
+            ret |= test_share(valid[i], NULL, 0, parts, flags, num, speed);
+    }
+    /* Test the binary field and the number-theoretic transform when not
+     * explicitly requested. */
+    if ((gf8 == 0) && (which == 0) &&
+        ((flags & (SHARE_METHS_FLAG_BINARY | SHARE_METHS_FLAG_GENERIC |
+                   SHARE_METHS_FLAG_NTT)) == 0))
+    {
+        /* Fields that are only joined directly support fewer parts. */
+        if (parts <= SHARE_PARTS_MAX_DIRECT)
+        {
+            ret |= test_share(128, NULL, 0, parts,
+                flags | SHARE_METHS_FLAG_BINARY, num, speed);
+            ret |= test_share_prime(parts, flags, num, speed);
+            ret |= test_share(254, NULL, 0, parts,
+                flags | SHARE_METHS_FLAG_P254, num, speed);
+        }
+        ret |= test_gf128_impls();
+        ret |= test_meths(parts, num);
+        ret |= test_share(63, NULL, 0, parts, flags | SHARE_METHS_FLAG_NTT,
+            num, speed);
+        ret |= test_compat_254(flags);
+    }
+    if ((gf8 == 0) && (which == 0) && ((flags & (SHARE_METHS_FLAG_BINARY |
+        SHARE_METHS_FLAG_GENERIC)) == 0))
+    {
+        ret |= test_ntt(parts, speed);
+        ret |= test_ntt_join();
+        ret |= test_xor(parts, speed);
+        ret |= test_init(parts, flags, num, speed);
+        ret |= test_arena(parts, flags, num, speed);
+        ret |= test_pool(parts, flags, num, speed);
+    }
+    /* Test secrets of any length in GF(2^8) - at most 255 splits. */
+    if (num <= 255)
+    {
+        if (gf8 != 0)
+            ret |= test_gf8(gf8, parts, num, speed);
+        else if (which == 0)
+            ret |= test_gf8(1027, parts, num, speed);
     }
 
 end:
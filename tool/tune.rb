@@ -0,0 +1,154 @@
+#!/usr/bin/ruby
+# Copyright (c) 2016 Sean Parkinson
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+# Autotune the kernels of the C implementations of the primes.
+#
+# Every combination of kernel variants is generated for each prime, compiled
+# into a benchmark and run on the build host. The fastest variants are
+# written to the tune file that the generator reads.
+#
+# Usage: tune.rb <tune file> <compiler> <compiler flags>
+
+require 'tmpdir'
+
+# The primes: bits and the prime's last word.
+PRIMES = [ [ 60, "1" ], [ 126, "1" ], [ 128, "19" ], [ 192, "1f" ], [ 256, "5d" ],
+           [ 384, "109" ], [ 520, "1" ] ]
+# The kernel variants in the order of the tune file.
+MUL = [ "ps", "os" ]
+SQR = [ "ps", "mul" ]
+WORD = [ "shift", "mul" ]
+
+DIR = File.dirname(__FILE__)
+GEN = "#{DIR}/../src/prime/share_prime.rb"
+
+tune_file = ARGV[0]
+cc = ARGV[1]
+# Warnings are not errors in the benchmark.
+cflags = ARGV[2..-1].join(" ").split.reject { |f| f == "-Werror" }.join(" ")
+cflags += " -I#{DIR}/../include -I#{DIR}/../src -DSHARE_INV_FERMAT"
+
+# The benchmark prints the nanoseconds of a multiply-add and a square.
+def bench_src(bits)
+  <<EOF
+#include <stdio.h>
+#include <time.h>
+#include "gen.c"
+
+#define ITER	100000
+#define RUNS	7
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(void)
+{
+    uint64_t a[NUM_ELEMS], b[NUM_ELEMS], c[NUM_ELEMS];
+    double s, mul = 1e30, sqr = 1e30;
+    int i, j;
+
+    for (i=0; i<NUM_ELEMS; i++)
+    {
+        a[i] = 0x0123456789abcdefULL * (i + 1);
+        b[i] = 0xfedcba9876543210ULL * (i + 3);
+        c[i] = 0x5555aaaa5555aaaaULL * (i + 5);
+    }
+    p#{bits}_mod(a, a);
+    p#{bits}_mod(b, b);
+    p#{bits}_mod(c, c);
+
+    /* Warm up the CPU. */
+    for (i=0; i<ITER*RUNS; i++)
+        p#{bits}_mod_mul_add(a, a, b, c);
+
+    for (j=0; j<RUNS; j++)
+    {
+        s = now();
+        for (i=0; i<ITER; i++)
+            p#{bits}_mod_mul_add(a, a, b, c);
+        s = now() - s;
+        if (s < mul) mul = s;
+
+        s = now();
+        for (i=0; i<ITER; i++)
+            p#{bits}_mod_sqr(b, b);
+        s = now() - s;
+        if (s < sqr) sqr = s;
+    }
+
+    printf("%f %f %lu\\n", mul / ITER, sqr / ITER,
+        (unsigned long)(a[0] ^ b[0]));
+    return 0;
+}
+EOF
+end
+
+tune = {}
+Dir.mktmpdir do |tmp|
+  PRIMES.each do |bits, word|
+    File.write("#{tmp}/bench.c", bench_src(bits))
+    res = {}
+    MUL.product(SQR, WORD).each do |v|
+      args = "mul=#{v[0]} sqr=#{v[1]} word=#{v[2]}"
+      system("ruby #{GEN} #{bits} #{word} c #{args} > #{tmp}/gen.c") or
+        raise "Generating P#{bits} #{args} failed"
+      system("#{cc} #{cflags} -o #{tmp}/bench #{tmp}/bench.c") or
+        raise "Compiling P#{bits} #{args} failed"
+      # Take the best of a number of runs of the benchmark.
+      res[v] = (1..3).map { `#{tmp}/bench`.split[0..1].map { |t| t.to_f } }.
+               transpose.map { |t| t.min }
+      STDERR.puts "P#{bits} #{args}: mul-add #{'%.1f' % res[v][0]} ns, " +
+                  "sqr #{'%.1f' % res[v][1]} ns"
+    end
+    # Multiply is on the hot path: choose its variants first and then the
+    # squaring that goes with them.
+    best = res.keys.min_by { |v| res[v][0] }
+    best = res.keys.select { |v| v[0] == best[0] and v[2] == best[2] }.
+               min_by { |v| res[v][1] }
+    tune[bits] = best
+    STDERR.puts "P#{bits}: #{best.join(",")}"
+  end
+end
+
+File.open(tune_file, "w") do |f|
+  f.puts File.read("#{DIR}/../license/license.c")
+  f.puts <<EOF
+/* The kernel variants of the C implementations of the primes.
+ * Generated on the build host with: make autotune
+ * The variants are listed in the order: mul, sqr, word.
+ *   mul  - ps: product scanning, os: operand scanning.
+ *   sqr  - ps: dedicated squaring, mul: multiply the number by itself.
+ *   word - shift: multiply by the prime's last word with shifts and adds,
+ *          mul: multiply by the prime's last word with a multiply.
+ */
+
+EOF
+  PRIMES.each do |bits, word|
+    f.puts "/** The kernel variants of the #{bits}-bit prime C implementation. */"
+    f.puts "#define SHARE_P#{bits}_TUNE\t\"#{tune[bits].join(",")}\""
+  end
+end